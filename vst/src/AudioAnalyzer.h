@@ -2,10 +2,15 @@
 #include "JuceHeader.h"
 #include "SoundTouch.h"
 #include "BPMDetect.h"
+#include "SimdConfig.h"
+#include <future>
+#include <vector>
 
 class AudioAnalyzer
 {
 public:
+	static constexpr const char *timeStretchAlgorithm = "soundtouch-chunked-v1";
+
 	static float detectBPM(const juce::AudioBuffer<float> &buffer, double sampleRate)
 	{
 		if (buffer.getNumSamples() == 0)
@@ -172,56 +177,264 @@ public:
 
 		try
 		{
-			soundtouch::SoundTouch soundTouch;
-			soundTouch.setSampleRate((int)sampleRate);
-			soundTouch.setChannels(buffer.getNumChannels());
-			soundTouch.setTempoChange((ratio - 1.0) * 100.0);
+			const int numSamples = buffer.getNumSamples();
+			const int minChunkSamples = juce::jmax(1, (int)(sampleRate * minStretchChunkSeconds));
+			const int numChunks = juce::jlimit(1, juce::jmax(1, juce::SystemStats::getNumCpus()),
+											   numSamples / minChunkSamples);
 
-			if (buffer.getNumChannels() == 1)
+			if (numChunks <= 1)
 			{
-				soundTouch.putSamples(buffer.getReadPointer(0), buffer.getNumSamples());
+				timeStretchBufferSingle(buffer, ratio, sampleRate);
+				return;
 			}
-			else
-			{
-				std::vector<float> interleavedInput;
-				interleavedInput.reserve(buffer.getNumSamples() * 2);
 
-				for (int i = 0; i < buffer.getNumSamples(); ++i)
-				{
-					interleavedInput.push_back(buffer.getSample(0, i));
-					interleavedInput.push_back(buffer.getSample(1, i));
-				}
+			timeStretchBufferChunked(buffer, ratio, sampleRate, numChunks);
+		}
+		catch (const std::exception &e)
+		{
+			std::cout << "Error: " << e.what() << std::endl;
+		}
+	}
 
-				soundTouch.putSamples(interleavedInput.data(), buffer.getNumSamples());
-			}
+	static void timeStretchBufferSingle(juce::AudioBuffer<float> &buffer,
+										double ratio, double sampleRate)
+	{
+		std::vector<float> interleavedOutput;
+		int outputSamples = stretchRange(buffer, 0, buffer.getNumSamples(), ratio, sampleRate, interleavedOutput);
+		if (outputSamples <= 0)
+			return;
 
-			soundTouch.flush();
+		buffer.setSize(buffer.getNumChannels(), outputSamples, false, false, true);
+		deinterleave(interleavedOutput.data(), buffer, outputSamples);
+	}
 
-			int outputSamples = soundTouch.numSamples();
-			if (outputSamples > 0)
-			{
-				buffer.setSize(buffer.getNumChannels(), outputSamples, false, false, true);
+	static void timeStretchBufferChunked(juce::AudioBuffer<float> &buffer,
+										 double ratio, double sampleRate, int numChunks)
+	{
+		struct StretchChunk
+		{
+			int inputStart = 0;
+			int inputEnd = 0;
+			int outputSamples = 0;
+			std::vector<float> interleavedOutput;
+		};
 
-				if (buffer.getNumChannels() == 1)
-				{
-					soundTouch.receiveSamples(buffer.getWritePointer(0), outputSamples);
-				}
-				else
-				{
-					std::vector<float> interleavedOutput(outputSamples * 2);
-					soundTouch.receiveSamples(interleavedOutput.data(), outputSamples);
+		const int numChannels = buffer.getNumChannels();
+		const int numSamples = buffer.getNumSamples();
+		const int overlap = juce::jmax(1024, (int)(sampleRate * stretchOverlapSeconds));
+		const int hop = (numSamples + numChunks - 1) / numChunks;
 
-					for (int i = 0; i < outputSamples; ++i)
-					{
-						buffer.setSample(0, i, interleavedOutput[i * 2]);
-						buffer.setSample(1, i, interleavedOutput[i * 2 + 1]);
-					}
-				}
+		std::vector<StretchChunk> chunks((size_t)numChunks);
+		std::vector<std::future<void>> jobs;
+		jobs.reserve(chunks.size());
+
+		for (int i = 0; i < numChunks; ++i)
+		{
+			auto &chunk = chunks[(size_t)i];
+			chunk.inputStart = juce::jmax(0, i * hop - overlap);
+			chunk.inputEnd = juce::jmin(numSamples, (i + 1) * hop + overlap);
+
+			jobs.push_back(std::async(std::launch::async, [&buffer, &chunk, ratio, sampleRate]()
+									  { chunk.outputSamples = stretchRange(buffer, chunk.inputStart,
+																		   chunk.inputEnd - chunk.inputStart,
+																		   ratio, sampleRate, chunk.interleavedOutput); }));
+		}
+
+		for (auto &job : jobs)
+			job.get();
+
+		auto toOutputPosition = [ratio](int inputPosition)
+		{
+			return (int)std::llround(inputPosition / ratio);
+		};
+
+		const int totalOutputSamples = toOutputPosition(numSamples);
+		if (totalOutputSamples <= 0)
+			return;
+
+		juce::AudioBuffer<float> stitched(numChannels, totalOutputSamples);
+		stitched.clear();
+		juce::AudioBuffer<float> chunkBuffer;
+
+		for (int i = 0; i < numChunks; ++i)
+		{
+			const auto &chunk = chunks[(size_t)i];
+			if (chunk.outputSamples <= 0)
+				continue;
+
+			chunkBuffer.setSize(numChannels, chunk.outputSamples, false, false, true);
+			deinterleave(chunk.interleavedOutput.data(), chunkBuffer, chunk.outputSamples);
+
+			const int outputStart = toOutputPosition(chunk.inputStart);
+			const int outputEnd = juce::jmin(totalOutputSamples, outputStart + chunk.outputSamples,
+											 toOutputPosition(chunk.inputEnd));
+			const int fadeInEnd = i > 0 ? toOutputPosition(chunks[(size_t)i - 1].inputEnd) : outputStart;
+			const int fadeOutStart = i + 1 < numChunks ? toOutputPosition(chunks[(size_t)i + 1].inputStart) : outputEnd;
+			const int nominalEnd = toOutputPosition(chunk.inputEnd);
+
+			for (int ch = 0; ch < numChannels; ++ch)
+			{
+				addChunkRegion(stitched, chunkBuffer, ch, outputStart, outputStart, fadeInEnd, outputEnd,
+							   0.0f, 1.0f, fadeInEnd - outputStart);
+				addChunkRegion(stitched, chunkBuffer, ch, outputStart, fadeInEnd, fadeOutStart, outputEnd,
+							   1.0f, 1.0f, 0);
+				addChunkRegion(stitched, chunkBuffer, ch, outputStart, fadeOutStart, nominalEnd, outputEnd,
+							   1.0f, 0.0f, nominalEnd - fadeOutStart);
 			}
 		}
-		catch (const std::exception &e)
+
+		buffer = std::move(stitched);
+	}
+
+private:
+	static constexpr double minStretchChunkSeconds = 2.0;
+	static constexpr double stretchOverlapSeconds = 0.1;
+
+	static void addChunkRegion(juce::AudioBuffer<float> &destination, const juce::AudioBuffer<float> &chunkBuffer,
+							   int channel, int chunkOutputStart, int regionStart, int regionEnd, int availableEnd,
+							   float startGain, float endGain, int rampLength)
+	{
+		const int start = juce::jmax(regionStart, chunkOutputStart);
+		const int end = juce::jmin(regionEnd, availableEnd);
+		if (end <= start)
+			return;
+
+		const float *source = chunkBuffer.getReadPointer(channel, start - chunkOutputStart);
+		if (rampLength <= 0 || startGain == endGain)
 		{
-			std::cout << "Error: " << e.what() << std::endl;
+			destination.addFrom(channel, start, source, end - start, startGain);
+			return;
+		}
+
+		const float gainStep = (endGain - startGain) / (float)rampLength;
+		const float firstGain = startGain + gainStep * (float)(start - regionStart);
+		const float lastGain = firstGain + gainStep * (float)(end - start);
+		destination.addFromWithRamp(channel, start, source, end - start, firstGain, lastGain);
+	}
+
+	static int stretchRange(const juce::AudioBuffer<float> &source, int startSample, int numSamples,
+							double ratio, double sampleRate, std::vector<float> &interleavedOutput)
+	{
+		const int numChannels = source.getNumChannels();
+
+		soundtouch::SoundTouch soundTouch;
+		soundTouch.setSampleRate((int)sampleRate);
+		soundTouch.setChannels(numChannels);
+		soundTouch.setTempoChange((ratio - 1.0) * 100.0);
+
+		if (numChannels == 1)
+		{
+			soundTouch.putSamples(source.getReadPointer(0, startSample), numSamples);
+		}
+		else
+		{
+			std::vector<float> interleavedInput((size_t)numSamples * (size_t)numChannels);
+			interleave(source, startSample, numSamples, interleavedInput.data());
+			soundTouch.putSamples(interleavedInput.data(), numSamples);
+		}
+
+		soundTouch.flush();
+
+		int outputSamples = soundTouch.numSamples();
+		if (outputSamples <= 0)
+			return 0;
+
+		interleavedOutput.resize((size_t)outputSamples * (size_t)numChannels);
+		return soundTouch.receiveSamples(interleavedOutput.data(), outputSamples);
+	}
+
+	static void interleave(const juce::AudioBuffer<float> &source, int startSample, int numSamples, float *dest)
+	{
+		const int numChannels = source.getNumChannels();
+		if (numChannels == 1)
+		{
+			juce::FloatVectorOperations::copy(dest, source.getReadPointer(0, startSample), numSamples);
+			return;
+		}
+		if (numChannels == 2)
+		{
+			interleaveStereo(source.getReadPointer(0, startSample), source.getReadPointer(1, startSample), dest, numSamples);
+			return;
+		}
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			const float *channelData = source.getReadPointer(ch, startSample);
+			for (int i = 0; i < numSamples; ++i)
+				dest[i * numChannels + ch] = channelData[i];
+		}
+	}
+
+	static void deinterleave(const float *source, juce::AudioBuffer<float> &dest, int numSamples)
+	{
+		const int numChannels = dest.getNumChannels();
+		if (numChannels == 1)
+		{
+			juce::FloatVectorOperations::copy(dest.getWritePointer(0), source, numSamples);
+			return;
+		}
+		if (numChannels == 2)
+		{
+			deinterleaveStereo(source, dest.getWritePointer(0), dest.getWritePointer(1), numSamples);
+			return;
+		}
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			float *channelData = dest.getWritePointer(ch);
+			for (int i = 0; i < numSamples; ++i)
+				channelData[i] = source[i * numChannels + ch];
+		}
+	}
+
+	static void interleaveStereo(const float *left, const float *right, float *dest, int numSamples)
+	{
+		int i = 0;
+#if SIMD_USE_SSE
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const __m128 l = _mm_loadu_ps(left + i);
+			const __m128 r = _mm_loadu_ps(right + i);
+			_mm_storeu_ps(dest + 2 * i, _mm_unpacklo_ps(l, r));
+			_mm_storeu_ps(dest + 2 * i + 4, _mm_unpackhi_ps(l, r));
+		}
+#elif SIMD_USE_NEON
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			float32x4x2_t lr;
+			lr.val[0] = vld1q_f32(left + i);
+			lr.val[1] = vld1q_f32(right + i);
+			vst2q_f32(dest + 2 * i, lr);
+		}
+#endif
+		for (; i < numSamples; ++i)
+		{
+			dest[2 * i] = left[i];
+			dest[2 * i + 1] = right[i];
+		}
+	}
+
+	static void deinterleaveStereo(const float *source, float *left, float *right, int numSamples)
+	{
+		int i = 0;
+#if SIMD_USE_SSE
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const __m128 a = _mm_loadu_ps(source + 2 * i);
+			const __m128 b = _mm_loadu_ps(source + 2 * i + 4);
+			_mm_storeu_ps(left + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+			_mm_storeu_ps(right + i, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+		}
+#elif SIMD_USE_NEON
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const float32x4x2_t lr = vld2q_f32(source + 2 * i);
+			vst1q_f32(left + i, lr.val[0]);
+			vst1q_f32(right + i, lr.val[1]);
+		}
+#endif
+		for (; i < numSamples; ++i)
+		{
+			left[i] = source[2 * i];
+			right[i] = source[2 * i + 1];
 		}
 	}
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#pragma once
+#include "JuceHeader.h"
+#include <initializer_list>
+#include <vector>
+
+namespace BinaryState
+{
+	static constexpr int magic = 0x4e53424f;
+	static constexpr juce::uint8 currentVersion = 1;
+
+	inline bool hasHeader(const void *data, int sizeInBytes)
+	{
+		return data != nullptr && sizeInBytes >= 5 && (int)juce::ByteOrder::littleEndianInt(data) == magic;
+	}
+
+	inline void writeString(juce::OutputStream &stream, const juce::String &text)
+	{
+		const auto numBytes = text.getNumBytesAsUTF8();
+		stream.writeCompressedInt((int)numBytes);
+		stream.write(text.toRawUTF8(), numBytes);
+	}
+
+	inline juce::String readString(juce::InputStream &stream)
+	{
+		const int numBytes = stream.readCompressedInt();
+		if (numBytes <= 0)
+			return {};
+		if (numBytes > stream.getNumBytesRemaining())
+		{
+			stream.setPosition(stream.getTotalLength());
+			return {};
+		}
+
+		juce::HeapBlock<char> bytes((size_t)numBytes);
+		stream.read(bytes, numBytes);
+		return juce::String::fromUTF8(bytes, numBytes);
+	}
+
+	inline void writeStringList(juce::OutputStream &stream, const std::vector<juce::String> &strings)
+	{
+		stream.writeCompressedInt((int)strings.size());
+		for (const auto &text : strings)
+			writeString(stream, text);
+	}
+
+	inline std::vector<juce::String> readStringList(juce::InputStream &stream)
+	{
+		std::vector<juce::String> strings;
+		const int count = stream.readCompressedInt();
+		for (int i = 0; i < count && !stream.isExhausted(); ++i)
+			strings.push_back(readString(stream));
+		return strings;
+	}
+
+	inline juce::uint32 packFlags(std::initializer_list<bool> flags)
+	{
+		juce::uint32 packed = 0;
+		int bit = 0;
+		for (bool flag : flags)
+			packed |= (juce::uint32)(flag ? 1 : 0) << bit++;
+		return packed;
+	}
+
+	inline bool flag(juce::uint32 packed, int bit)
+	{
+		return (packed >> bit) & 1u;
+	}
+
+	inline void writeBlock(juce::OutputStream &stream, const juce::MemoryBlock &block)
+	{
+		stream.writeCompressedInt((int)block.getSize());
+		stream.write(block.getData(), block.getSize());
+	}
+
+	inline bool readBlock(juce::InputStream &stream, juce::MemoryBlock &block)
+	{
+		const int numBytes = stream.readCompressedInt();
+		if (numBytes < 0 || numBytes > stream.getNumBytesRemaining())
+			return false;
+		block.setSize((size_t)numBytes);
+		return stream.read(block.getData(), numBytes) == numBytes;
+	}
+}
@@ -0,0 +1,83 @@
+#pragma once
+#include "JuceHeader.h"
+#include "SimdConfig.h"
+
+class LevelMeter
+{
+public:
+	void prepare(double sampleRate)
+	{
+		meterSampleRate = juce::jmax(1.0, sampleRate);
+		meanSquare = 0.0f;
+		peak.store(0.0f);
+		rms.store(0.0f);
+	}
+
+	void measure(const juce::AudioBuffer<float> &buffer, int numSamples)
+	{
+		const int numChannels = std::min(2, buffer.getNumChannels());
+		numSamples = std::min(numSamples, buffer.getNumSamples());
+		if (numChannels == 0 || numSamples <= 0)
+			return;
+
+		float blockPeak = 0.0f;
+		float blockSquares = 0.0f;
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			const float *samples = buffer.getReadPointer(ch);
+			auto range = juce::FloatVectorOperations::findMinAndMax(samples, numSamples);
+			blockPeak = std::max(blockPeak, std::max(-range.getStart(), range.getEnd()));
+			blockSquares += sumOfSquares(samples, numSamples);
+		}
+
+		const float blockMeanSquare = blockSquares / (float)(numSamples * numChannels);
+		const float coefficient = 1.0f - (float)std::exp(-numSamples / (rmsWindowSeconds * meterSampleRate));
+		meanSquare += (blockMeanSquare - meanSquare) * coefficient;
+		rms.store(std::sqrt(meanSquare), std::memory_order_relaxed);
+
+		float heldPeak = peak.load(std::memory_order_relaxed);
+		while (blockPeak > heldPeak && !peak.compare_exchange_weak(heldPeak, blockPeak, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	float takePeak() { return peak.exchange(0.0f, std::memory_order_relaxed); }
+	float getRms() const { return rms.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr double rmsWindowSeconds = 0.3;
+
+	static float sumOfSquares(const float *samples, int numSamples)
+	{
+		int i = 0;
+		float total = 0.0f;
+#if SIMD_USE_SSE
+		__m128 accumulator = _mm_setzero_ps();
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const __m128 x = _mm_loadu_ps(samples + i);
+			accumulator = _mm_add_ps(accumulator, _mm_mul_ps(x, x));
+		}
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, accumulator);
+		total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif SIMD_USE_NEON
+		float32x4_t accumulator = vdupq_n_f32(0.0f);
+		for (; i + 4 <= numSamples; i += 4)
+		{
+			const float32x4_t x = vld1q_f32(samples + i);
+			accumulator = vmlaq_f32(accumulator, x, x);
+		}
+		float32x2_t pair = vadd_f32(vget_low_f32(accumulator), vget_high_f32(accumulator));
+		total = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#endif
+		for (; i < numSamples; ++i)
+			total += samples[i] * samples[i];
+		return total;
+	}
+
+	double meterSampleRate = 48000.0;
+	float meanSquare = 0.0f;
+	std::atomic<float> peak{0.0f};
+	std::atomic<float> rms{0.0f};
+};
@@ -394,26 +394,11 @@ void MasterChannel::drawMasterChanelSegments(juce::Rectangle<float>& vuArea, int
 	}
 }
 
-void MasterChannel::setRealAudioLevel(float level)
-{
-	realAudioLevel = juce::jlimit(0.0f, 1.0f, level);
-	hasRealAudio = true;
-}
-
 void MasterChannel::updateMasterLevels()
 {
-	float instantLevel;
-
-	if (hasRealAudio)
-	{
-		instantLevel = realAudioLevel;
-	}
-	else
-	{
-		static float phase = 0.0f;
-		phase += 0.05f;
-		instantLevel = (std::sin(phase) * 0.3f + 0.3f) * 0.5f;
-	}
+	auto &meter = audioProcessor.getMasterMeter();
+	float instantLevel = juce::jlimit(0.0f, 1.0f, meter.getRms() * juce::MathConstants<float>::sqrt2);
+	float instantPeak = juce::jmin(1.0f, meter.takePeak());
 
 	if (instantLevel > masterLevel)
 	{
@@ -424,9 +409,9 @@ void MasterChannel::updateMasterLevels()
 		masterLevel = masterLevel * 0.95f + instantLevel * 0.05f;
 	}
 
-	if (masterLevel > masterPeakHold)
+	if (instantPeak > masterPeakHold)
 	{
-		masterPeakHold = masterLevel;
+		masterPeakHold = instantPeak;
 		masterPeakHoldTimer = 60;
 	}
 	else if (masterPeakHoldTimer > 0)
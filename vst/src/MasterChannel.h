@@ -12,7 +12,6 @@ public:
 	void drawPeakHoldLine(int numSegments, juce::Rectangle<float> &vuArea, float segmentHeight, juce::Graphics &g) const;
 	void drawMasterClipping(juce::Rectangle<float> &vuArea, juce::Graphics &g) const;
 	void drawMasterChanelSegments(juce::Rectangle<float> &vuArea, int i, float segmentHeight, int numSegments, juce::Graphics &g) const;
-	void setRealAudioLevel(float level);
 	void updateMasterLevels();
 
 	std::function<void(float)> onMasterVolumeChanged;
@@ -28,9 +27,6 @@ private:
 
 	std::atomic<bool> isDestroyed{false};
 
-	float realAudioLevel = 0.0f;
-	bool hasRealAudio = false;
-
 	juce::Label masterLabel;
 	juce::Label highLabel, midLabel, lowLabel, panLabel;
 
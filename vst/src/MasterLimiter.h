@@ -0,0 +1,258 @@
+#pragma once
+#include "JuceHeader.h"
+
+class MasterLimiter
+{
+public:
+	static constexpr float minLookaheadMs = 0.0f;
+	static constexpr float maxLookaheadMs = 10.0f;
+	static constexpr float defaultLookaheadMs = 1.5f;
+
+	MasterLimiter()
+	{
+		buildInterpolationCoefficients();
+	}
+
+	void prepare(double newSampleRate, int maxBlockSize, float lookaheadMs)
+	{
+		sampleRate = newSampleRate;
+		blockCapacity = juce::jmax(1, maxBlockSize);
+		lookaheadSamples = juce::roundToInt(juce::jlimit(minLookaheadMs, maxLookaheadMs, lookaheadMs) * 0.001 * sampleRate);
+		windowLength = lookaheadSamples + 1;
+		delayLength = lookaheadSamples + detectorDelay;
+		releaseCoefficient = (float)std::exp(-1.0 / (releaseSeconds * sampleRate));
+
+		for (int ch = 0; ch < maxChannels; ++ch)
+		{
+			history[ch].assign((size_t)(interpolationTaps - 1 + blockCapacity), 0.0f);
+			delayLines[ch].assign((size_t)delayLength, 0.0f);
+		}
+		detector.assign((size_t)blockCapacity, 0.0f);
+		scratch.assign((size_t)blockCapacity, 0.0f);
+		minValues.assign((size_t)windowLength, 1.0f);
+		minPositions.assign((size_t)windowLength, 0);
+		averageWindow.assign((size_t)windowLength, 1.0f);
+		reset();
+	}
+
+	void reset()
+	{
+		for (int ch = 0; ch < maxChannels; ++ch)
+		{
+			std::fill(history[ch].begin(), history[ch].end(), 0.0f);
+			std::fill(delayLines[ch].begin(), delayLines[ch].end(), 0.0f);
+		}
+		std::fill(averageWindow.begin(), averageWindow.end(), 1.0f);
+		averageSum = (double)windowLength;
+		averagePosition = 0;
+		minHead = 0;
+		minCount = 0;
+		samplePosition = 0;
+		delayPosition = 0;
+		envelope = 1.0f;
+		gainReductionDb.store(0.0f);
+	}
+
+	void processBlock(juce::AudioBuffer<float> &buffer)
+	{
+		const int numChannels = std::min(maxChannels, buffer.getNumChannels());
+		const int numSamples = buffer.getNumSamples();
+		if (numChannels == 0 || detector.empty())
+			return;
+
+		juce::ScopedNoDenormals noDenormals;
+
+		float minGain = 1.0f;
+		for (int offset = 0; offset < numSamples; offset += blockCapacity)
+		{
+			float *channels[maxChannels] = {};
+			for (int ch = 0; ch < numChannels; ++ch)
+				channels[ch] = buffer.getWritePointer(ch, offset);
+			minGain = std::min(minGain, processChunk(channels, numChannels, std::min(blockCapacity, numSamples - offset)));
+		}
+		gainReductionDb.store(juce::Decibels::gainToDecibels(minGain));
+	}
+
+	void setCeilingDb(float newCeilingDb) { ceiling = juce::Decibels::decibelsToGain(juce::jmin(0.0f, newCeilingDb)); }
+	int getLatencySamples() const { return delayLength; }
+	float getGainReductionDb() const { return gainReductionDb.load(); }
+
+private:
+	static constexpr int maxChannels = 2;
+	static constexpr int oversampling = 4;
+	static constexpr int interpolationTaps = 8;
+	static constexpr int detectorDelay = interpolationTaps / 2;
+	static constexpr double releaseSeconds = 0.06;
+
+	float processChunk(float *const *channels, int numChannels, int numSamples)
+	{
+		float *peaks = detector.data();
+		float *work = scratch.data();
+		juce::FloatVectorOperations::clear(peaks, numSamples);
+
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			float *input = history[ch].data();
+			juce::FloatVectorOperations::copy(input + interpolationTaps - 1, channels[ch], numSamples);
+
+			juce::FloatVectorOperations::abs(work, input + detectorDelay - 1, numSamples);
+			juce::FloatVectorOperations::max(peaks, peaks, work, numSamples);
+
+			for (int phase = 0; phase < oversampling - 1; ++phase)
+			{
+				juce::FloatVectorOperations::clear(work, numSamples);
+				for (int tap = 0; tap < interpolationTaps; ++tap)
+					juce::FloatVectorOperations::addWithMultiply(work, input + tap, interpolationCoefficients[phase][tap], numSamples);
+				juce::FloatVectorOperations::abs(work, work, numSamples);
+				juce::FloatVectorOperations::max(peaks, peaks, work, numSamples);
+			}
+
+			std::copy(input + numSamples, input + numSamples + interpolationTaps - 1, input);
+		}
+
+		float *gains = work;
+		float minGain = 1.0f;
+		for (int i = 0; i < numSamples; ++i)
+		{
+			const float required = peaks[i] > ceiling ? ceiling / peaks[i] : 1.0f;
+			const float held = pushWindowMinimum(required);
+
+			envelope = held < envelope ? held : held + (envelope - held) * releaseCoefficient;
+
+			averageSum += envelope - averageWindow[(size_t)averagePosition];
+			averageWindow[(size_t)averagePosition] = envelope;
+			if (++averagePosition == windowLength)
+				averagePosition = 0;
+
+			gains[i] = juce::jmin(1.0f, (float)(averageSum / windowLength));
+			minGain = std::min(minGain, gains[i]);
+		}
+
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			float *samples = channels[ch];
+			float *delay = delayLines[ch].data();
+			int position = delayPosition;
+			for (int i = 0; i < numSamples; ++i)
+			{
+				const float delayed = delay[position];
+				delay[position] = samples[i];
+				samples[i] = delayed * gains[i];
+				if (++position == delayLength)
+					position = 0;
+			}
+		}
+		delayPosition = (delayPosition + numSamples) % delayLength;
+		return minGain;
+	}
+
+	float pushWindowMinimum(float value)
+	{
+		while (minCount > 0 && minPositions[(size_t)minHead] <= samplePosition - windowLength)
+		{
+			minHead = (minHead + 1) % windowLength;
+			--minCount;
+		}
+
+		while (minCount > 0 && minValues[(size_t)backIndex()] >= value)
+			--minCount;
+
+		const int slot = (minHead + minCount) % windowLength;
+		minValues[(size_t)slot] = value;
+		minPositions[(size_t)slot] = samplePosition;
+		++minCount;
+
+		++samplePosition;
+		return minValues[(size_t)minHead];
+	}
+
+	int backIndex() const { return (minHead + minCount - 1) % windowLength; }
+
+	void buildInterpolationCoefficients()
+	{
+		for (int phase = 0; phase < oversampling - 1; ++phase)
+		{
+			const double fraction = (phase + 1) / (double)oversampling;
+			double sum = 0.0;
+			for (int tap = 0; tap < interpolationTaps; ++tap)
+			{
+				const double t = fraction - (tap - (detectorDelay - 1));
+				const double sinc = std::sin(juce::MathConstants<double>::pi * t) / (juce::MathConstants<double>::pi * t);
+				const double window = 0.5 * (1.0 + std::cos(juce::MathConstants<double>::pi * t / detectorDelay));
+				interpolationCoefficients[phase][tap] = (float)(sinc * window);
+				sum += sinc * window;
+			}
+			for (int tap = 0; tap < interpolationTaps; ++tap)
+				interpolationCoefficients[phase][tap] = (float)(interpolationCoefficients[phase][tap] / sum);
+		}
+	}
+
+	double sampleRate = 48000.0;
+	int blockCapacity = 0;
+	int lookaheadSamples = 0;
+	int windowLength = 1;
+	int delayLength = detectorDelay;
+	float ceiling = juce::Decibels::decibelsToGain(-1.0f);
+	float releaseCoefficient = 0.0f;
+	float envelope = 1.0f;
+
+	float interpolationCoefficients[oversampling - 1][interpolationTaps] = {};
+
+	std::vector<float> history[maxChannels];
+	std::vector<float> delayLines[maxChannels];
+	std::vector<float> detector;
+	std::vector<float> scratch;
+	int delayPosition = 0;
+
+	std::vector<float> minValues;
+	std::vector<juce::int64> minPositions;
+	int minHead = 0;
+	int minCount = 0;
+	juce::int64 samplePosition = 0;
+
+	std::vector<float> averageWindow;
+	double averageSum = 1.0;
+	int averagePosition = 0;
+
+	std::atomic<float> gainReductionDb{0.0f};
+};
+
+class LatencyDelay
+{
+public:
+	void prepare(int numChannels, int delaySamples)
+	{
+		delayLength = juce::jmax(0, delaySamples);
+		lines.resize((size_t)numChannels);
+		for (auto &line : lines)
+			line.assign((size_t)juce::jmax(1, delayLength), 0.0f);
+		position = 0;
+	}
+
+	void processBlock(juce::AudioBuffer<float> &buffer)
+	{
+		if (delayLength == 0)
+			return;
+
+		const int numChannels = std::min((int)lines.size(), buffer.getNumChannels());
+		const int numSamples = buffer.getNumSamples();
+		for (int ch = 0; ch < numChannels; ++ch)
+		{
+			float *samples = buffer.getWritePointer(ch);
+			float *line = lines[(size_t)ch].data();
+			int index = position;
+			for (int i = 0; i < numSamples; ++i)
+			{
+				std::swap(samples[i], line[index]);
+				if (++index == delayLength)
+					index = 0;
+			}
+		}
+		position = (position + numSamples) % delayLength;
+	}
+
+private:
+	std::vector<std::vector<float>> lines;
+	int delayLength = 0;
+	int position = 0;
+};
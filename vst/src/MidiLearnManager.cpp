@@ -10,6 +10,7 @@ MidiLearnManager::MidiLearnManager()
 
 MidiLearnManager::~MidiLearnManager()
 {
+	cancelPendingUpdate();
 	stopLearning();
 }
 
@@ -23,6 +24,7 @@ void MidiLearnManager::startLearning(const juce::String &parameterName,
 	learningProcessor = processor;
 	learningUiCallback = uiCallback;
 	learningDescription = description;
+	learnedEventKey.store(-1);
 	isLearning = true;
 	learnStartTime = juce::Time::currentTimeMillis();
 	startTimerHz(10);
@@ -31,10 +33,9 @@ void MidiLearnManager::startLearning(const juce::String &parameterName,
 
 void MidiLearnManager::stopLearning()
 {
-	if (!isLearning)
+	if (!isLearning.exchange(false))
 		return;
 
-	isLearning = false;
 	stopTimer();
 	learningUiCallback = nullptr;
 	learningDescription.clear();
@@ -44,6 +45,9 @@ void MidiLearnManager::stopLearning()
 
 void MidiLearnManager::timerCallback()
 {
+	if (!isLearning.load())
+		return;
+
 	if (juce::Time::currentTimeMillis() - learnStartTime > LEARN_TIMEOUT_MS)
 	{
 		DBG("MIDI Learn timeout");
@@ -67,13 +71,17 @@ void MidiLearnManager::timerCallback()
 void MidiLearnManager::removeMappingsForSlot(int slotNumber)
 {
 	juce::String slotPrefix = "slot" + juce::String(slotNumber);
-	for (int i = static_cast<int>(mappings.size()) - 1; i >= 0; --i)
 	{
-		if (mappings[i].parameterName.startsWith(slotPrefix))
+		juce::ScopedLock lock(mappingsLock);
+		for (int i = static_cast<int>(mappings.size()) - 1; i >= 0; --i)
 		{
-			mappings.erase(mappings.begin() + i);
+			if (mappings[i].parameterName.startsWith(slotPrefix))
+			{
+				mappings.erase(mappings.begin() + i);
+			}
 		}
 	}
+	rebuildDispatchTable();
 }
 
 void MidiLearnManager::moveMappingsFromSlotToSlot(int fromSlot, int toSlot)
@@ -86,43 +94,50 @@ void MidiLearnManager::moveMappingsFromSlotToSlot(int fromSlot, int toSlot)
 
 	DBG("Moving MIDI mappings from " << fromPrefix << " to " << toPrefix);
 
-	removeMappingsForSlot(toSlot);
-	DBG("Cleared existing mappings for slot " << toSlot);
+	{
+		juce::ScopedLock lock(mappingsLock);
+		mappings.erase(std::remove_if(mappings.begin(), mappings.end(),
+									  [&toPrefix](const MidiMapping &mapping)
+									  { return mapping.parameterName.startsWith(toPrefix); }),
+					   mappings.end());
+		DBG("Cleared existing mappings for slot " << toSlot);
 
-	std::vector<MidiMapping> mappingsToMove;
+		std::vector<MidiMapping> mappingsToMove;
 
-	for (auto it = mappings.begin(); it != mappings.end();)
-	{
-		if (it->parameterName.startsWith(fromPrefix))
+		for (auto it = mappings.begin(); it != mappings.end();)
 		{
-			MidiMapping movedMapping = *it;
+			if (it->parameterName.startsWith(fromPrefix))
+			{
+				MidiMapping movedMapping = *it;
 
-			juce::String suffix = it->parameterName.substring(fromPrefix.length());
-			movedMapping.parameterName = toPrefix + suffix;
+				juce::String suffix = it->parameterName.substring(fromPrefix.length());
+				movedMapping.parameterName = toPrefix + suffix;
 
-			movedMapping.description = movedMapping.description.replace(
-				"Slot " + juce::String(fromSlot),
-				"Slot " + juce::String(toSlot));
+				movedMapping.description = movedMapping.description.replace(
+					"Slot " + juce::String(fromSlot),
+					"Slot " + juce::String(toSlot));
 
-			mappingsToMove.push_back(movedMapping);
-			it = mappings.erase(it);
+				mappingsToMove.push_back(movedMapping);
+				it = mappings.erase(it);
 
-			DBG("Moved mapping: " << movedMapping.parameterName);
+				DBG("Moved mapping: " << movedMapping.parameterName);
+			}
+			else
+			{
+				++it;
+			}
 		}
-		else
+
+		for (const auto &mapping : mappingsToMove)
 		{
-			++it;
+			mappings.push_back(mapping);
 		}
 	}
-
-	for (const auto &mapping : mappingsToMove)
-	{
-		mappings.push_back(mapping);
-	}
+	rebuildDispatchTable();
 }
 bool MidiLearnManager::processMidiForLearning(const juce::MidiMessage &message)
 {
-	if (!isLearning)
+	if (!isLearning.load())
 	{
 		return false;
 	}
@@ -161,7 +176,25 @@ bool MidiLearnManager::processMidiForLearning(const juce::MidiMessage &message)
 		return false;
 	}
 
-	removeMapping(learningParameter);
+	// Runs on the audio thread: only the event key crosses over, the mapping is built on the message thread
+	const int key = MidiDispatchTable::keyFor(midiType, midiChannel, midiNumber);
+	bool wasLearning = true;
+	if (key < 0 || !isLearning.compare_exchange_strong(wasLearning, false))
+		return false;
+
+	learnedEventKey.store(key);
+	triggerAsyncUpdate();
+	return true;
+}
+
+void MidiLearnManager::completeLearning(int learnedKey)
+{
+	stopTimer();
+
+	constexpr int keysPerType = MidiDispatchTable::numChannels * MidiDispatchTable::numNumbers;
+	const int midiType = learnedKey / keysPerType;
+	const int midiChannel = (learnedKey % keysPerType) / MidiDispatchTable::numNumbers;
+	const int midiNumber = learnedKey % MidiDispatchTable::numNumbers;
 
 	MidiMapping mapping;
 	mapping.midiType = midiType;
@@ -172,7 +205,14 @@ bool MidiLearnManager::processMidiForLearning(const juce::MidiMessage &message)
 	mapping.description = learningDescription;
 	mapping.parameterName = learningParameter;
 
-	mappings.push_back(mapping);
+	{
+		juce::ScopedLock lock(mappingsLock);
+		mappings.erase(std::remove_if(mappings.begin(), mappings.end(),
+									  [&mapping](const MidiMapping &existing)
+									  { return existing.parameterName == mapping.parameterName; }),
+					   mappings.end());
+		mappings.push_back(mapping);
+	}
 
 	juce::String midiDescription;
 	switch (midiType)
@@ -190,297 +230,360 @@ bool MidiLearnManager::processMidiForLearning(const juce::MidiMessage &message)
 
 	juce::String fullMessage = "MIDI mapping created: " + midiDescription + " >> " + learningDescription;
 	DBG(fullMessage);
-	juce::MessageManager::callAsync([mapping, fullMessage]()
+	if (auto *editor = dynamic_cast<DjIaVstEditor *>(mapping.processor->getActiveEditor()))
+	{
+		editor->statusLabel.setText(fullMessage, juce::dontSendNotification);
+		juce::Timer::callAfterDelay(2000, [mapping]()
 									{
-			if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
-			{
-				editor->statusLabel.setText(fullMessage, juce::dontSendNotification);
-				juce::Timer::callAfterDelay(2000, [mapping]() {
-					if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
-						editor->statusLabel.setText("Ready", juce::dontSendNotification);
-					}
-					});
-			} });
-
-	stopLearning();
+				if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
+					editor->statusLabel.setText("Ready", juce::dontSendNotification);
+				} });
+	}
 
-	return true;
+	learningUiCallback = nullptr;
+	learningDescription.clear();
+	DBG("MIDI Learn stopped");
 }
 
 void MidiLearnManager::processMidiMappings(const juce::MidiMessage &message)
 {
-	int midiChannel = message.getChannel() - 1;
+	int midiType = -1;
+	int midiNumber = 0;
+	if (message.isNoteOnOrOff())
+	{
+		midiType = 0;
+		midiNumber = message.getNoteNumber();
+		if (midiNumber >= 60 && midiNumber <= 67)
+			return;
+	}
+	else if (message.isController())
+	{
+		midiType = 1;
+		midiNumber = message.getControllerNumber();
+	}
+	else if (message.isPitchWheel())
+	{
+		midiType = 2;
+	}
+
+	int key = MidiDispatchTable::keyFor(midiType, message.getChannel() - 1, midiNumber);
+	if (key < 0)
+		return;
+
+	auto table = std::atomic_load(&dispatchTable);
+	if (!table || table->bucketStart.empty())
+		return;
+
 	bool isWarning = false;
-	for (auto &mapping : mappings)
+	for (int i = table->bucketStart[key]; i < table->bucketStart[key + 1]; ++i)
 	{
-		bool matches = false;
-		float value = 0.0f;
-		juce::String statusMessage = "";
+		if (!dispatchMapping(table->entries[i], message, isWarning))
+			return;
+	}
+}
 
-		if (mapping.midiType == 0 && message.isNoteOnOrOff() && mapping.midiChannel == midiChannel)
-		{
-			int noteNumber = message.getNoteNumber();
-			bool isInSampleRange = (noteNumber >= 60 && noteNumber <= 67);
+bool MidiLearnManager::dispatchMapping(const CompiledMidiMapping &compiled, const juce::MidiMessage &message, bool &isWarning)
+{
+	const auto &mapping = compiled.mapping;
+	if (!mapping.processor)
+		return true;
 
-			if (isInSampleRange)
-			{
-				continue;
-			}
+	float value = 0.0f;
+	juce::String statusMessage = compiled.statusPrefix;
 
-			if (message.getNoteNumber() == mapping.midiNumber)
+	if (mapping.midiType == 0)
+	{
+		if (message.isNoteOn() && compiled.isBoolean)
+		{
+			if (compiled.parameter)
 			{
-				matches = true;
-				statusMessage = "Note " + juce::String(mapping.midiNumber) + " >> " + mapping.parameterName;
-
-				if (message.isNoteOn() && isBooleanParameter(mapping.parameterName))
+				if (compiled.isGenerateTrigger)
 				{
-					auto *param = mapping.processor->getParameterTreeState().getParameter(mapping.parameterName);
-					if (param)
+					value = 1.0f;
+					statusMessage += " (trigger)";
+					if (mapping.processor->getIsGenerating())
 					{
-						if (mapping.parameterName.contains("Generate"))
-						{
-							value = 1.0f;
-							statusMessage += " (trigger)";
-							if (mapping.processor->getIsGenerating())
-							{
-								statusMessage += " (trigger) - Generation already in progress, please wait";
-								isWarning = true;
-							}
-						}
-						else
-						{
-							float currentValue = param->getValue();
-							value = (currentValue > 0.5f) ? 0.0f : 1.0f;
-							statusMessage += " (toggle: " + juce::String(value > 0.5f ? "ON" : "OFF") + ")";
-						}
+						statusMessage += " (trigger) - Generation already in progress, please wait";
+						isWarning = true;
 					}
 				}
-				else if (message.isNoteOn())
-				{
-					value = message.getVelocity() / 127.0f;
-					statusMessage += " (vel: " + juce::String(message.getVelocity()) + ")";
-				}
 				else
 				{
-					if (isBooleanParameter(mapping.parameterName))
-						mustCheckForMidiEvent.store(true);
-					continue;
+					float currentValue = compiled.parameter->getValue();
+					value = (currentValue > 0.5f) ? 0.0f : 1.0f;
+					statusMessage += " (toggle: " + juce::String(value > 0.5f ? "ON" : "OFF") + ")";
 				}
 			}
 		}
-		else if (mapping.midiType == 1 && message.isController() && mapping.midiChannel == midiChannel)
+		else if (message.isNoteOn())
 		{
-			if (message.getControllerNumber() == mapping.midiNumber)
-			{
-				matches = true;
-				value = message.getControllerValue() / 127.0f;
-				statusMessage = "CC" + juce::String(mapping.midiNumber) + " >> " + mapping.parameterName +
-								" (" + juce::String(message.getControllerValue()) + ")";
-			}
+			value = message.getVelocity() / 127.0f;
+			statusMessage += " (vel: " + juce::String(message.getVelocity()) + ")";
 		}
-		else if (mapping.midiType == 2 && message.isPitchWheel() && mapping.midiChannel == midiChannel)
+		else
 		{
-			matches = true;
-			value = (message.getPitchWheelValue() + 8192) / 16383.0f;
-			statusMessage = "Pitch Wheel >> " + mapping.parameterName +
-							" (" + juce::String(message.getPitchWheelValue()) + ")";
+			if (compiled.isBoolean)
+				mustCheckForMidiEvent.store(true);
+			return true;
 		}
+	}
+	else if (mapping.midiType == 1)
+	{
+		value = message.getControllerValue() / 127.0f;
+		statusMessage += " (" + juce::String(message.getControllerValue()) + ")";
+	}
+	else if (mapping.midiType == 2)
+	{
+		value = (message.getPitchWheelValue() + 8192) / 16383.0f;
+		statusMessage += " (" + juce::String(message.getPitchWheelValue()) + ")";
+	}
 
-		if (matches && mapping.processor)
+	switch (compiled.action)
+	{
+	case CompiledMidiMapping::Action::PromptPresetSelector:
+	case CompiledMidiMapping::Action::PromptSelector:
+		if (mapping.uiCallback && mapping.processor->getActiveEditor())
 		{
-			if (mapping.parameterName == "promptPresetSelector")
-			{
-				if (mapping.uiCallback && mapping.processor->getActiveEditor())
-				{
-					mapping.uiCallback(value);
-
-					juce::MessageManager::callAsync([mapping, statusMessage]()
-													{
-							if (mapping.processor->getActiveEditor())
-							{
-								if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
-								{
-									editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
-									juce::Timer::callAfterDelay(2000, [mapping]() {
-										if (mapping.processor->getActiveEditor()) {
-											if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
-												editor->statusLabel.setText("Ready", juce::dontSendNotification);
-											}
-										}
-										});
-								}
-							} });
-				}
-				continue;
-			}
-			if (mapping.parameterName.startsWith("promptSelector_slot"))
-			{
-				if (mapping.uiCallback && mapping.processor->getActiveEditor())
-				{
-					mapping.uiCallback(value);
-
-					juce::MessageManager::callAsync([mapping, statusMessage]()
-													{
-							if (mapping.processor->getActiveEditor())
-							{
-								if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
-								{
-									editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
-									juce::Timer::callAfterDelay(2000, [mapping]() {
-										if (mapping.processor->getActiveEditor()) {
-											if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
-												editor->statusLabel.setText("Ready", juce::dontSendNotification);
-											}
-										}
-										});
-								}
-							} });
-				}
-				continue;
-			}
-			if (mapping.parameterName == "nextTrack" || mapping.parameterName == "prevTrack")
-			{
-				if (message.isNoteOn() && isBooleanParameter(mapping.parameterName))
-				{
-					if (mapping.parameterName == "nextTrack")
-					{
-						mapping.processor->selectNextTrack();
-						statusMessage += " (Next Track triggered)";
-					}
-					else if (mapping.parameterName == "prevTrack")
-					{
-						mapping.processor->selectPreviousTrack();
-						statusMessage += " (Previous Track triggered)";
-					}
+			mapping.uiCallback(value);
 
-					juce::MessageManager::callAsync([mapping, statusMessage]()
-													{
-							if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
-							{
-								editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
-								juce::Timer::callAfterDelay(2000, [mapping]() {
+			juce::MessageManager::callAsync([mapping, statusMessage]()
+											{
+					if (mapping.processor->getActiveEditor())
+					{
+						if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
+						{
+							editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
+							juce::Timer::callAfterDelay(2000, [mapping]() {
+								if (mapping.processor->getActiveEditor()) {
 									if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
 										editor->statusLabel.setText("Ready", juce::dontSendNotification);
 									}
-									});
-							} });
-				}
-				continue;
+								}
+								});
+						}
+					} });
+		}
+		return true;
+
+	case CompiledMidiMapping::Action::NextTrack:
+	case CompiledMidiMapping::Action::PrevTrack:
+		if (message.isNoteOn() && compiled.isBoolean)
+		{
+			if (compiled.action == CompiledMidiMapping::Action::NextTrack)
+			{
+				mapping.processor->selectNextTrack();
+				statusMessage += " (Next Track triggered)";
 			}
-			if (mapping.parameterName == "generate")
+			else
 			{
-				if (message.isNoteOn() && isBooleanParameter(mapping.parameterName))
-				{
-					if (mapping.processor->getIsGenerating())
-					{
-						statusMessage += " (Generation already in progress)";
-						isWarning = true;
-					}
-					else
+				mapping.processor->selectPreviousTrack();
+				statusMessage += " (Previous Track triggered)";
+			}
+
+			juce::MessageManager::callAsync([mapping, statusMessage]()
+											{
+					if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
 					{
-						mapping.processor->triggerGlobalGeneration();
-						statusMessage += " (Generation triggered)";
-					}
+						editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
+						juce::Timer::callAfterDelay(2000, [mapping]() {
+							if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
+								editor->statusLabel.setText("Ready", juce::dontSendNotification);
+							}
+							});
+					} });
+		}
+		return true;
 
-					juce::MessageManager::callAsync([mapping, statusMessage, isWarning]()
-													{
-							if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
-							{
-								editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
-								if (isWarning) {
-									editor->statusLabel.setColour(juce::Label::textColourId, ColourPalette::textWarning);
-								}
-								juce::Timer::callAfterDelay(2000, [mapping]() {
-									if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
-										editor->statusLabel.setText("Ready", juce::dontSendNotification);
-										editor->statusLabel.setColour(juce::Label::textColourId, ColourPalette::textSuccess);
-									}
-									});
-							} });
-				}
-				continue;
+	case CompiledMidiMapping::Action::GlobalGenerate:
+		if (message.isNoteOn() && compiled.isBoolean)
+		{
+			if (mapping.processor->getIsGenerating())
+			{
+				statusMessage += " (Generation already in progress)";
+				isWarning = true;
 			}
-			auto *param = mapping.processor->getParameterTreeState().getParameter(mapping.parameterName);
-			if (param)
+			else
 			{
-				if (mapping.parameterName.startsWith("slot"))
-				{
-					juce::String slotPart = mapping.parameterName.substring(0, 5);
-					auto trackIds = mapping.processor->getAllTrackIds();
-					for (const auto &trackId : trackIds)
+				mapping.processor->triggerGlobalGeneration();
+				statusMessage += " (Generation triggered)";
+			}
+
+			bool warning = isWarning;
+			juce::MessageManager::callAsync([mapping, statusMessage, warning]()
+											{
+					if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
 					{
-						TrackData *track = mapping.processor->getTrack(trackId);
-						if (track)
-						{
-							juce::String expectedSlot = "slot" + juce::String(track->slotIndex + 1);
-							if (slotPart == expectedSlot)
-							{
-								break;
-							}
+						editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
+						if (warning) {
+							editor->statusLabel.setColour(juce::Label::textColourId, ColourPalette::textWarning);
 						}
-					}
-				}
-				param->setValueNotifyingHost(value);
-				juce::MessageManager::callAsync([mapping, statusMessage, isWarning]()
-												{
-						if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
-						{
-							editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
-							if (isWarning) {
-								editor->statusLabel.setColour(juce::Label::textColourId, ColourPalette::textWarning);
+						juce::Timer::callAfterDelay(2000, [mapping]() {
+							if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
+								editor->statusLabel.setText("Ready", juce::dontSendNotification);
+								editor->statusLabel.setColour(juce::Label::textColourId, ColourPalette::textSuccess);
 							}
-							juce::Timer::callAfterDelay(2000, [mapping]() {
-								if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
-									editor->statusLabel.setText("Ready", juce::dontSendNotification);
-									editor->statusLabel.setColour(juce::Label::textColourId, ColourPalette::textSuccess);
-								}
-								});
-						} });
+							});
+					} });
+		}
+		return true;
 
-				if (mapping.parameterName.contains("slot") && mapping.parameterName.contains("Play"))
-				{
-					juce::String slotStr = mapping.parameterName.substring(4, 5);
-					int slotNumber = slotStr.getIntValue();
-					if (slotNumber >= 1 && slotNumber <= 8)
-					{
-						changedPlaySlotIndex.store(slotNumber - 1);
-						mustCheckForMidiEvent.store(true);
-					}
-				}
-				if (mapping.parameterName.contains("slot") && mapping.parameterName.contains("Generate"))
-				{
-					if (mapping.processor->getIsGenerating())
-						return;
-					juce::String slotStr = mapping.parameterName.substring(4, 5);
-					int slotNumber = slotStr.getIntValue();
-					if (slotNumber >= 1 && slotNumber <= 8)
-					{
-						changedGenerateSlotIndex.store(slotNumber - 1);
-						mustCheckForMidiEvent.store(true);
-					}
+	case CompiledMidiMapping::Action::Parameter:
+		break;
+	}
+
+	if (!compiled.parameter)
+		return true;
+
+	compiled.parameter->setValueNotifyingHost(value);
+	bool warning = isWarning;
+	juce::MessageManager::callAsync([mapping, statusMessage, warning]()
+									{
+			if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor()))
+			{
+				editor->statusLabel.setText(statusMessage, juce::dontSendNotification);
+				if (warning) {
+					editor->statusLabel.setColour(juce::Label::textColourId, ColourPalette::textWarning);
 				}
-				if (mapping.parameterName.contains("slot") && mapping.parameterName.contains("RandomRetrigger"))
-				{
-					juce::String slotStr = mapping.parameterName.substring(4, 5);
-					int slotNumber = slotStr.getIntValue();
-					if (slotNumber >= 1 && slotNumber <= 8)
-					{
-						mustCheckForMidiEvent.store(true);
+				juce::Timer::callAfterDelay(2000, [mapping]() {
+					if (auto* editor = dynamic_cast<DjIaVstEditor*>(mapping.processor->getActiveEditor())) {
+						editor->statusLabel.setText("Ready", juce::dontSendNotification);
+						editor->statusLabel.setColour(juce::Label::textColourId, ColourPalette::textSuccess);
 					}
-				}
+					});
+			} });
 
-				if (mapping.parameterName.contains("slot") && mapping.parameterName.contains("RetriggerInterval"))
-				{
-					juce::String slotStr = mapping.parameterName.substring(4, 5);
-					int slotNumber = slotStr.getIntValue();
-					if (slotNumber >= 1 && slotNumber <= 8)
-					{
-						mustCheckForMidiEvent.store(true);
-					}
-				}
+	if (compiled.slotNumber >= 1 && compiled.slotNumber <= 8)
+	{
+		if (compiled.isSlotPlay)
+		{
+			changedPlaySlotIndex.store(compiled.slotNumber - 1);
+			mustCheckForMidiEvent.store(true);
+		}
+		if (compiled.isSlotGenerate)
+		{
+			if (mapping.processor->getIsGenerating())
+				return false;
+			changedGenerateSlotIndex.store(compiled.slotNumber - 1);
+			mustCheckForMidiEvent.store(true);
+		}
+		if (compiled.isSlotRetrigger)
+		{
+			mustCheckForMidiEvent.store(true);
+		}
+	}
+	return true;
+}
+
+void MidiLearnManager::handleAsyncUpdate()
+{
+	const int learnedKey = learnedEventKey.exchange(-1);
+	if (learnedKey >= 0)
+		completeLearning(learnedKey);
+	rebuildDispatchTable();
+}
+
+void MidiLearnManager::beginRebuildBatch()
+{
+	juce::ScopedLock lock(rebuildLock);
+	++rebuildBatchDepth;
+}
+
+void MidiLearnManager::endRebuildBatch()
+{
+	{
+		juce::ScopedLock lock(rebuildLock);
+		if (--rebuildBatchDepth > 0 || !std::exchange(rebuildPending, false))
+			return;
+	}
+	rebuildDispatchTable();
+}
+
+void MidiLearnManager::rebuildDispatchTable()
+{
+	// Compile, publish and retire happen under one lock so the newest mappings are always published last
+	juce::ScopedLock rebuild(rebuildLock);
+	if (rebuildBatchDepth > 0)
+	{
+		rebuildPending = true;
+		return;
+	}
+
+	auto table = std::make_shared<MidiDispatchTable>();
+	{
+		juce::ScopedLock lock(mappingsLock);
+		table->entries.reserve(mappings.size());
+		for (const auto &mapping : mappings)
+		{
+			if (MidiDispatchTable::keyFor(mapping.midiType, mapping.midiChannel, mapping.midiNumber) < 0)
+				continue;
+
+			CompiledMidiMapping compiled;
+			compiled.mapping = mapping;
+			const auto &name = mapping.parameterName;
+
+			if (name == "promptPresetSelector")
+				compiled.action = CompiledMidiMapping::Action::PromptPresetSelector;
+			else if (name.startsWith("promptSelector_slot"))
+				compiled.action = CompiledMidiMapping::Action::PromptSelector;
+			else if (name == "nextTrack")
+				compiled.action = CompiledMidiMapping::Action::NextTrack;
+			else if (name == "prevTrack")
+				compiled.action = CompiledMidiMapping::Action::PrevTrack;
+			else if (name == "generate")
+				compiled.action = CompiledMidiMapping::Action::GlobalGenerate;
+
+			if (mapping.processor)
+				compiled.parameter = mapping.processor->getParameterTreeState().getParameter(name);
+
+			compiled.isBoolean = isBooleanParameter(name);
+			compiled.isGenerateTrigger = name.contains("Generate");
+			if (name.contains("slot"))
+			{
+				compiled.slotNumber = name.substring(4, 5).getIntValue();
+				compiled.isSlotPlay = name.contains("Play");
+				compiled.isSlotGenerate = name.contains("Generate");
+				compiled.isSlotRetrigger = name.contains("RandomRetrigger") || name.contains("RetriggerInterval");
 			}
+
+			switch (mapping.midiType)
+			{
+			case 0:
+				compiled.statusPrefix = "Note " + juce::String(mapping.midiNumber) + " >> " + name;
+				break;
+			case 1:
+				compiled.statusPrefix = "CC" + juce::String(mapping.midiNumber) + " >> " + name;
+				break;
+			case 2:
+				compiled.statusPrefix = "Pitch Wheel >> " + name;
+				break;
+			}
+
+			table->entries.push_back(std::move(compiled));
 		}
 	}
+
+	auto keyOf = [](const CompiledMidiMapping &compiled)
+	{
+		return MidiDispatchTable::keyFor(compiled.mapping.midiType, compiled.mapping.midiChannel, compiled.mapping.midiNumber);
+	};
+	std::stable_sort(table->entries.begin(), table->entries.end(),
+					 [&keyOf](const CompiledMidiMapping &a, const CompiledMidiMapping &b)
+					 { return keyOf(a) < keyOf(b); });
+
+	table->bucketStart.assign(MidiDispatchTable::numKeys + 1, 0);
+	for (const auto &compiled : table->entries)
+		++table->bucketStart[keyOf(compiled) + 1];
+	for (int k = 0; k < MidiDispatchTable::numKeys; ++k)
+		table->bucketStart[k + 1] += table->bucketStart[k];
+
+	auto previous = std::atomic_exchange(&dispatchTable, std::shared_ptr<const MidiDispatchTable>(std::move(table)));
+
+	retiredDispatchTables.erase(std::remove_if(retiredDispatchTables.begin(), retiredDispatchTables.end(),
+											   [](const std::shared_ptr<const MidiDispatchTable> &retired)
+											   { return retired.use_count() == 1; }),
+								retiredDispatchTables.end());
+	if (previous)
+		retiredDispatchTables.push_back(std::move(previous));
 }
 
 bool MidiLearnManager::isBooleanParameter(const juce::String &parameterName)
@@ -499,10 +602,14 @@ bool MidiLearnManager::isBooleanParameter(const juce::String &parameterName)
 void MidiLearnManager::clearUICallbacks()
 {
 	registeredUICallbacks.clear();
-	for (auto &mapping : mappings)
 	{
-		mapping.uiCallback = nullptr;
+		juce::ScopedLock lock(mappingsLock);
+		for (auto &mapping : mappings)
+		{
+			mapping.uiCallback = nullptr;
+		}
 	}
+	rebuildDispatchTable();
 	DBG("UI callbacks cleared");
 }
 
@@ -510,68 +617,99 @@ void MidiLearnManager::registerUICallback(const juce::String &parameterName,
 										  std::function<void(float)> callback)
 {
 	registeredUICallbacks[parameterName] = callback;
-	for (auto &mapping : mappings)
 	{
-		if (mapping.parameterName == parameterName)
+		juce::ScopedLock lock(mappingsLock);
+		for (auto &mapping : mappings)
 		{
-			mapping.uiCallback = callback;
-			DBG("Immediately restored callback for existing mapping: " + parameterName);
-			break;
+			if (mapping.parameterName == parameterName)
+			{
+				mapping.uiCallback = callback;
+				DBG("Immediately restored callback for existing mapping: " + parameterName);
+				break;
+			}
 		}
 	}
+	rebuildDispatchTable();
 }
 
 void MidiLearnManager::restoreUICallbacks()
 {
-	for (auto &mapping : mappings)
 	{
-		auto it = registeredUICallbacks.find(mapping.parameterName);
-		if (it != registeredUICallbacks.end())
+		juce::ScopedLock lock(mappingsLock);
+		for (auto &mapping : mappings)
 		{
-			mapping.uiCallback = it->second;
+			auto it = registeredUICallbacks.find(mapping.parameterName);
+			if (it != registeredUICallbacks.end())
+			{
+				mapping.uiCallback = it->second;
+			}
 		}
 	}
+	rebuildDispatchTable();
+}
+
+std::vector<MidiMapping> MidiLearnManager::getAllMappings() const
+{
+	juce::ScopedLock lock(mappingsLock);
+	return mappings;
 }
 
 void MidiLearnManager::addMapping(const MidiMapping &midiMapping)
 {
-	mappings.push_back(midiMapping);
+	{
+		juce::ScopedLock lock(mappingsLock);
+		mappings.push_back(midiMapping);
+	}
+	rebuildDispatchTable();
 }
 
 void MidiLearnManager::removeMapping(juce::String parameterName)
 {
-	mappings.erase(
-		std::remove_if(mappings.begin(), mappings.end(),
-					   [parameterName](const MidiMapping &mapping)
-					   {
-						   return mapping.parameterName == parameterName;
-					   }),
-		mappings.end());
+	{
+		juce::ScopedLock lock(mappingsLock);
+		mappings.erase(
+			std::remove_if(mappings.begin(), mappings.end(),
+						   [parameterName](const MidiMapping &mapping)
+						   {
+							   return mapping.parameterName == parameterName;
+						   }),
+			mappings.end());
+	}
+	rebuildDispatchTable();
 }
 
 void MidiLearnManager::clearAllMappings()
 {
-	mappings.clear();
+	{
+		juce::ScopedLock lock(mappingsLock);
+		mappings.clear();
+	}
+	rebuildDispatchTable();
 	DBG("All MIDI mappings cleared");
 }
 
 bool MidiLearnManager::removeMappingForParameter(const juce::String &parameterName)
 {
-	auto mappingIt = std::find_if(mappings.begin(), mappings.end(),
-								  [parameterName](const MidiMapping &mapping)
-								  {
-									  return mapping.parameterName == parameterName;
-								  });
-
-	if (mappingIt == mappings.end())
+	DjIaVstProcessor *processor = nullptr;
+	juce::String description;
 	{
-		return false;
-	}
-
-	DjIaVstProcessor *processor = mappingIt->processor;
-	juce::String description = mappingIt->description;
+		juce::ScopedLock lock(mappingsLock);
+		auto mappingIt = std::find_if(mappings.begin(), mappings.end(),
+									  [parameterName](const MidiMapping &mapping)
+									  {
+										  return mapping.parameterName == parameterName;
+									  });
+
+		if (mappingIt == mappings.end())
+		{
+			return false;
+		}
 
-	mappings.erase(mappingIt);
+		processor = mappingIt->processor;
+		description = mappingIt->description;
+		mappings.erase(mappingIt);
+	}
+	rebuildDispatchTable();
 	juce::String statusMessage = "MIDI mapping removed: " + description;
 	DBG(statusMessage);
 	juce::MessageManager::callAsync([processor, statusMessage]()
@@ -591,6 +729,7 @@ bool MidiLearnManager::removeMappingForParameter(const juce::String &parameterNa
 
 bool MidiLearnManager::hasMappingForParameter(const juce::String &parameterName) const
 {
+	juce::ScopedLock lock(mappingsLock);
 	return std::any_of(mappings.begin(), mappings.end(),
 					   [parameterName](const MidiMapping &mapping)
 					   {
@@ -600,6 +739,7 @@ bool MidiLearnManager::hasMappingForParameter(const juce::String &parameterName)
 
 juce::String MidiLearnManager::getMappingDescription(const juce::String &parameterName) const
 {
+	juce::ScopedLock lock(mappingsLock);
 	auto it = std::find_if(mappings.begin(), mappings.end(),
 						   [parameterName](const MidiMapping &mapping)
 						   {
@@ -3,11 +3,12 @@
 #include "MidiMapping.h"
 #include <vector>
 #include <functional>
+#include <memory>
 
 class DjIaVstEditor;
 class DjIaVstProcessor;
 
-class MidiLearnManager : public juce::Timer
+class MidiLearnManager : public juce::Timer, private juce::AsyncUpdater
 {
 public:
 	MidiLearnManager();
@@ -22,8 +23,8 @@ public:
 	void processMidiMappings(const juce::MidiMessage &message);
 	void removeMapping(juce::String parameterName);
 	void clearAllMappings();
-	std::vector<MidiMapping> getAllMappings() const { return mappings; }
-	bool isLearningActive() const { return isLearning; }
+	std::vector<MidiMapping> getAllMappings() const;
+	bool isLearningActive() const { return isLearning.load(); }
 	void clearUICallbacks();
 	void registerUICallback(const juce::String &parameterName,
 							std::function<void(float)> callback);
@@ -41,15 +42,40 @@ public:
 	void removeMappingsForSlot(int slotNumber);
 	void moveMappingsFromSlotToSlot(int fromSlot, int toSlot);
 
+	// Defers dispatch table rebuilds until the outermost batch ends, e.g. while restoring state
+	class ScopedRebuildBatch
+	{
+	public:
+		explicit ScopedRebuildBatch(MidiLearnManager &managerToBatch) : manager(managerToBatch) { manager.beginRebuildBatch(); }
+		~ScopedRebuildBatch() { manager.endRebuildBatch(); }
+
+	private:
+		MidiLearnManager &manager;
+		JUCE_DECLARE_NON_COPYABLE(ScopedRebuildBatch)
+	};
+
 private:
 	void timerCallback() override;
-	bool isLearning = false;
+	void handleAsyncUpdate() override;
+	void rebuildDispatchTable();
+	void beginRebuildBatch();
+	void endRebuildBatch();
+	void completeLearning(int learnedKey);
+	bool dispatchMapping(const CompiledMidiMapping &compiled, const juce::MidiMessage &message, bool &isWarning);
+	std::atomic<bool> isLearning{false};
+	std::atomic<int> learnedEventKey{-1};
 	std::map<juce::String, std::function<void(float)>> registeredUICallbacks;
 	std::function<void(float)> learningUiCallback;
 	DjIaVstProcessor *learningProcessor = nullptr;
 	juce::String learningDescription;
 	juce::String learningParameter;
 	std::vector<MidiMapping> mappings;
+	mutable juce::CriticalSection mappingsLock;
+	std::shared_ptr<const MidiDispatchTable> dispatchTable;
+	std::vector<std::shared_ptr<const MidiDispatchTable>> retiredDispatchTables;
+	juce::CriticalSection rebuildLock;
+	int rebuildBatchDepth = 0;
+	bool rebuildPending = false;
 	bool flashState = false;
 	juce::Colour originalColour;
 	int originalColourId = 0;
@@ -12,4 +12,50 @@ struct MidiMapping
     juce::String description;
     DjIaVstProcessor *processor;
     std::function<void(float)> uiCallback;
-};
\ No newline at end of file
+};
+
+struct CompiledMidiMapping
+{
+    enum class Action
+    {
+        Parameter,
+        PromptPresetSelector,
+        PromptSelector,
+        NextTrack,
+        PrevTrack,
+        GlobalGenerate
+    };
+
+    MidiMapping mapping;
+    Action action = Action::Parameter;
+    juce::RangedAudioParameter *parameter = nullptr;
+    juce::String statusPrefix;
+    int slotNumber = 0;
+    bool isBoolean = false;
+    bool isGenerateTrigger = false;
+    bool isSlotPlay = false;
+    bool isSlotGenerate = false;
+    bool isSlotRetrigger = false;
+};
+
+struct MidiDispatchTable
+{
+    static constexpr int numTypes = 3;
+    static constexpr int numChannels = 16;
+    static constexpr int numNumbers = 128;
+    static constexpr int numKeys = numTypes * numChannels * numNumbers;
+
+    static int keyFor(int midiType, int midiChannel, int midiNumber)
+    {
+        if (midiType < 0 || midiType >= numTypes || midiChannel < 0 || midiChannel >= numChannels)
+            return -1;
+        if (midiType == 2)
+            midiNumber = 0;
+        if (midiNumber < 0 || midiNumber >= numNumbers)
+            return -1;
+        return (midiType * numChannels + midiChannel) * numNumbers + midiNumber;
+    }
+
+    std::vector<CompiledMidiMapping> entries;
+    std::vector<int> bucketStart;
+};
@@ -127,16 +127,7 @@ void MixerChannel::setTrackData(TrackData* trackData)
 					juce::MessageManager::callAsync([weakThis]()
 						{
 							if (weakThis != nullptr) {
-								bool allStepsAreFalse = true;
-								for (const auto& measure : weakThis->track->sequencerData.steps) {
-									for (bool step : measure) {
-										if (step) {
-											allStepsAreFalse = false;
-											break;
-										}
-									}
-									if (!allStepsAreFalse) break;
-								}
+								bool allStepsAreFalse = !weakThis->track->sequencerData.pattern.hasAnyActiveStep();
 								if (allStepsAreFalse) {
 									weakThis->stopTrackImmediatly();
 								}
@@ -260,20 +251,7 @@ void MixerChannel::updateUIFromParameter(const juce::String& paramName,
 		}
 		else if (newValue > 0.5 && !track->isCurrentlyPlaying.load())
 		{
-			bool allStepsAreFalse = true;
-			for (const auto& measure : track->sequencerData.steps)
-			{
-				for (bool step : measure)
-				{
-					if (step)
-					{
-						allStepsAreFalse = false;
-						break;
-					}
-				}
-				if (!allStepsAreFalse)
-					break;
-			}
+			bool allStepsAreFalse = !track->sequencerData.pattern.hasAnyActiveStep();
 			if (allStepsAreFalse)
 			{
 				track->isArmedToStop = false;
@@ -375,20 +353,7 @@ void MixerChannel::addEventListeners()
 		{
 			if (track && track->numSamples > 0)
 			{
-				bool allStepsAreFalse = true;
-				for (const auto& measure : track->sequencerData.steps)
-				{
-					for (bool step : measure)
-					{
-						if (step)
-						{
-							allStepsAreFalse = false;
-							break;
-						}
-					}
-					if (!allStepsAreFalse)
-						break;
-				}
+				bool allStepsAreFalse = !track->sequencerData.pattern.hasAnyActiveStep();
 				if (!track->isCurrentlyPlaying.load())
 				{
 					bool shouldArm = playButton.getToggleState();
@@ -424,20 +389,7 @@ void MixerChannel::addEventListeners()
 		{
 			if (track && track->numSamples > 0)
 			{
-				bool allStepsAreFalse = true;
-				for (const auto& measure : track->sequencerData.steps)
-				{
-					for (bool step : measure)
-					{
-						if (step)
-						{
-							allStepsAreFalse = false;
-							break;
-						}
-					}
-					if (!allStepsAreFalse)
-						break;
-				}
+				bool allStepsAreFalse = !track->sequencerData.pattern.hasAnyActiveStep();
 				if (track->isCurrentlyPlaying.load() && !track->isArmedToStop.load() && !allStepsAreFalse)
 				{
 					track->pendingAction = TrackData::PendingAction::StopOnNextMeasure;
@@ -752,7 +704,7 @@ void MixerChannel::resized()
 
 void MixerChannel::updateVUMeter()
 {
-	if (!track || !track->isPlaying.load())
+	if (!track || track->slotIndex < 0)
 	{
 		currentAudioLevel *= 0.95f;
 		if (peakHoldTimer > 0)
@@ -784,42 +736,28 @@ void MixerChannel::updateVUMeter()
 		currentAudioLevel = currentAudioLevel * 0.85f + smoothedLevel * 0.15f;
 	}
 
-	if (currentAudioLevel > peakHold)
+	float instantPeak = juce::jmin(1.0f, audioProcessor.getSlotMeter(track->slotIndex).takePeak());
+	if (instantPeak > peakHold)
 	{
-		peakHold = currentAudioLevel;
+		peakHold = instantPeak;
 		peakHoldTimer = 30;
 	}
+	else if (peakHoldTimer > 0)
+	{
+		peakHoldTimer--;
+	}
+	else
+	{
+		peakHold *= 0.9f;
+	}
 }
 
 float MixerChannel::calculateInstantLevel()
 {
-	if (!track || track->numSamples == 0)
+	if (!track || track->slotIndex < 0)
 		return 0.0f;
 
-	double readPos = track->readPosition.load();
-	int sampleIndex = (int)(readPos);
-
-	if (sampleIndex >= 0 && sampleIndex < track->numSamples)
-	{
-		float level = 0.0f;
-		int samples = std::min(32, track->numSamples - sampleIndex);
-
-		for (int i = 0; i < samples; ++i)
-		{
-			for (int ch = 0; ch < track->audioBuffer.getNumChannels(); ++ch)
-			{
-				float sample = track->audioBuffer.getSample(ch, sampleIndex + i);
-				level += std::abs(sample);
-			}
-		}
-
-		level /= (samples * track->audioBuffer.getNumChannels());
-		level *= track->volume.load();
-
-		return juce::jlimit(0.0f, 1.0f, level * 3.0f);
-	}
-
-	return 0.0f;
+	return juce::jlimit(0.0f, 1.0f, audioProcessor.getSlotMeter(track->slotIndex).getRms() * juce::MathConstants<float>::sqrt2);
 }
 
 void MixerChannel::setSelected(bool selected)
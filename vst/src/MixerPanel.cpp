@@ -2,6 +2,7 @@
 #include "ColourPalette.h"
 #include "MixerChannel.h"
 #include "MasterChannel.h"
+#include "SpectrumDisplay.h"
 #include "PluginProcessor.h"
 
 MixerPanel::MixerPanel(DjIaVstProcessor &processor) : audioProcessor(processor)
@@ -9,6 +10,9 @@ MixerPanel::MixerPanel(DjIaVstProcessor &processor) : audioProcessor(processor)
 	masterChannel = std::make_unique<MasterChannel>(audioProcessor);
 	addAndMakeVisible(*masterChannel);
 
+	spectrumDisplay = std::make_unique<SpectrumDisplay>(audioProcessor);
+	addAndMakeVisible(*spectrumDisplay);
+
 	addAndMakeVisible(channelsViewport);
 	channelsViewport.setViewedComponent(&channelsContainer, false);
 	channelsViewport.setScrollBarsShown(false, true);
@@ -38,7 +42,6 @@ void MixerPanel::updateAllMixerComponents()
 	{
 		channel->updateVUMeters();
 	}
-	calculateMasterLevel();
 	masterChannel->updateMasterLevels();
 }
 
@@ -52,36 +55,6 @@ float MixerPanel::getMasterPan() const
 	return masterPan;
 }
 
-void MixerPanel::calculateMasterLevel()
-{
-	float totalLevel = 0.0f;
-	float maxLevel = 0.0f;
-	int activeChannels = 0;
-
-	for (auto &channel : mixerChannels)
-	{
-		float channelLevel = channel->getCurrentAudioLevel();
-		if (channelLevel > 0.01f)
-		{
-			totalLevel += channelLevel * channelLevel;
-			maxLevel = std::max(maxLevel, channelLevel);
-			activeChannels++;
-		}
-	}
-
-	if (activeChannels > 0)
-	{
-		float rmsLevel = std::sqrt(totalLevel / activeChannels);
-		float finalLevel = (rmsLevel * 0.7f) + (maxLevel * 0.3f);
-		finalLevel *= masterVolume;
-		masterChannel->setRealAudioLevel(finalLevel);
-	}
-	else
-	{
-		masterChannel->setRealAudioLevel(0.0f);
-	}
-}
-
 void MixerPanel::refreshMixerChannels()
 {
 	for (auto &mixerChannel : mixerChannels)
@@ -178,6 +151,9 @@ void MixerPanel::resized()
 	auto masterArea = area.removeFromRight(100);
 	masterChannel->setBounds(masterArea.reduced(5));
 
+	auto spectrumArea = area.removeFromRight(160);
+	spectrumDisplay->setBounds(spectrumArea.reduced(5));
+
 	area.removeFromRight(10);
 
 	channelsViewport.setBounds(area);
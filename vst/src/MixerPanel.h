@@ -4,6 +4,7 @@
 class MixerChannel;
 class DjIaVstProcessor;
 class MasterChannel;
+class SpectrumDisplay;
 
 class MixerPanel : public juce::Component
 {
@@ -17,7 +18,6 @@ public:
 	float getMasterVolume() const;
 	float getMasterPan() const;
 
-	void calculateMasterLevel();
 	void refreshMixerChannels();
 	void refreshAllChannels();
 
@@ -38,6 +38,7 @@ private:
 	DjIaVstProcessor &audioProcessor;
 
 	std::unique_ptr<MasterChannel> masterChannel;
+	std::unique_ptr<SpectrumDisplay> spectrumDisplay;
 	float masterVolume = 0.8f;
 	float masterPan = 0.0f;
 
@@ -347,6 +347,23 @@ void DjIaVstEditor::showConfigDialog()
 		timeoutCombo->setSelectedItemIndex(selectedIndex);
 	}
 
+	juce::StringArray lookaheads = { "0 ms (lowest latency)", "0.5 ms", "1.5 ms", "3 ms", "5 ms", "10 ms (safest)" };
+	alertWindow->addComboBox("limiterLookahead", lookaheads, "Master Limiter Lookahead:");
+	if (auto* lookaheadCombo = alertWindow->getComboBoxComponent("limiterLookahead"))
+	{
+		juce::Array<float> lookaheadValues = { 0.0f, 0.5f, 1.5f, 3.0f, 5.0f, 10.0f };
+		int selectedIndex = 2;
+		for (int i = 0; i < lookaheadValues.size(); ++i)
+		{
+			if (std::abs(lookaheadValues[i] - audioProcessor.getLimiterLookaheadMs()) < 0.01f)
+			{
+				selectedIndex = i;
+				break;
+			}
+		}
+		lookaheadCombo->setSelectedItemIndex(selectedIndex);
+	}
+
 	alertWindow->addButton("Update", 1);
 	alertWindow->addButton("Cancel", 0);
 
@@ -358,8 +375,9 @@ void DjIaVstEditor::showConfigDialog()
 				auto* urlEditor = windowPtr->getTextEditor("serverUrl");
 				auto* keyEditor = windowPtr->getTextEditor("apiKey");
 				auto* timeoutCombo = windowPtr->getComboBoxComponent("requestTimeout");
+				auto* lookaheadCombo = windowPtr->getComboBoxComponent("limiterLookahead");
 
-				if (modeCombo && urlEditor && keyEditor && timeoutCombo) {
+				if (modeCombo && urlEditor && keyEditor && timeoutCombo && lookaheadCombo) {
 					bool useLocal = (modeCombo->getSelectedItemIndex() == 1);
 					bool modeChanged = (useLocal != audioProcessor.getUseLocalModel());
 
@@ -380,6 +398,9 @@ void DjIaVstEditor::showConfigDialog()
 					int selectedTimeoutMs = timeoutMinutes[timeoutCombo->getSelectedItemIndex()] * 60 * 1000;
 					audioProcessor.setRequestTimeout(selectedTimeoutMs);
 
+					juce::Array<float> lookaheadValues = { 0.0f, 0.5f, 1.5f, 3.0f, 5.0f, 10.0f };
+					audioProcessor.setLimiterLookaheadMs(lookaheadValues[lookaheadCombo->getSelectedItemIndex()]);
+
 					audioProcessor.saveGlobalConfig();
 
 					if (modeChanged) {
@@ -2162,23 +2183,26 @@ void DjIaVstEditor::onSaveSession()
 				auto alertWindow = std::make_unique<juce::AlertWindow>("Save Session",
 					"Enter session name:", juce::MessageBoxIconType::QuestionIcon);
 				alertWindow->addTextEditor("sessionName", sessionName, "Session name:");
+				alertWindow->addComboBox("sessionFormat", { "State only", "Bundle with audio" }, "Format:");
+				alertWindow->getComboBoxComponent("sessionFormat")->setSelectedItemIndex(0, juce::dontSendNotification);
 				alertWindow->addButton("Save", 1);
 				alertWindow->addButton("Cancel", 0);
 
 				alertWindow->enterModalState(true, juce::ModalCallbackFunction::create([this](int modalResult)
 					{
 						if (modalResult == 1) {
-							auto* nameEditor = dynamic_cast<juce::AlertWindow*>(juce::Component::getCurrentlyModalComponent())
-								->getTextEditor("sessionName");
+							auto* window = dynamic_cast<juce::AlertWindow*>(juce::Component::getCurrentlyModalComponent());
+							auto* nameEditor = window->getTextEditor("sessionName");
+							auto* formatSelector = window->getComboBoxComponent("sessionFormat");
 							if (nameEditor) {
-								saveCurrentSession(nameEditor->getText());
+								saveCurrentSession(nameEditor->getText(), formatSelector && formatSelector->getSelectedItemIndex() == 1);
 							}
 						} }));
 			}
 		});
 }
 
-void DjIaVstEditor::saveCurrentSession(const juce::String& sessionName)
+void DjIaVstEditor::saveCurrentSession(const juce::String& sessionName, bool asBundle)
 {
 	try
 	{
@@ -2188,6 +2212,21 @@ void DjIaVstEditor::saveCurrentSession(const juce::String& sessionName)
 			sessionsDir.createDirectory();
 		}
 
+		if (asBundle)
+		{
+			juce::File bundleFile = sessionsDir.getChildFile(sessionName + SessionBundle::fileExtension);
+			if (audioProcessor.saveSessionBundle(bundleFile))
+			{
+				statusLabel.setText("Session bundle saved: " + sessionName, juce::dontSendNotification);
+				loadSessionList();
+			}
+			else
+			{
+				statusLabel.setText("Failed to save session bundle", juce::dontSendNotification);
+			}
+			return;
+		}
+
 		juce::File sessionFile = sessionsDir.getChildFile(sessionName + ".djiasession");
 
 		juce::MemoryBlock stateData;
@@ -2217,10 +2256,9 @@ void DjIaVstEditor::onLoadSession()
 	int selectedIndex = sessionSelector.getSelectedItemIndex();
 	if (selectedIndex >= 0)
 	{
-		juce::String sessionName = sessionSelector.getItemText(selectedIndex);
-		if (sessionName != "No sessions found")
+		if (selectedIndex < sessionFiles.size())
 		{
-			loadSession(sessionName);
+			loadSession(sessionFiles[selectedIndex]);
 		}
 	}
 	else
@@ -2229,13 +2267,25 @@ void DjIaVstEditor::onLoadSession()
 	}
 }
 
-void DjIaVstEditor::loadSession(const juce::String& sessionName)
+void DjIaVstEditor::loadSession(const juce::File& sessionFile)
 {
+	const juce::String sessionName = sessionFile.getFileNameWithoutExtension();
 	try
 	{
-		juce::File sessionFile = getSessionsDirectory().getChildFile(sessionName + ".djiasession");
-
-		if (sessionFile.existsAsFile())
+		if (sessionFile.hasFileExtension(SessionBundle::fileExtension))
+		{
+			if (audioProcessor.loadSessionBundle(sessionFile))
+			{
+				refreshTrackComponents();
+				updateUIFromProcessor();
+				statusLabel.setText("Session bundle loaded: " + sessionName, juce::dontSendNotification);
+			}
+			else
+			{
+				statusLabel.setText("Failed to open session bundle", juce::dontSendNotification);
+			}
+		}
+		else if (sessionFile.existsAsFile())
 		{
 			juce::FileInputStream stream(sessionFile);
 			if (stream.openedOk())
@@ -2270,16 +2320,21 @@ void DjIaVstEditor::loadSession(const juce::String& sessionName)
 void DjIaVstEditor::loadSessionList()
 {
 	sessionSelector.clear();
+	sessionFiles.clear();
 
 	juce::File sessionsDir = getSessionsDirectory();
 	if (sessionsDir.exists())
 	{
-		auto sessionFiles = sessionsDir.findChildFiles(juce::File::findFiles, false, "*.djiasession");
+		sessionFiles = sessionsDir.findChildFiles(juce::File::findFiles, false,
+			juce::String("*.djiasession;*") + SessionBundle::fileExtension);
+		sessionFiles.sort();
 
 		for (const auto& file : sessionFiles)
 		{
-			sessionSelector.addItem(file.getFileNameWithoutExtension(),
-				sessionSelector.getNumItems() + 1);
+			juce::String itemText = file.getFileNameWithoutExtension();
+			if (file.hasFileExtension(SessionBundle::fileExtension))
+				itemText += " (bundle)";
+			sessionSelector.addItem(itemText, sessionSelector.getNumItems() + 1);
 		}
 	}
 
@@ -80,8 +80,8 @@ private:
 	void onSaveSession();
 	void onLoadSession();
 	void loadSessionList();
-	void saveCurrentSession(const juce::String& sessionName);
-	void loadSession(const juce::String& sessionName);
+	void saveCurrentSession(const juce::String& sessionName, bool asBundle = false);
+	void loadSession(const juce::File& sessionFile);
 	void updateUIComponents();
 	void setAllGenerateButtonsEnabled(bool enabled);
 	void showFirstTimeSetup();
@@ -166,6 +166,7 @@ private:
 	juce::TextButton saveSessionButton;
 	juce::TextButton loadSessionButton;
 	juce::ComboBox sessionSelector;
+	juce::Array<juce::File> sessionFiles;
 	juce::ToggleButton bypassSequencerButton;
 	std::unique_ptr<juce::MenuBarComponent> menuBar;
 
@@ -1,5 +1,7 @@
 ﻿#include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "BinaryState.h"
+#include "SessionBundle.h"
 #include "AudioAnalyzer.h"
 #include "DummySynth.h"
 #include "MidiMapping.h"
@@ -19,7 +21,7 @@ juce::AudioProcessor::BusesProperties DjIaVstProcessor::createBusLayout()
 
 DjIaVstProcessor::DjIaVstProcessor()
 	: AudioProcessor(createBusLayout()), apiClient("", "http://localhost:8000"),
-	  parameters(*this, nullptr, "Parameters", {std::make_unique<juce::AudioParameterBool>("generate", "Generate Loop", false), std::make_unique<juce::AudioParameterBool>("play", "Play Loop", false), std::make_unique<juce::AudioParameterFloat>("bpm", "BPM", 60.0f, 200.0f, 126.0f), std::make_unique<juce::AudioParameterFloat>("masterVolume", "Master Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("masterPan", "Master Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("masterHigh", "Master High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("masterMid", "Master Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("masterLow", "Master Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1Volume", "Slot 1 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot1Pan", "Slot 1 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot1Mute", "Slot 1 Mute", false), std::make_unique<juce::AudioParameterBool>("slot1Solo", "Slot 1 Solo", false), std::make_unique<juce::AudioParameterBool>("slot1Play", "Slot 1 Play", false), std::make_unique<juce::AudioParameterBool>("slot1Stop", "Slot 1 Stop", false), std::make_unique<juce::AudioParameterBool>("slot1Generate", "Slot 1 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot1Pitch", "Slot 1 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1Fine", "Slot 1 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1BpmOffset", "Slot 1 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2Volume", "Slot 2 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot2Pan", "Slot 2 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot2Mute", "Slot 2 Mute", false), std::make_unique<juce::AudioParameterBool>("slot2Solo", "Slot 2 Solo", false), std::make_unique<juce::AudioParameterBool>("slot2Play", "Slot 2 Play", false), std::make_unique<juce::AudioParameterBool>("slot2Stop", "Slot 2 Stop", false), std::make_unique<juce::AudioParameterBool>("slot2Generate", "Slot 2 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot2Pitch", "Slot 2 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2Fine", "Slot 2 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2BpmOffset", "Slot 2 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3Volume", "Slot 3 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot3Pan", "Slot 3 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot3Mute", "Slot 3 Mute", false), std::make_unique<juce::AudioParameterBool>("slot3Solo", "Slot 3 Solo", false), std::make_unique<juce::AudioParameterBool>("slot3Play", "Slot 3 Play", false), std::make_unique<juce::AudioParameterBool>("slot3Stop", "Slot 3 Stop", false), std::make_unique<juce::AudioParameterBool>("slot3Generate", "Slot 3 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot3Pitch", "Slot 3 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3Fine", "Slot 3 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3BpmOffset", "Slot 3 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4Volume", "Slot 4 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot4Pan", "Slot 4 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot4Mute", "Slot 4 Mute", false), std::make_unique<juce::AudioParameterBool>("slot4Solo", "Slot 4 Solo", false), std::make_unique<juce::AudioParameterBool>("slot4Play", "Slot 4 Play", false), std::make_unique<juce::AudioParameterBool>("slot4Stop", "Slot 4 Stop", false), std::make_unique<juce::AudioParameterBool>("slot4Generate", "Slot 4 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot4Pitch", "Slot 4 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4Fine", "Slot 4 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4BpmOffset", "Slot 4 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5Volume", "Slot 5 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot5Pan", "Slot 5 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot5Mute", "Slot 5 Mute", false), std::make_unique<juce::AudioParameterBool>("slot5Solo", "Slot 5 Solo", false), std::make_unique<juce::AudioParameterBool>("slot5Play", "Slot 5 Play", false), std::make_unique<juce::AudioParameterBool>("slot5Stop", "Slot 5 Stop", false), std::make_unique<juce::AudioParameterBool>("slot5Generate", "Slot 5 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot5Pitch", "Slot 5 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5Fine", "Slot 5 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5BpmOffset", "Slot 5 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6Volume", "Slot 6 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot6Pan", "Slot 6 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot6Mute", "Slot 6 Mute", false), std::make_unique<juce::AudioParameterBool>("slot6Solo", "Slot 6 Solo", false), std::make_unique<juce::AudioParameterBool>("slot6Play", "Slot 6 Play", false), std::make_unique<juce::AudioParameterBool>("slot6Stop", "Slot 6 Stop", false), std::make_unique<juce::AudioParameterBool>("slot6Generate", "Slot 6 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot6Pitch", "Slot 6 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6Fine", "Slot 6 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6BpmOffset", "Slot 6 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7Volume", "Slot 7 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot7Pan", "Slot 7 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot7Mute", "Slot 7 Mute", false), std::make_unique<juce::AudioParameterBool>("slot7Solo", "Slot 7 Solo", false), std::make_unique<juce::AudioParameterBool>("slot7Play", "Slot 7 Play", false), std::make_unique<juce::AudioParameterBool>("slot7Stop", "Slot 7 Stop", false), std::make_unique<juce::AudioParameterBool>("slot7Generate", "Slot 7 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot7Pitch", "Slot 7 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7Fine", "Slot 7 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7BpmOffset", "Slot 7 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8Volume", "Slot 8 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot8Pan", "Slot 8 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot8Mute", "Slot 8 Mute", false), std::make_unique<juce::AudioParameterBool>("slot8Solo", "Slot 8 Solo", false), std::make_unique<juce::AudioParameterBool>("slot8Play", "Slot 8 Play", false), std::make_unique<juce::AudioParameterBool>("slot8Stop", "Slot 8 Stop", false), std::make_unique<juce::AudioParameterBool>("slot8Generate", "Slot 8 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot8Pitch", "Slot 8 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8Fine", "Slot 8 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8BpmOffset", "Slot 8 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot1RandomRetrigger", "Slot 1 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot1RetriggerInterval", "Slot 1 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot2RandomRetrigger", "Slot 2 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot2RetriggerInterval", "Slot 2 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot3RandomRetrigger", "Slot 3 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot3RetriggerInterval", "Slot 3 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot4RandomRetrigger", "Slot 4 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot4RetriggerInterval", "Slot 4 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot5RandomRetrigger", "Slot 5 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot5RetriggerInterval", "Slot 5 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot6RandomRetrigger", "Slot 6 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot6RetriggerInterval", "Slot 6 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot7RandomRetrigger", "Slot 7 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot7RetriggerInterval", "Slot 7 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot8RandomRetrigger", "Slot 8 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot8RetriggerInterval", "Slot 8 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("nextTrack", "Next Track", false), std::make_unique<juce::AudioParameterBool>("prevTrack", "Previous Track", false)})
+	  parameters(*this, nullptr, "Parameters", {std::make_unique<juce::AudioParameterBool>("generate", "Generate Loop", false), std::make_unique<juce::AudioParameterBool>("play", "Play Loop", false), std::make_unique<juce::AudioParameterFloat>("bpm", "BPM", 60.0f, 200.0f, 126.0f), std::make_unique<juce::AudioParameterFloat>("masterVolume", "Master Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("masterPan", "Master Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("masterHigh", "Master High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("masterMid", "Master Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("masterLow", "Master Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1Volume", "Slot 1 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot1Pan", "Slot 1 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot1Mute", "Slot 1 Mute", false), std::make_unique<juce::AudioParameterBool>("slot1Solo", "Slot 1 Solo", false), std::make_unique<juce::AudioParameterBool>("slot1Play", "Slot 1 Play", false), std::make_unique<juce::AudioParameterBool>("slot1Stop", "Slot 1 Stop", false), std::make_unique<juce::AudioParameterBool>("slot1Generate", "Slot 1 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot1Pitch", "Slot 1 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1Fine", "Slot 1 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1BpmOffset", "Slot 1 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2Volume", "Slot 2 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot2Pan", "Slot 2 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot2Mute", "Slot 2 Mute", false), std::make_unique<juce::AudioParameterBool>("slot2Solo", "Slot 2 Solo", false), std::make_unique<juce::AudioParameterBool>("slot2Play", "Slot 2 Play", false), std::make_unique<juce::AudioParameterBool>("slot2Stop", "Slot 2 Stop", false), std::make_unique<juce::AudioParameterBool>("slot2Generate", "Slot 2 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot2Pitch", "Slot 2 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2Fine", "Slot 2 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2BpmOffset", "Slot 2 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3Volume", "Slot 3 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot3Pan", "Slot 3 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot3Mute", "Slot 3 Mute", false), std::make_unique<juce::AudioParameterBool>("slot3Solo", "Slot 3 Solo", false), std::make_unique<juce::AudioParameterBool>("slot3Play", "Slot 3 Play", false), std::make_unique<juce::AudioParameterBool>("slot3Stop", "Slot 3 Stop", false), std::make_unique<juce::AudioParameterBool>("slot3Generate", "Slot 3 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot3Pitch", "Slot 3 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3Fine", "Slot 3 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3BpmOffset", "Slot 3 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4Volume", "Slot 4 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot4Pan", "Slot 4 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot4Mute", "Slot 4 Mute", false), std::make_unique<juce::AudioParameterBool>("slot4Solo", "Slot 4 Solo", false), std::make_unique<juce::AudioParameterBool>("slot4Play", "Slot 4 Play", false), std::make_unique<juce::AudioParameterBool>("slot4Stop", "Slot 4 Stop", false), std::make_unique<juce::AudioParameterBool>("slot4Generate", "Slot 4 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot4Pitch", "Slot 4 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4Fine", "Slot 4 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4BpmOffset", "Slot 4 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5Volume", "Slot 5 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot5Pan", "Slot 5 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot5Mute", "Slot 5 Mute", false), std::make_unique<juce::AudioParameterBool>("slot5Solo", "Slot 5 Solo", false), std::make_unique<juce::AudioParameterBool>("slot5Play", "Slot 5 Play", false), std::make_unique<juce::AudioParameterBool>("slot5Stop", "Slot 5 Stop", false), std::make_unique<juce::AudioParameterBool>("slot5Generate", "Slot 5 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot5Pitch", "Slot 5 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5Fine", "Slot 5 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5BpmOffset", "Slot 5 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6Volume", "Slot 6 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot6Pan", "Slot 6 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot6Mute", "Slot 6 Mute", false), std::make_unique<juce::AudioParameterBool>("slot6Solo", "Slot 6 Solo", false), std::make_unique<juce::AudioParameterBool>("slot6Play", "Slot 6 Play", false), std::make_unique<juce::AudioParameterBool>("slot6Stop", "Slot 6 Stop", false), std::make_unique<juce::AudioParameterBool>("slot6Generate", "Slot 6 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot6Pitch", "Slot 6 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6Fine", "Slot 6 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6BpmOffset", "Slot 6 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7Volume", "Slot 7 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot7Pan", "Slot 7 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot7Mute", "Slot 7 Mute", false), std::make_unique<juce::AudioParameterBool>("slot7Solo", "Slot 7 Solo", false), std::make_unique<juce::AudioParameterBool>("slot7Play", "Slot 7 Play", false), std::make_unique<juce::AudioParameterBool>("slot7Stop", "Slot 7 Stop", false), std::make_unique<juce::AudioParameterBool>("slot7Generate", "Slot 7 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot7Pitch", "Slot 7 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7Fine", "Slot 7 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7BpmOffset", "Slot 7 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8Volume", "Slot 8 Volume", 0.0f, 1.0f, 0.8f), std::make_unique<juce::AudioParameterFloat>("slot8Pan", "Slot 8 Pan", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot8Mute", "Slot 8 Mute", false), std::make_unique<juce::AudioParameterBool>("slot8Solo", "Slot 8 Solo", false), std::make_unique<juce::AudioParameterBool>("slot8Play", "Slot 8 Play", false), std::make_unique<juce::AudioParameterBool>("slot8Stop", "Slot 8 Stop", false), std::make_unique<juce::AudioParameterBool>("slot8Generate", "Slot 8 Generate", false), std::make_unique<juce::AudioParameterFloat>("slot8Pitch", "Slot 8 Pitch", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8Fine", "Slot 8 Fine", -50.0f, 50.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8BpmOffset", "Slot 8 BPM Offset", -20.0f, 20.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("slot1RandomRetrigger", "Slot 1 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot1RetriggerInterval", "Slot 1 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot2RandomRetrigger", "Slot 2 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot2RetriggerInterval", "Slot 2 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot3RandomRetrigger", "Slot 3 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot3RetriggerInterval", "Slot 3 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot4RandomRetrigger", "Slot 4 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot4RetriggerInterval", "Slot 4 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot5RandomRetrigger", "Slot 5 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot5RetriggerInterval", "Slot 5 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot6RandomRetrigger", "Slot 6 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot6RetriggerInterval", "Slot 6 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot7RandomRetrigger", "Slot 7 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot7RetriggerInterval", "Slot 7 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterBool>("slot8RandomRetrigger", "Slot 8 Random Retrigger", false), std::make_unique<juce::AudioParameterFloat>("slot8RetriggerInterval", "Slot 8 Retrigger Interval", juce::NormalisableRange<float>(1.0f, 10.0f, 1.0f), 3.0f), std::make_unique<juce::AudioParameterFloat>("slot1Filter", "Slot 1 Filter", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1LowEq", "Slot 1 Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1MidEq", "Slot 1 Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1HighEq", "Slot 1 High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1InsertGain", "Slot 1 Insert Gain", -24.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot1Send", "Slot 1 Send", 0.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2Filter", "Slot 2 Filter", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2LowEq", "Slot 2 Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2MidEq", "Slot 2 Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2HighEq", "Slot 2 High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2InsertGain", "Slot 2 Insert Gain", -24.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot2Send", "Slot 2 Send", 0.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3Filter", "Slot 3 Filter", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3LowEq", "Slot 3 Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3MidEq", "Slot 3 Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3HighEq", "Slot 3 High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3InsertGain", "Slot 3 Insert Gain", -24.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot3Send", "Slot 3 Send", 0.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4Filter", "Slot 4 Filter", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4LowEq", "Slot 4 Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4MidEq", "Slot 4 Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4HighEq", "Slot 4 High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4InsertGain", "Slot 4 Insert Gain", -24.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot4Send", "Slot 4 Send", 0.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5Filter", "Slot 5 Filter", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5LowEq", "Slot 5 Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5MidEq", "Slot 5 Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5HighEq", "Slot 5 High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5InsertGain", "Slot 5 Insert Gain", -24.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot5Send", "Slot 5 Send", 0.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6Filter", "Slot 6 Filter", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6LowEq", "Slot 6 Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6MidEq", "Slot 6 Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6HighEq", "Slot 6 High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6InsertGain", "Slot 6 Insert Gain", -24.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot6Send", "Slot 6 Send", 0.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7Filter", "Slot 7 Filter", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7LowEq", "Slot 7 Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7MidEq", "Slot 7 Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7HighEq", "Slot 7 High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7InsertGain", "Slot 7 Insert Gain", -24.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot7Send", "Slot 7 Send", 0.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8Filter", "Slot 8 Filter", -1.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8LowEq", "Slot 8 Low EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8MidEq", "Slot 8 Mid EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8HighEq", "Slot 8 High EQ", -12.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8InsertGain", "Slot 8 Insert Gain", -24.0f, 12.0f, 0.0f), std::make_unique<juce::AudioParameterFloat>("slot8Send", "Slot 8 Send", 0.0f, 1.0f, 0.0f), std::make_unique<juce::AudioParameterBool>("nextTrack", "Next Track", false), std::make_unique<juce::AudioParameterBool>("prevTrack", "Previous Track", false)})
 {
 	projectId = "legacy";
 	loadGlobalConfig();
@@ -137,6 +139,12 @@ void DjIaVstProcessor::loadGlobalConfig()
 			useLocalModel = object->getProperty("useLocalModel").toString() == "true";
 			localModelsPath = object->getProperty("localModelsPath").toString();
 
+			if (object->hasProperty("limiterLookaheadMs"))
+			{
+				limiterLookaheadMs.store(juce::jlimit(MasterLimiter::minLookaheadMs, MasterLimiter::maxLookaheadMs,
+													  (float)object->getProperty("limiterLookaheadMs")));
+			}
+
 			if (!object->hasProperty("useLocalModel"))
 			{
 				useLocalModel = false;
@@ -179,6 +187,7 @@ void DjIaVstProcessor::saveGlobalConfig()
 	config->setProperty("requestTimeoutMS", requestTimeoutMS);
 	config->setProperty("useLocalModel", useLocalModel ? "true" : "false");
 	config->setProperty("localModelsPath", localModelsPath);
+	config->setProperty("limiterLookaheadMs", limiterLookaheadMs.load());
 
 	juce::Array<juce::var> promptsArray;
 	for (const auto &prompt : customPrompts)
@@ -286,6 +295,29 @@ void DjIaVstProcessor::loadParameters()
 		juce::String slotName = "slot" + juce::String(i + 1);
 		slotRandomRetriggerParams[i] = parameters.getRawParameterValue(slotName + "RandomRetrigger");
 		slotRetriggerIntervalParams[i] = parameters.getRawParameterValue(slotName + "RetriggerInterval");
+		slotRetriggerIntervalParameters[i] = parameters.getParameter(slotName + "RetriggerInterval");
+	}
+
+	for (int i = 0; i < 8; ++i)
+	{
+		juce::String slotName = "slot" + juce::String(i + 1);
+		slotFilterParams[i] = parameters.getRawParameterValue(slotName + "Filter");
+		slotLowEqParams[i] = parameters.getRawParameterValue(slotName + "LowEq");
+		slotMidEqParams[i] = parameters.getRawParameterValue(slotName + "MidEq");
+		slotHighEqParams[i] = parameters.getRawParameterValue(slotName + "HighEq");
+		slotInsertGainParams[i] = parameters.getRawParameterValue(slotName + "InsertGain");
+		slotSendParams[i] = parameters.getRawParameterValue(slotName + "Send");
+	}
+
+	for (int i = 0; i < 8; ++i)
+	{
+		juce::String slotName = "slot" + juce::String(i + 1);
+		auto listener = std::make_unique<SlotParameterListener>(dirtySlotParams, i);
+		for (auto *suffix : slotListenedParameterSuffixes)
+		{
+			parameters.addParameterListener(slotName + suffix, listener.get());
+		}
+		slotParameterListeners.push_back(std::move(listener));
 	}
 
 	nextTrackParam = parameters.getRawParameterValue("nextTrack");
@@ -321,6 +353,15 @@ void DjIaVstProcessor::cleanProcessor()
 	{
 		parameters.removeParameterListener("slot" + juce::String(i) + "Generate", this);
 	}
+	for (size_t i = 0; i < slotParameterListeners.size(); ++i)
+	{
+		juce::String slotName = "slot" + juce::String((int)i + 1);
+		for (auto *suffix : slotListenedParameterSuffixes)
+		{
+			parameters.removeParameterListener(slotName + suffix, slotParameterListeners[i].get());
+		}
+	}
+	slotParameterListeners.clear();
 
 	isNotePlaying = false;
 	hasPendingAudioData = false;
@@ -334,6 +375,12 @@ void DjIaVstProcessor::cleanProcessor()
 
 void DjIaVstProcessor::timerCallback()
 {
+	trackManager.updateInsertChains();
+	if (++trackStateRefreshTicks >= trackStateRefreshInterval)
+	{
+		trackStateRefreshTicks = 0;
+		trackManager.refreshTrackStates();
+	}
 	if (!needsUIUpdate.load())
 		return;
 	if (onUIUpdateNeeded)
@@ -354,10 +401,22 @@ void DjIaVstProcessor::prepareToPlay(double newSampleRate, int samplesPerBlock)
 		buffer.clear();
 	}
 	masterEQ.prepare(newSampleRate, samplesPerBlock);
+	configureMasterLimiter();
+	for (auto &meter : slotMeters)
+		meter.prepare(newSampleRate);
+	masterMeter.prepare(newSampleRate);
+	spectrumAnalyzer.prepare(newSampleRate);
+	previewVoice.prepare(newSampleRate);
+	trackManager.prepare(newSampleRate, samplesPerBlock);
+	sequencerTriggeredNotes.ensureStorageAllocated(MAX_TRACKS);
+	sequencerMidiOutput.ensureSize(MAX_TRACKS * TrackData::maxVoiceTriggersPerBlock * sequencerMidiEventBytes);
+	beatRepeatRandom.setSeed(beatRepeatRandomSeed);
+	sequencerRandom.setSeed(sequencerRandomSeed);
 }
 
 void DjIaVstProcessor::releaseResources()
 {
+	spectrumAnalyzer.release();
 	for (auto &buffer : individualOutputBuffers)
 	{
 		buffer.setSize(0, 0);
@@ -400,16 +459,22 @@ void DjIaVstProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::Midi
 		lastHostBpmForQuantization.store(hostBpm);
 	}
 	handleSequencerPlayState(hostIsPlaying);
-	updateSequencers(hostIsPlaying);
-	checkBeatRepeatWithSampleCounter();
+	sequencerTriggeredNotes.clearQuick();
+	sequencerMidiOutput.clear();
+	updateSequencers(hostIsPlaying, hostBpm, buffer.getNumSamples());
 
-	{
-		juce::ScopedLock lock(sequencerMidiLock);
-		midiMessages.addEvents(sequencerMidiBuffer, 0, buffer.getNumSamples(), 0);
-		sequencerMidiBuffer.clear();
-	}
+	double samplesPerBeat = (60.0 / (hostBpm > 0.0 ? hostBpm : 120.0)) * hostSampleRate;
+	double blockStartBeats = hostIsPlaying
+								 ? hostPpqPosition
+								 : (internalSampleCounter.load() - buffer.getNumSamples()) / samplesPerBeat;
+	scheduleBeatRepeats(blockStartBeats, hostBpm, buffer.getNumSamples());
 
 	processMidiMessages(midiMessages, hostIsPlaying, hostBpm);
+	midiMessages.addEvents(sequencerMidiOutput, 0, buffer.getNumSamples(), 0);
+	if (midiIndicatorCallback && sequencerTriggeredNotes.size() > 0)
+	{
+		updateMidiIndicatorWithActiveNotes(hostBpm, sequencerTriggeredNotes);
+	}
 
 	if (hasPendingAudioData.load())
 	{
@@ -428,48 +493,22 @@ void DjIaVstProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::Midi
 
 	copyTracksToIndividualOutputs(buffer);
 	handlePreviewPlaying(buffer);
+	compensateAuxiliaryBusLatency(buffer);
 
 	applyMasterEffects(mainOutput);
+	measureOutputLevels(mainOutput);
+	feedSpectrumAnalyzer(mainOutput);
 	checkIfUIUpdateNeeded(midiMessages);
 }
 
 void DjIaVstProcessor::handlePreviewPlaying(juce::AudioSampleBuffer &buffer)
 {
-	if (isPreviewPlaying.load())
-	{
-		juce::ScopedLock lock(previewLock);
-		if (previewBuffer.getNumSamples() > 0)
-		{
-			double currentPos = previewPosition.load();
-			double ratio = previewSampleRate.load() / hostSampleRate;
-
-			const int previewBusIndex = 9;
-			auto previewOutput = getBusBuffer(buffer, false, previewBusIndex);
-
-			for (int i = 0; i < buffer.getNumSamples(); ++i)
-			{
-				int sampleIndex = (int)currentPos;
-				if (sampleIndex >= previewBuffer.getNumSamples())
-				{
-					isPreviewPlaying = false;
-					break;
-				}
-				for (int ch = 0; ch < std::min(previewOutput.getNumChannels(), 2); ++ch)
-				{
-					float sample = previewBuffer.getSample(ch, sampleIndex) * 0.7f;
-					previewOutput.addSample(ch, i, sample);
-				}
-				currentPos += ratio;
-			}
-			previewPosition.store(currentPos);
-		}
-	}
-}
+	const int previewBusIndex = 9;
+	if (!previewVoice.isPlaying() || previewBusIndex >= getBusCount(false))
+		return;
 
-void DjIaVstProcessor::addSequencerMidiMessage(const juce::MidiMessage &message)
-{
-	juce::ScopedLock lock(sequencerMidiLock);
-	sequencerMidiBuffer.addEvent(message, 0);
+	auto previewOutput = getBusBuffer(buffer, false, previewBusIndex);
+	previewVoice.renderNextBlock(previewOutput, buffer.getNumSamples());
 }
 
 void DjIaVstProcessor::handleSequencerPlayState(bool hostIsPlaying)
@@ -493,8 +532,7 @@ void DjIaVstProcessor::handleSequencerPlayState(bool hostIsPlaying)
 				track->sequencerData.currentStep = 0;
 				track->sequencerData.currentMeasure = 0;
 				track->sequencerData.stepAccumulator = 0.0;
-				track->customStepCounter = 0;
-				track->lastPpqPosition = -1.0;
+				track->sequencerClock.reset();
 			}
 		}
 	}
@@ -520,8 +558,7 @@ void DjIaVstProcessor::handleSequencerPlayState(bool hostIsPlaying)
 				track->sequencerData.currentStep = 0;
 				track->sequencerData.currentMeasure = 0;
 				track->sequencerData.stepAccumulator = 0.0;
-				track->customStepCounter = 0;
-				track->lastPpqPosition = -1.0;
+				track->sequencerClock.reset();
 			}
 		}
 		needsUIUpdate = true;
@@ -541,8 +578,7 @@ void DjIaVstProcessor::handleSequencerPlayState(bool hostIsPlaying)
 				track->sequencerData.currentStep = 0;
 				track->sequencerData.currentMeasure = 0;
 				track->sequencerData.stepAccumulator = 0.0;
-				track->customStepCounter = 0;
-				track->lastPpqPosition = -1.0;
+				track->sequencerClock.reset();
 				track->sequencerData.isPlaying = false;
 				track->isArmed = arm;
 				track->isPlaying.store(false);
@@ -577,27 +613,63 @@ void DjIaVstProcessor::checkIfUIUpdateNeeded(juce::MidiBuffer &midiMessages)
 void DjIaVstProcessor::applyMasterEffects(juce::AudioSampleBuffer &mainOutput)
 {
 	updateMasterEQ();
+	masterEQ.setOutputGain(masterVolumeParam->load());
+	masterEQ.setOutputPan(masterPanParam->load());
 	masterEQ.processBlock(mainOutput);
+	masterLimiter.processBlock(mainOutput);
+}
 
-	float targetVol = masterVolumeParam->load();
-	float targetPan = masterPanParam->load();
+void DjIaVstProcessor::measureOutputLevels(const juce::AudioSampleBuffer &mainOutput)
+{
+	const int numSamples = mainOutput.getNumSamples();
+	for (size_t slot = 0; slot < slotMeters.size() && slot < individualOutputBuffers.size(); ++slot)
+		slotMeters[slot].measure(individualOutputBuffers[slot], numSamples);
+	masterMeter.measure(mainOutput, numSamples);
+}
 
-	const float smoothingCoeff = 0.95f;
-	smoothedMasterVol = smoothedMasterVol * smoothingCoeff + targetVol * (1.0f - smoothingCoeff);
-	smoothedMasterPan = smoothedMasterPan * smoothingCoeff + targetPan * (1.0f - smoothingCoeff);
+void DjIaVstProcessor::feedSpectrumAnalyzer(const juce::AudioSampleBuffer &mainOutput)
+{
+	if (!spectrumAnalyzer.isActive())
+		return;
 
-	mainOutput.applyGain(smoothedMasterVol);
+	const int slot = spectrumAnalyzer.getSelectedTrackSlot();
+	const juce::AudioSampleBuffer *selectedTrackOutput =
+		slot >= 0 && slot < (int)individualOutputBuffers.size() ? &individualOutputBuffers[(size_t)slot] : nullptr;
+	spectrumAnalyzer.pushBlock(mainOutput, selectedTrackOutput, mainOutput.getNumSamples());
+}
 
-	if (mainOutput.getNumChannels() >= 2 && std::abs(smoothedMasterPan) > 0.01f)
+void DjIaVstProcessor::compensateAuxiliaryBusLatency(juce::AudioSampleBuffer &buffer)
+{
+	for (int busIndex = 1; busIndex < getBusCount(false) && busIndex <= (int)auxiliaryBusDelays.size(); ++busIndex)
 	{
-		if (smoothedMasterPan < 0.0f)
-		{
-			mainOutput.applyGain(1, 0, mainOutput.getNumSamples(), 1.0f + smoothedMasterPan);
-		}
-		else
-		{
-			mainOutput.applyGain(0, 0, mainOutput.getNumSamples(), 1.0f - smoothedMasterPan);
-		}
+		auto busBuffer = getBusBuffer(buffer, false, busIndex);
+		if (busBuffer.getNumChannels() > 0)
+			auxiliaryBusDelays[(size_t)busIndex - 1].processBlock(busBuffer);
+	}
+}
+
+void DjIaVstProcessor::configureMasterLimiter()
+{
+	masterLimiter.prepare(hostSampleRate, currentBlockSize, limiterLookaheadMs.load());
+	for (auto &delay : auxiliaryBusDelays)
+		delay.prepare(2, masterLimiter.getLatencySamples());
+	setLatencySamples(masterLimiter.getLatencySamples());
+}
+
+void DjIaVstProcessor::setLimiterLookaheadMs(float lookaheadMs)
+{
+	lookaheadMs = juce::jlimit(MasterLimiter::minLookaheadMs, MasterLimiter::maxLookaheadMs, lookaheadMs);
+	if (std::abs(lookaheadMs - limiterLookaheadMs.load()) < 0.01f)
+		return;
+
+	limiterLookaheadMs.store(lookaheadMs);
+	saveGlobalConfig();
+
+	if (getSampleRate() > 0.0)
+	{
+		suspendProcessing(true);
+		configureMasterLimiter();
+		suspendProcessing(false);
 	}
 }
 
@@ -718,7 +790,7 @@ void DjIaVstProcessor::processMidiMessages(juce::MidiBuffer &midiMessages, bool
 			{
 				int noteNumber = message.getNoteNumber();
 				notesPlayedInThisBuffer.addIfNotAlreadyThere(noteNumber);
-				playTrack(message, hostBpm);
+				playTrack(message, metadata.samplePosition);
 			}
 			else if (message.isNoteOff())
 			{
@@ -744,7 +816,7 @@ void DjIaVstProcessor::previewTrack(const juce::String &trackId)
 	}
 }
 
-void DjIaVstProcessor::playTrack(const juce::MidiMessage &message, double hostBpm)
+void DjIaVstProcessor::playTrack(const juce::MidiMessage &message, int sampleOffset)
 {
 	int noteNumber = message.getNoteNumber();
 	juce::String noteName = juce::MidiMessage::getMidiNoteName(noteNumber, true, true, 3);
@@ -761,7 +833,7 @@ void DjIaVstProcessor::playTrack(const juce::MidiMessage &message, double hostBp
 			}
 			if (track->numSamples > 0)
 			{
-				startNotePlaybackForTrack(trackId, noteNumber, hostBpm);
+				startNotePlaybackForTrack(trackId, noteNumber, sampleOffset);
 				trackFound = true;
 			}
 			break;
@@ -946,6 +1018,13 @@ void DjIaVstProcessor::handlePlayAndStop(bool /*hostIsPlaying*/)
 
 void DjIaVstProcessor::handleSampleParams(int slot, TrackData *track)
 {
+	const juce::uint32 slotBit = 1u << slot;
+	bool slotChanged = track->paramSnapshotSlot != slot;
+	if (!slotChanged && (dirtySlotParams.load(std::memory_order_relaxed) & slotBit) == 0)
+		return;
+	dirtySlotParams.fetch_and(~slotBit);
+	track->paramSnapshotSlot = slot;
+
 	float paramVolume = slotVolumeParams[slot]->load();
 	float paramPan = slotPanParams[slot]->load();
 	float paramPitch = slotPitchParams[slot]->load() * 8;
@@ -963,6 +1042,14 @@ void DjIaVstProcessor::handleSampleParams(int slot, TrackData *track)
 		track->volume = paramVolume;
 	}
 
+	auto &inserts = track->insertParameters;
+	inserts.filter = slotFilterParams[slot]->load();
+	inserts.lowGainDb = slotLowEqParams[slot]->load();
+	inserts.midGainDb = slotMidEqParams[slot]->load();
+	inserts.highGainDb = slotHighEqParams[slot]->load();
+	inserts.gainDb = slotInsertGainParams[slot]->load();
+	inserts.sendLevel = slotSendParams[slot]->load();
+
 	if (std::abs(track->pan.load() - paramPan) > 0.01f)
 	{
 		track->pan = paramPan;
@@ -1030,8 +1117,23 @@ void DjIaVstProcessor::handleSampleParams(int slot, TrackData *track)
 	}
 }
 
-void DjIaVstProcessor::checkBeatRepeatWithSampleCounter()
+int DjIaVstProcessor::samplesUntilNextGridLine(double positionInBeats, double gridBeats, double samplesPerBeat)
 {
+	double nextGridLine = std::ceil(positionInBeats / gridBeats - 1.0e-9) * gridBeats;
+	double beatsUntilGridLine = juce::jmax(0.0, nextGridLine - positionInBeats);
+	return (int)std::llround(beatsUntilGridLine * samplesPerBeat);
+}
+
+void DjIaVstProcessor::scheduleBeatRepeats(double blockStartBeats, double hostBpm, int numSamples)
+{
+	if (hostBpm <= 0.0)
+		hostBpm = 120.0;
+
+	double samplesPerBeat = (60.0 / hostBpm) * hostSampleRate;
+	int gridOffset = samplesUntilNextGridLine(blockStartBeats, beatRepeatGridBeats, samplesPerBeat);
+	if (gridOffset >= numSamples)
+		return;
+
 	auto trackIds = trackManager.getAllTrackIds();
 	for (const auto &trackId : trackIds)
 	{
@@ -1041,80 +1143,29 @@ void DjIaVstProcessor::checkBeatRepeatWithSampleCounter()
 
 		if (track->beatRepeatPending.load())
 		{
-			double hostBpm = lastHostBpmForQuantization.load();
-			if (hostBpm <= 0.0)
-				hostBpm = 120.0;
-
-			double halfBeatDurationSamples = (60.0 / hostBpm) * hostSampleRate * 0.5;
-			int64_t currentSample = internalSampleCounter.load();
-			int64_t currentHalfBeatNumber = currentSample / (int64_t)halfBeatDurationSamples;
-
-			if (track->pendingBeatNumber.load() < 0)
+			if (track->randomRetriggerDurationEnabled.load())
 			{
-				track->pendingBeatNumber.store(currentHalfBeatNumber);
-			}
-
-			if (currentHalfBeatNumber > track->pendingBeatNumber.load())
-			{
-				if (track->randomRetriggerDurationEnabled.load())
+				int randomInterval = 1 + beatRepeatRandom.nextInt(10);
+				track->randomRetriggerInterval.store(randomInterval);
+				if (track->slotIndex >= 0 && track->slotIndex < MAX_TRACKS)
 				{
-					int randomInterval = 1 + (rand() % 10);
-					track->randomRetriggerInterval.store(randomInterval);
-					juce::String paramName = "slot" + juce::String(track->slotIndex + 1) + "RetriggerInterval";
-					auto *param = getParameterTreeState().getParameter(paramName);
-					if (param)
+					if (auto *param = slotRetriggerIntervalParameters[track->slotIndex])
 					{
-						float normalizedValue = (randomInterval - 1.0f) / 9.0f;
-						param->setValueNotifyingHost(normalizedValue);
+						param->setValueNotifyingHost(param->convertTo0to1((float)randomInterval));
 					}
 				}
-
-				double currentPosition = track->readPosition.load();
-				double repeatDuration = calculateRetriggerInterval(track->randomRetriggerInterval.load(), hostBpm);
-				double repeatDurationSamples = repeatDuration * track->sampleRate;
-
-				track->originalReadPosition.store(currentPosition);
-				track->beatRepeatStartPosition.store(currentPosition);
-				track->beatRepeatEndPosition.store(currentPosition + repeatDurationSamples);
-
-				double maxSamples = track->numSamples;
-				if (track->beatRepeatEndPosition.load() > maxSamples)
-				{
-					track->beatRepeatEndPosition.store(maxSamples);
-				}
-
-				track->beatRepeatActive.store(true);
-				track->beatRepeatPending.store(false);
-				track->pendingBeatNumber.store(-1);
-				track->readPosition.store(track->beatRepeatStartPosition.load());
 			}
+
+			double repeatDuration = calculateRetriggerInterval(track->randomRetriggerInterval.load(), hostBpm);
+			track->beatRepeatLengthSamples = repeatDuration * track->sampleRate;
+			track->beatRepeatStartOffset = gridOffset;
+			track->beatRepeatPending.store(false);
 		}
 
 		if (track->beatRepeatStopPending.load())
 		{
-			double hostBpm = lastHostBpmForQuantization.load();
-			if (hostBpm <= 0.0)
-				hostBpm = 120.0;
-
-			double halfBeatDurationSamples = (60.0 / hostBpm) * hostSampleRate * 0.5;
-			int64_t currentSample = internalSampleCounter.load();
-			int64_t currentHalfBeatNumber = currentSample / (int64_t)halfBeatDurationSamples;
-
-			if (track->pendingStopBeatNumber.load() < 0)
-			{
-				track->pendingStopBeatNumber.store(currentHalfBeatNumber);
-			}
-
-			if (currentHalfBeatNumber > track->pendingStopBeatNumber.load())
-			{
-				track->beatRepeatActive.store(false);
-				track->beatRepeatStopPending.store(false);
-				track->randomRetriggerActive.store(false);
-				track->lastRetriggerTime.store(-1.0);
-				track->readPosition.store(track->originalReadPosition.load());
-				track->pendingStopBeatNumber.store(-1);
-				DBG("Beat repeat stopped at sample: " << currentSample);
-			}
+			track->beatRepeatStopOffset = gridOffset;
+			track->beatRepeatStopPending.store(false);
 		}
 	}
 }
@@ -1187,20 +1238,14 @@ void DjIaVstProcessor::updateTimeStretchRatios(double hostBpm)
 	}
 }
 
-void DjIaVstProcessor::startNotePlaybackForTrack(const juce::String &trackId, int noteNumber, double /*hostBpm*/)
+void DjIaVstProcessor::startNotePlaybackForTrack(const juce::String &trackId, int noteNumber, int sampleOffset)
 {
 	TrackData *track = trackManager.getTrack(trackId);
 	if (!track || track->numSamples == 0)
 		return;
 	if (getBypassSequencer())
 	{
-		if (!track->beatRepeatActive.load())
-		{
-			track->readPosition = 0.0;
-		}
-		track->setPlaying(true);
-		track->isCurrentlyPlaying.store(true);
-		playingTracks[noteNumber] = trackId;
+		startTrackVoice(track, noteNumber, sampleOffset);
 		return;
 	}
 	if (track->isArmedToStop.load())
@@ -1216,14 +1261,16 @@ void DjIaVstProcessor::startNotePlaybackForTrack(const juce::String &trackId, in
 		return;
 	}
 
-	if (!track->beatRepeatActive.load())
-	{
-		track->readPosition = 0.0;
-	}
+	startTrackVoice(track, noteNumber, sampleOffset);
+}
+
+void DjIaVstProcessor::startTrackVoice(TrackData *track, int noteNumber, int sampleOffset)
+{
+	track->queueVoiceTrigger(sampleOffset);
 	track->setPlaying(true);
 	track->isCurrentlyPlaying.store(true);
 	track->isArmed = false;
-	playingTracks[noteNumber] = trackId;
+	playingTracks[noteNumber] = track->trackId;
 }
 
 void DjIaVstProcessor::stopNotePlaybackForTrack(int noteNumber)
@@ -2355,14 +2402,18 @@ void DjIaVstProcessor::saveBufferToFile(const juce::AudioBuffer<float> &buffer,
 						prompt = track->selectedPrompt;
 					if (prompt.isEmpty())
 						prompt = "Generated sample";
+
+					// Decoding and copying happen before the batch takes the bank lock
+					auto prepared = sampleBank->prepareSample(outputFile);
+					SampleBank::ScopedBatch bankBatch(*sampleBank);
 					if (!track->currentSampleId.isEmpty())
 					{
 						sampleBank->markSampleAsUnused(track->currentSampleId, projectId);
 						DBG("Marked previous sample as unused: " + track->currentSampleId);
 					}
-					juce::String sampleId = sampleBank->addSample(
+					juce::String sampleId = sampleBank->commitSample(
+						prepared,
 						prompt,
-						outputFile,
 						track->generationBpm > 0 ? track->generationBpm : track->originalBpm,
 						track->generationKey.isEmpty() ? "Unknown" : track->generationKey,
 						track->preferredStems);
@@ -2380,7 +2431,7 @@ void DjIaVstProcessor::saveBufferToFile(const juce::AudioBuffer<float> &buffer,
 	}
 }
 
-juce::File DjIaVstProcessor::getTrackAudioFile(const juce::String &trackId)
+juce::File DjIaVstProcessor::getAudioCacheDirectory() const
 {
 	auto audioDir = juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
 						.getChildFile("OBSIDIAN-Neural")
@@ -2389,6 +2440,12 @@ juce::File DjIaVstProcessor::getTrackAudioFile(const juce::String &trackId)
 	{
 		audioDir = audioDir.getChildFile(projectId);
 	}
+	return audioDir;
+}
+
+juce::File DjIaVstProcessor::getTrackAudioFile(const juce::String &trackId)
+{
+	auto audioDir = getAudioCacheDirectory();
 
 	TrackData *track = trackManager.getTrack(trackId);
 	if (track && track->usePages.load())
@@ -2449,7 +2506,16 @@ void DjIaVstProcessor::processAudioBPMAndSync(TrackData *track)
 	{
 		track->originalStagingBuffer.makeCopyOf(track->stagingBuffer);
 		double stretchRatio = hostBpm / static_cast<double>(track->stagingOriginalBpm);
-		AudioAnalyzer::timeStretchBuffer(track->stagingBuffer, stretchRatio, track->stagingSampleRate);
+		juce::String cacheKey = stretchCache.createKey(track->stagingBuffer, track->stagingSampleRate,
+													   stretchRatio, AudioAnalyzer::timeStretchAlgorithm);
+		if (!stretchCache.load(cacheKey, track->stagingBuffer))
+		{
+			double stretchStartMs = juce::Time::getMillisecondCounterHiRes();
+			AudioAnalyzer::timeStretchBuffer(track->stagingBuffer, stretchRatio, track->stagingSampleRate);
+			DBG("Time stretch took " << juce::Time::getMillisecondCounterHiRes() - stretchStartMs << " ms for "
+									 << track->originalStagingBuffer.getNumSamples() << " samples");
+			stretchCache.store(cacheKey, track->stagingBuffer);
+		}
 		track->stagingNumSamples.store(track->stagingBuffer.getNumSamples());
 		track->stagingOriginalBpm = static_cast<float>(hostBpm);
 		track->nextHasOriginalVersion.store(true);
@@ -2568,92 +2634,155 @@ void DjIaVstProcessor::clearCustomPrompts()
 
 void DjIaVstProcessor::getStateInformation(juce::MemoryBlock &destData)
 {
-	juce::ValueTree state("DjIaVstState");
-
-	state.setProperty("projectId", projectId, nullptr);
-	state.setProperty("lastPrompt", juce::var(lastPrompt), nullptr);
-	state.setProperty("lastKey", juce::var(lastKey), nullptr);
-	state.setProperty("lastBpm", juce::var(lastBpm), nullptr);
-	state.setProperty("lastPresetIndex", juce::var(lastPresetIndex), nullptr);
-	state.setProperty("hostBpmEnabled", juce::var(hostBpmEnabled), nullptr);
-	state.setProperty("lastDuration", juce::var(lastDuration), nullptr);
-	state.setProperty("selectedTrackId", juce::var(selectedTrackId), nullptr);
-	state.setProperty("drumsEnabled", juce::var(drumsEnabled), nullptr);
-	state.setProperty("bassEnabled", juce::var(bassEnabled), nullptr);
-	state.setProperty("otherEnabled", juce::var(otherEnabled), nullptr);
-	state.setProperty("vocalsEnabled", juce::var(vocalsEnabled), nullptr);
-	state.setProperty("guitarEnabled", juce::var(guitarEnabled), nullptr);
-	state.setProperty("pianoEnabled", juce::var(pianoEnabled), nullptr);
-	state.setProperty("lastKeyIndex", juce::var(lastKeyIndex), nullptr);
-	state.setProperty("isGenerating", juce::var(isGenerating), nullptr);
-	state.setProperty("autoLoadEnabled", juce::var(autoLoadEnabled.load()), nullptr);
-	state.setProperty("generatingTrackId", juce::var(generatingTrackId), nullptr);
-	state.setProperty("bypassSequencer", juce::var(getBypassSequencer()), nullptr);
-
-	juce::ValueTree midiMappingsState("MidiMappings");
+	if (juce::MessageManager::existsAndIsCurrentThread())
+		trackManager.refreshTrackStates();
+
+	juce::MemoryOutputStream stream(destData, false);
+	stream.writeInt(BinaryState::magic);
+	stream.writeByte((char)BinaryState::currentVersion);
+
+	BinaryState::writeString(stream, projectId);
+	BinaryState::writeString(stream, lastPrompt);
+	BinaryState::writeString(stream, lastKey);
+	BinaryState::writeString(stream, selectedTrackId);
+	BinaryState::writeString(stream, generatingTrackId);
+	stream.writeDouble(lastBpm);
+	stream.writeDouble(lastDuration);
+	stream.writeCompressedInt(lastPresetIndex);
+	stream.writeCompressedInt(lastKeyIndex);
+	stream.writeInt((int)BinaryState::packFlags({hostBpmEnabled, drumsEnabled, bassEnabled, otherEnabled, vocalsEnabled,
+												  guitarEnabled, pianoEnabled, isGenerating, autoLoadEnabled.load(),
+												  getBypassSequencer()}));
+
 	auto mappings = midiLearnManager.getAllMappings();
-	for (int i = 0; i < mappings.size(); ++i)
+	stream.writeCompressedInt((int)mappings.size());
+	for (const auto &mapping : mappings)
 	{
-		const auto &mapping = mappings[i];
-		juce::ValueTree mappingState("Mapping");
-		mappingState.setProperty("midiType", mapping.midiType, nullptr);
-		mappingState.setProperty("midiNumber", mapping.midiNumber, nullptr);
-		mappingState.setProperty("midiChannel", mapping.midiChannel, nullptr);
-		mappingState.setProperty("parameterName", mapping.parameterName, nullptr);
-		mappingState.setProperty("description", mapping.description, nullptr);
-		midiMappingsState.appendChild(mappingState, nullptr);
+		stream.writeCompressedInt(mapping.midiType);
+		stream.writeCompressedInt(mapping.midiNumber);
+		stream.writeCompressedInt(mapping.midiChannel);
+		BinaryState::writeString(stream, mapping.parameterName);
+		BinaryState::writeString(stream, mapping.description);
 	}
-	state.appendChild(midiMappingsState, nullptr);
-
-	auto tracksState = trackManager.saveState();
-	state.appendChild(tracksState, nullptr);
 
-	juce::ValueTree parametersState("Parameters");
+	trackManager.writeBinaryState(stream);
 
 	auto &params = getParameterTreeState();
-	for (const auto &paramId : booleanParamIds)
+	juce::MemoryOutputStream parametersStream;
+	int numParameters = 0;
+	for (const auto *paramIds : {&booleanParamIds, &floatParamIds})
 	{
-		auto *param = params.getParameter(paramId);
-		if (param)
+		for (const auto &paramId : *paramIds)
 		{
-			parametersState.setProperty(paramId, param->getValue(), nullptr);
+			if (auto *param = params.getParameter(paramId))
+			{
+				BinaryState::writeString(parametersStream, paramId);
+				parametersStream.writeFloat(param->getValue());
+				++numParameters;
+			}
 		}
 	}
-	for (const auto &paramId : floatParamIds)
+	stream.writeCompressedInt(numParameters);
+	stream.write(parametersStream.getData(), parametersStream.getDataSize());
+
+	BinaryState::writeString(stream, globalPrompt);
+	BinaryState::writeString(stream, globalKey);
+	stream.writeFloat(globalBpm);
+	stream.writeCompressedInt(globalDuration);
+	BinaryState::writeStringList(stream, globalStems);
+}
+
+void DjIaVstProcessor::setStateInformation(const void *data, int sizeInBytes)
+{
+	const bool loaded = BinaryState::hasHeader(data, sizeInBytes) ? loadBinaryState(data, sizeInBytes)
+																  : loadXmlState(data, sizeInBytes);
+	if (!loaded)
 	{
-		auto *param = params.getParameter(paramId);
-		if (param)
+		return;
+	}
+	finishStateRestore();
+}
+
+bool DjIaVstProcessor::loadBinaryState(const void *data, int sizeInBytes)
+{
+	juce::MemoryInputStream stream(data, (size_t)sizeInBytes, false);
+	stream.readInt();
+	const auto version = (juce::uint8)stream.readByte();
+	if (version == 0 || version > BinaryState::currentVersion)
+	{
+		DBG("Unsupported plugin state version: " << (int)version);
+		return false;
+	}
+
+	projectId = BinaryState::readString(stream);
+	if (projectId.isEmpty())
+		projectId = "legacy";
+	lastPrompt = BinaryState::readString(stream);
+	lastKey = BinaryState::readString(stream);
+	selectedTrackId = BinaryState::readString(stream);
+	generatingTrackId = BinaryState::readString(stream);
+	lastBpm = stream.readDouble();
+	lastDuration = stream.readDouble();
+	lastPresetIndex = stream.readCompressedInt();
+	lastKeyIndex = stream.readCompressedInt();
+
+	const auto flags = (juce::uint32)stream.readInt();
+	hostBpmEnabled = BinaryState::flag(flags, 0);
+	drumsEnabled = BinaryState::flag(flags, 1);
+	bassEnabled = BinaryState::flag(flags, 2);
+	otherEnabled = BinaryState::flag(flags, 3);
+	vocalsEnabled = BinaryState::flag(flags, 4);
+	guitarEnabled = BinaryState::flag(flags, 5);
+	pianoEnabled = BinaryState::flag(flags, 6);
+	isGenerating = BinaryState::flag(flags, 7);
+	autoLoadEnabled.store(BinaryState::flag(flags, 8));
+	setBypassSequencer(BinaryState::flag(flags, 9));
+
+	{
+		MidiLearnManager::ScopedRebuildBatch mappingBatch(midiLearnManager);
+		midiLearnManager.clearAllMappings();
+		const int numMappings = stream.readCompressedInt();
+		for (int i = 0; i < numMappings && !stream.isExhausted(); ++i)
 		{
-			parametersState.setProperty(paramId, param->getValue(), nullptr);
+			const int midiType = stream.readCompressedInt();
+			const int midiNumber = stream.readCompressedInt();
+			const int midiChannel = stream.readCompressedInt();
+			const auto parameterName = BinaryState::readString(stream);
+			const auto description = BinaryState::readString(stream);
+			addRestoredMidiMapping(midiType, midiNumber, midiChannel, parameterName, description);
 		}
 	}
-	state.appendChild(parametersState, nullptr);
 
-	auto globalGenState = juce::ValueTree("GlobalGeneration");
-	globalGenState.setProperty("prompt", globalPrompt, nullptr);
-	globalGenState.setProperty("bpm", globalBpm, nullptr);
-	globalGenState.setProperty("key", globalKey, nullptr);
-	globalGenState.setProperty("duration", globalDuration, nullptr);
-	juce::String stemsString;
-	for (int i = 0; i < globalStems.size(); ++i)
+	if (!trackManager.readBinaryState(stream))
 	{
-		if (i > 0)
-			stemsString += ",";
-		stemsString += globalStems[i];
+		DBG("Plugin state track data is truncated");
+		return false;
+	}
+
+	auto &params = getParameterTreeState();
+	const int numParameters = stream.readCompressedInt();
+	for (int i = 0; i < numParameters && !stream.isExhausted(); ++i)
+	{
+		const auto paramId = BinaryState::readString(stream);
+		const float value = stream.readFloat();
+		if (auto *param = params.getParameter(paramId))
+			param->setValueNotifyingHost(value);
 	}
-	globalGenState.setProperty("stems", stemsString, nullptr);
-	state.appendChild(globalGenState, nullptr);
 
-	std::unique_ptr<juce::XmlElement> xml(state.createXml());
-	copyXmlToBinary(*xml, destData);
+	globalPrompt = BinaryState::readString(stream);
+	globalKey = BinaryState::readString(stream);
+	globalBpm = stream.readFloat();
+	globalDuration = stream.readCompressedInt();
+	globalStems = BinaryState::readStringList(stream);
+	return true;
 }
 
-void DjIaVstProcessor::setStateInformation(const void *data, int sizeInBytes)
+bool DjIaVstProcessor::loadXmlState(const void *data, int sizeInBytes)
 {
 	std::unique_ptr<juce::XmlElement> xml(getXmlFromBinary(data, sizeInBytes));
 	if (!xml || !xml->hasTagName("DjIaVstState"))
 	{
-		return;
+		return false;
 	}
 	juce::ValueTree state = juce::ValueTree::fromXml(*xml);
 
@@ -2683,35 +2812,19 @@ void DjIaVstProcessor::setStateInformation(const void *data, int sizeInBytes)
 	}
 
 	selectedTrackId = state.getProperty("selectedTrackId", "").toString();
-	auto loadedTrackIds = trackManager.getAllTrackIds();
-
-	if (selectedTrackId.isEmpty() || !trackManager.getTrack(selectedTrackId))
-	{
-		if (!loadedTrackIds.empty())
-		{
-			selectedTrackId = loadedTrackIds[0];
-		}
-		else
-		{
-			selectedTrackId = trackManager.createTrack("Main");
-		}
-	}
 	juce::ValueTree midiMappingsState = state.getChildWithName("MidiMappings");
 	if (midiMappingsState.isValid())
 	{
+		MidiLearnManager::ScopedRebuildBatch mappingBatch(midiLearnManager);
 		midiLearnManager.clearAllMappings();
 		for (int i = 0; i < midiMappingsState.getNumChildren(); ++i)
 		{
-			MidiMapping mapping;
 			juce::ValueTree mappingState = midiMappingsState.getChild(i);
-			mapping.midiType = mappingState.getProperty("midiType");
-			mapping.midiNumber = mappingState.getProperty("midiNumber");
-			mapping.midiChannel = mappingState.getProperty("midiChannel");
-			mapping.parameterName = mappingState.getProperty("parameterName");
-			mapping.description = mappingState.getProperty("description");
-			mapping.processor = this;
-			mapping.uiCallback = nullptr;
-			midiLearnManager.addMapping(mapping);
+			addRestoredMidiMapping(mappingState.getProperty("midiType"),
+								   mappingState.getProperty("midiNumber"),
+								   mappingState.getProperty("midiChannel"),
+								   mappingState.getProperty("parameterName"),
+								   mappingState.getProperty("description"));
 		}
 	}
 	auto globalGenState = state.getChildWithName("GlobalGeneration");
@@ -2760,7 +2873,67 @@ void DjIaVstProcessor::setStateInformation(const void *data, int sizeInBytes)
 			}
 		}
 	}
-	projectId = state.getProperty("projectId", "legacy").toString();
+	return true;
+}
+
+bool DjIaVstProcessor::saveSessionBundle(const juce::File &bundleFile)
+{
+	juce::MemoryBlock state;
+	getStateInformation(state);
+
+	std::vector<SessionBundle::AudioSource> audioSources;
+	for (const auto &trackState : *trackManager.getTrackStates())
+		audioSources.insert(audioSources.end(), trackState->audioSources.begin(), trackState->audioSources.end());
+
+	return SessionBundle::write(bundleFile, state, audioSources);
+}
+
+bool DjIaVstProcessor::loadSessionBundle(const juce::File &bundleFile)
+{
+	auto bundle = SessionBundle::open(bundleFile);
+	if (bundle == nullptr)
+	{
+		DBG("Cannot open session bundle: " << bundleFile.getFullPathName());
+		return false;
+	}
+
+	// Evaluated once the bundle's project id has been restored
+	trackManager.useSessionBundle(bundle, [this]()
+								  { return getAudioCacheDirectory(); });
+	setStateInformation(bundle->getStateData(), bundle->getStateSize());
+	trackManager.releaseSessionBundle();
+	return true;
+}
+
+void DjIaVstProcessor::addRestoredMidiMapping(int midiType, int midiNumber, int midiChannel,
+											   const juce::String &parameterName, const juce::String &description)
+{
+	MidiMapping mapping;
+	mapping.midiType = midiType;
+	mapping.midiNumber = midiNumber;
+	mapping.midiChannel = midiChannel;
+	mapping.parameterName = parameterName;
+	mapping.description = description;
+	mapping.processor = this;
+	mapping.uiCallback = nullptr;
+	midiLearnManager.addMapping(mapping);
+}
+
+void DjIaVstProcessor::finishStateRestore()
+{
+	auto loadedTrackIds = trackManager.getAllTrackIds();
+
+	if (selectedTrackId.isEmpty() || !trackManager.getTrack(selectedTrackId))
+	{
+		if (!loadedTrackIds.empty())
+		{
+			selectedTrackId = loadedTrackIds[0];
+		}
+		else
+		{
+			selectedTrackId = trackManager.createTrack("Main");
+		}
+	}
 
 	if (projectId == "legacy" || projectId.isEmpty())
 	{
@@ -3148,7 +3321,7 @@ void DjIaVstProcessor::executePendingAction(TrackData *track) const
 	track->pendingAction = TrackData::PendingAction::None;
 }
 
-void DjIaVstProcessor::updateSequencers(bool hostIsPlaying)
+void DjIaVstProcessor::updateSequencers(bool hostIsPlaying, double hostBpm, int numSamples)
 {
 	if (getBypassSequencer())
 	{
@@ -3165,7 +3338,10 @@ void DjIaVstProcessor::updateSequencers(bool hostIsPlaying)
 		return;
 
 	double currentPpq = *ppqPosition;
-	double stepInPpq = 0.25;
+	if (hostBpm <= 0.0)
+		hostBpm = 120.0;
+	double ppqPerSample = hostBpm / (60.0 * hostSampleRate);
+	int stepsPerMeasure = SequencerPattern::stepsPerMeasureFor(getTimeSignatureNumerator(), getTimeSignatureDenominator());
 
 	auto trackIds = trackManager.getAllTrackIds();
 	for (const auto &trackId : trackIds)
@@ -3173,27 +3349,57 @@ void DjIaVstProcessor::updateSequencers(bool hostIsPlaying)
 		TrackData *track = trackManager.getTrack(trackId);
 		if (track)
 		{
-			double expectedPpqForNextStep = track->lastPpqPosition + stepInPpq;
-
-			bool shouldAdvanceStep = false;
-			if (track->lastPpqPosition < 0)
-			{
-				double totalStepsFromStart = currentPpq / stepInPpq;
-				track->customStepCounter = static_cast<int>(totalStepsFromStart);
-				track->lastPpqPosition = track->customStepCounter * stepInPpq;
-				shouldAdvanceStep = true;
-			}
-			else if (currentPpq >= expectedPpqForNextStep)
+			struct TrackSequencer
 			{
-				track->customStepCounter++;
-				track->lastPpqPosition = expectedPpqForNextStep;
-				shouldAdvanceStep = true;
-			}
+				DjIaVstProcessor &processor;
+				TrackData *track;
+				bool hostIsPlaying;
+				int stepsPerMeasure;
 
-			if (shouldAdvanceStep)
-			{
-				handleAdvanceStep(track, hostIsPlaying);
-			}
+				int stepsUntilNextEvent(int) { return stepsUntilNextSequencerEvent(track, stepsPerMeasure); }
+				bool canTrigger() const { return track->numVoiceTriggers < TrackData::maxVoiceTriggersPerBlock; }
+
+				double microTiming(int stepCounter) const
+				{
+					int measure = 0;
+					int step = 0;
+					stepCounterToPosition(stepCounter, stepsPerMeasure, track->sequencerData.numMeasures, measure, step);
+					return track->sequencerData.pattern.getMicroTiming(measure, step);
+				}
+
+				bool advanceStep(int) { return processor.handleAdvanceStep(track, hostIsPlaying, stepsPerMeasure); }
+
+				bool canDecideEarly(int) const
+				{
+					return hostIsPlaying && track->isCurrentlyPlaying.load() &&
+						   track->pendingAction == TrackData::PendingAction::None;
+				}
+
+				bool stepWillSound(int stepCounter)
+				{
+					int measure = 0;
+					int step = 0;
+					stepCounterToPosition(stepCounter, stepsPerMeasure, track->sequencerData.numMeasures, measure, step);
+					return processor.rollSequencerStep(track, measure, step);
+				}
+
+				void trigger(int stepCounter, int sampleOffset)
+				{
+					int measure = 0;
+					int step = 0;
+					stepCounterToPosition(stepCounter, stepsPerMeasure, track->sequencerData.numMeasures, measure, step);
+					processor.triggerSequencerStep(track, track->sequencerData.pattern.getVelocity(measure, step), sampleOffset);
+				}
+
+				void idleAt(int stepCounter)
+				{
+					stepCounterToPosition(stepCounter, stepsPerMeasure, track->sequencerData.numMeasures,
+										  track->sequencerData.currentMeasure, track->sequencerData.currentStep);
+				}
+			} sequencer{*this, track, hostIsPlaying, stepsPerMeasure};
+
+			track->sequencerClock.process(currentPpq, ppqPerSample, numSamples,
+										  TrackData::maxVoiceTriggersPerBlock, sequencer);
 
 			if (auto *editor = dynamic_cast<DjIaVstEditor *>(getActiveEditor()))
 			{
@@ -3212,37 +3418,39 @@ void DjIaVstProcessor::updateSequencers(bool hostIsPlaying)
 	}
 }
 
-void DjIaVstProcessor::handleAdvanceStep(TrackData *track, bool hostIsPlaying)
+void DjIaVstProcessor::stepCounterToPosition(int stepCounter, int stepsPerMeasure, int numMeasures, int &measure, int &step)
 {
-	int numerator = getTimeSignatureNumerator();
-	int denominator = getTimeSignatureDenominator();
+	SequencerClock::stepCounterToPosition(stepCounter, stepsPerMeasure,
+										  juce::jlimit(1, SequencerPattern::maxMeasures, numMeasures), measure, step);
+}
 
-	int stepsPerBeat;
-	if (denominator == 8)
-	{
-		stepsPerBeat = 2;
-	}
-	else if (denominator == 4)
-	{
-		stepsPerBeat = 4;
-	}
-	else if (denominator == 2)
-	{
-		stepsPerBeat = 8;
-	}
-	else
-	{
-		stepsPerBeat = 4;
-	}
+int DjIaVstProcessor::stepsUntilNextSequencerEvent(const TrackData *track, int stepsPerMeasure)
+{
+	int numMeasures = juce::jlimit(1, SequencerPattern::maxMeasures, track->sequencerData.numMeasures);
+	int measure = 0;
+	int step = 0;
+	stepCounterToPosition(track->sequencerClock.stepCounter, stepsPerMeasure, numMeasures, measure, step);
+
+	int stepsToActive = track->sequencerData.pattern.stepsUntilNextActive(measure, step, stepsPerMeasure, numMeasures);
+	return SequencerClock::stepsUntilNextEvent(measure, step, stepsPerMeasure, numMeasures, stepsToActive);
+}
 
-	int stepsPerMeasure = numerator * stepsPerBeat;
-	int newStep = track->customStepCounter % stepsPerMeasure;
-	int newMeasure = (track->customStepCounter / stepsPerMeasure) % track->sequencerData.numMeasures;
+bool DjIaVstProcessor::rollSequencerStep(const TrackData *track, int measure, int step)
+{
+	const auto &pattern = track->sequencerData.pattern;
+	if (!pattern.isActive(measure, step))
+		return false;
+	float probability = pattern.getProbability(measure, step);
+	return probability >= 1.0f || sequencerRandom.nextFloat() < probability;
+}
 
-	int safeMeasure = juce::jlimit(0, track->sequencerData.numMeasures - 1, newMeasure);
-	int safeStep = juce::jlimit(0, stepsPerMeasure - 1, newStep);
+bool DjIaVstProcessor::handleAdvanceStep(TrackData *track, bool hostIsPlaying, int stepsPerMeasure)
+{
+	int newMeasure = 0;
+	int newStep = 0;
+	stepCounterToPosition(track->sequencerClock.stepCounter, stepsPerMeasure, track->sequencerData.numMeasures, newMeasure, newStep);
 
-	bool currentStepIsActive = track->sequencerData.steps[safeMeasure][safeStep];
+	bool currentStepIsActive = rollSequencerStep(track, newMeasure, newStep);
 
 	if (newMeasure == 0 && track->isArmed.load() && newStep == 0 && !track->isPlaying.load() && hostIsPlaying)
 	{
@@ -3257,17 +3465,7 @@ void DjIaVstProcessor::handleAdvanceStep(TrackData *track, bool hostIsPlaying)
 	track->sequencerData.currentStep = newStep;
 	track->sequencerData.currentMeasure = newMeasure;
 
-	if (currentStepIsActive &&
-		track->isCurrentlyPlaying.load() && hostIsPlaying)
-	{
-
-		if (!track->beatRepeatActive.load())
-		{
-			track->readPosition = 0.0;
-		}
-		track->setPlaying(true);
-		triggerSequencerStep(track);
-	}
+	return currentStepIsActive && track->isCurrentlyPlaying.load() && hostIsPlaying;
 }
 
 bool DjIaVstProcessor::previewSampleFromBank(const juce::String &sampleId)
@@ -3282,71 +3480,31 @@ bool DjIaVstProcessor::previewSampleFromBank(const juce::String &sampleId)
 	if (!sampleFile.exists())
 		return false;
 
-	juce::AudioFormatManager formatManager;
-	formatManager.registerBasicFormats();
-	std::unique_ptr<juce::AudioFormatReader> testReader(formatManager.createReaderFor(sampleFile));
-	if (!testReader)
-	{
-		DBG("Cannot read audio file: " + sampleFile.getFullPathName());
-		return false;
-	}
-
-	stopSamplePreview();
-
-	juce::Thread::launch([this, sampleFile]()
-						 {
-			juce::AudioFormatManager formatManager;
-			formatManager.registerBasicFormats();
-			std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(sampleFile));
-			if (!reader) {
-				juce::ScopedLock lock(previewLock);
-				isPreviewPlaying = false;
-				return;
-			}
-
-			{
-				juce::ScopedLock lock(previewLock);
-				previewBuffer.setSize(2, (int)reader->lengthInSamples);
-				reader->read(&previewBuffer, 0, (int)reader->lengthInSamples, 0, true, true);
-				if (reader->numChannels == 1)
-				{
-					previewBuffer.copyFrom(1, 0, previewBuffer, 0, 0, previewBuffer.getNumSamples());
-				}
-				previewSampleRate = reader->sampleRate;
-				previewPosition = 0.0;
-				isPreviewPlaying = true;
-			}
-			DBG("Preview loaded: " + sampleFile.getFileName()); });
-
+	previewVoice.start(sampleFile);
+	DBG("Preview streaming: " + sampleFile.getFileName());
 	return true;
 }
 
-void DjIaVstProcessor::triggerSequencerStep(TrackData *track)
+void DjIaVstProcessor::triggerSequencerStep(TrackData *track, float velocity, int sampleOffset)
 {
 	if (getBypassSequencer())
 	{
 		return;
 	}
-	int step = track->sequencerData.currentStep;
-	int measure = track->sequencerData.currentMeasure;
 	track->isArmed = false;
-	if (track->sequencerData.steps[measure][step])
+	if (track->trackId == trackIdWaitingForLoad)
 	{
-		if (!track->beatRepeatActive.load())
-		{
-			track->readPosition = 0.0;
-		}
-		playingTracks[track->midiNote] = track->trackId;
-		juce::MidiMessage noteOn = juce::MidiMessage::noteOn(1, track->midiNote,
-															 (juce::uint8)(track->sequencerData.velocities[measure][step] * 127));
-		addSequencerMidiMessage(noteOn);
+		correctMidiNoteReceived = true;
 	}
+	startTrackVoice(track, track->midiNote, sampleOffset);
+	sequencerTriggeredNotes.addIfNotAlreadyThere(track->midiNote);
+	sequencerMidiOutput.addEvent(juce::MidiMessage::noteOn(1, track->midiNote, (juce::uint8)juce::jlimit(1, 127, juce::roundToInt(velocity * 127.0f))),
+								 sampleOffset);
 }
 
 void DjIaVstProcessor::stopSamplePreview()
 {
-	isPreviewPlaying = false;
-	previewPosition = 0.0;
+	previewVoice.stop();
 }
 
 juce::File DjIaVstProcessor::getTrackPageAudioFile(const juce::String &trackId, int pageIndex)
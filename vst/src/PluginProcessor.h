@@ -5,10 +5,16 @@
 #include "MidiLearnManager.h"
 #include "ObsidianEngine.h"
 #include "SimpleEQ.h"
+#include "MasterLimiter.h"
+#include "LevelMeter.h"
+#include "SpectrumAnalyzer.h"
+#include "SamplePreviewVoice.h"
 #include "SampleBank.h"
+#include "StretchCache.h"
 #include <memory>
 #include <unordered_map>
 #include <vector>
+#include <array>
 #include <atomic>
 
 class DjIaVstEditor;
@@ -47,6 +53,7 @@ public:
 	void handlePreviewPlaying(juce::AudioSampleBuffer &buffer);
 	void checkIfUIUpdateNeeded(juce::MidiBuffer &midiMessages);
 	void applyMasterEffects(juce::AudioSampleBuffer &mainOutput);
+	void compensateAuxiliaryBusLatency(juce::AudioSampleBuffer &buffer);
 	void copyTracksToIndividualOutputs(juce::AudioSampleBuffer &buffer);
 	void clearOutputBuffers(juce::AudioSampleBuffer &buffer);
 	void resizeIndividualsBuffers(juce::AudioSampleBuffer &buffer);
@@ -108,7 +115,7 @@ public:
 	TrackData *getCurrentTrack() { return trackManager.getTrack(selectedTrackId); }
 	TrackData *getTrack(const juce::String &trackId) { return trackManager.getTrack(trackId); }
 	void generateLoop(const DjIaClient::LoopRequest &request, const juce::String &targetTrackId = "");
-	void startNotePlaybackForTrack(const juce::String &trackId, int noteNumber, double hostBpm = 126.0);
+	void startNotePlaybackForTrack(const juce::String &trackId, int noteNumber, int sampleOffset = 0);
 	void setApiKey(const juce::String &key);
 	void setServerUrl(const juce::String &url);
 	double getHostBpm() const;
@@ -149,7 +156,6 @@ public:
 	int getSamplesPerBlock() const { return currentBlockSize; };
 	int getRequestTimeout() const { return requestTimeoutMS; };
 	void handleSequencerPlayState(bool hostIsPlaying);
-	void addSequencerMidiMessage(const juce::MidiMessage &message);
 	void setRequestTimeout(int requestTimeoutMS);
 	void prepareToPlay(double newSampleRate, int samplesPerBlock);
 	std::function<void(double)> onHostBpmChanged = nullptr;
@@ -208,6 +214,14 @@ public:
 	juce::String getLocalModelsPath() const { return localModelsPath; }
 	void setLocalModelsPath(const juce::String &path) { localModelsPath = path; }
 
+	float getLimiterLookaheadMs() const { return limiterLookaheadMs.load(); }
+	void setLimiterLookaheadMs(float lookaheadMs);
+	float getLimiterGainReductionDb() const { return masterLimiter.getGainReductionDb(); }
+
+	LevelMeter &getSlotMeter(int slot) { return slotMeters[(size_t)juce::jlimit(0, MAX_TRACKS - 1, slot)]; }
+	LevelMeter &getMasterMeter() { return masterMeter; }
+	SpectrumAnalyzer &getSpectrumAnalyzer() { return spectrumAnalyzer; }
+
 	static juce::String getModelsDirectory()
 	{
 		return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
@@ -227,30 +241,32 @@ public:
 	SampleBank *getSampleBank() { return sampleBank.get(); }
 	void loadSampleFromBank(const juce::String &sampleId, const juce::String &trackId);
 	void loadAudioFileAsync(const juce::String &trackId, const juce::File &audioData);
+	bool saveSessionBundle(const juce::File &bundleFile);
+	bool loadSessionBundle(const juce::File &bundleFile);
 	bool previewSampleFromBank(const juce::String &sampleId);
 	void stopSamplePreview();
-	bool isSamplePreviewing() const { return isPreviewPlaying.load(); }
+	bool isSamplePreviewing() const { return previewVoice.isPlaying(); }
 
 private:
 	DjIaVstEditor *currentEditor = nullptr;
 	SimpleEQ masterEQ;
+	MasterLimiter masterLimiter;
+	std::atomic<float> limiterLookaheadMs{MasterLimiter::defaultLookaheadMs};
+	void configureMasterLimiter();
 	MidiLearnManager midiLearnManager;
 	DjIaClient apiClient;
 	GenerationListener *generationListener = nullptr;
 	juce::String projectId;
 	bool migrationCompleted = false;
 	std::unique_ptr<SampleBank> sampleBank;
+	StretchCache stretchCache;
 
 	std::atomic<float> *nextTrackParam = nullptr;
 	std::atomic<float> *prevTrackParam = nullptr;
 	std::atomic<int64_t> internalSampleCounter{0};
 	std::atomic<double> lastHostBpmForQuantization{120.0};
 
-	std::atomic<bool> isPreviewPlaying{false};
-	juce::AudioBuffer<float> previewBuffer;
-	std::atomic<double> previewPosition{0.0};
-	std::atomic<double> previewSampleRate{44100.0};
-	juce::CriticalSection previewLock;
+	SamplePreviewVoice previewVoice;
 
 	std::atomic<bool> isLoadingFromBank{false};
 	juce::String currentBankLoadTrackId;
@@ -265,6 +281,12 @@ private:
 
 	static juce::AudioProcessor::BusesProperties createBusLayout();
 	static const int MAX_TRACKS = 8;
+	std::array<LatencyDelay, MAX_TRACKS + 1> auxiliaryBusDelays;
+	std::array<LevelMeter, MAX_TRACKS> slotMeters;
+	LevelMeter masterMeter;
+	SpectrumAnalyzer spectrumAnalyzer;
+	void measureOutputLevels(const juce::AudioSampleBuffer &mainOutput);
+	void feedSpectrumAnalyzer(const juce::AudioSampleBuffer &mainOutput);
 
 	juce::StringArray customPrompts;
 
@@ -272,8 +294,6 @@ private:
 	double lastDuration = 6.0;
 	double hostSampleRate;
 
-	float smoothedMasterVol = 1.0f;
-	float smoothedMasterPan = 0.0f;
 
 	bool hostBpmEnabled = true;
 	bool drumsEnabled = false;
@@ -315,11 +335,11 @@ private:
 	std::mutex requestsMutex;
 
 	juce::CriticalSection apiLock;
-	juce::CriticalSection sequencerMidiLock;
-
 	juce::File pendingAudioFile;
 
-	juce::MidiBuffer sequencerMidiBuffer;
+	juce::Array<int> sequencerTriggeredNotes;
+	juce::MidiBuffer sequencerMidiOutput;
+	static constexpr int sequencerMidiEventBytes = 16;
 
 	juce::AudioProcessorValueTreeState parameters;
 	juce::String serverUrl = "";
@@ -401,6 +421,32 @@ private:
 	std::atomic<float> *slotBpmOffsetParams[8] = {nullptr};
 	std::atomic<float> *slotRandomRetriggerParams[8];
 	std::atomic<float> *slotRetriggerIntervalParams[8];
+	juce::RangedAudioParameter *slotRetriggerIntervalParameters[8] = {nullptr};
+	std::atomic<float> *slotFilterParams[8] = {nullptr};
+	std::atomic<float> *slotLowEqParams[8] = {nullptr};
+	std::atomic<float> *slotMidEqParams[8] = {nullptr};
+	std::atomic<float> *slotHighEqParams[8] = {nullptr};
+	std::atomic<float> *slotInsertGainParams[8] = {nullptr};
+	std::atomic<float> *slotSendParams[8] = {nullptr};
+
+	static constexpr double beatRepeatGridBeats = 0.5;
+	static constexpr juce::int64 beatRepeatRandomSeed = 0x0b5d1a4e;
+	juce::Random beatRepeatRandom{beatRepeatRandomSeed};
+
+	struct SlotParameterListener : public juce::AudioProcessorValueTreeState::Listener
+	{
+		SlotParameterListener(std::atomic<juce::uint32> &dirtyMask, int slot) : dirtyMask(dirtyMask), slotBit(1u << slot) {}
+		void parameterChanged(const juce::String &, float) override { dirtyMask.fetch_or(slotBit); }
+		std::atomic<juce::uint32> &dirtyMask;
+		const juce::uint32 slotBit;
+	};
+	static constexpr const char *slotListenedParameterSuffixes[] = {"Volume", "Pan", "Pitch", "Fine", "Solo", "Mute", "RandomRetrigger", "RetriggerInterval", "Filter", "LowEq", "MidEq", "HighEq", "InsertGain", "Send"};
+	std::atomic<juce::uint32> dirtySlotParams{0xffffffffu};
+	std::vector<std::unique_ptr<SlotParameterListener>> slotParameterListeners;
+	static constexpr juce::int64 sequencerRandomSeed = 0x5e0c0de5;
+	juce::Random sequencerRandom{sequencerRandomSeed};
+	static constexpr int trackStateRefreshInterval = 8;
+	int trackStateRefreshTicks = 0;
 
 	static juce::File getGlobalConfigFile()
 	{
@@ -412,7 +458,7 @@ private:
 	void processIncomingAudio(bool hostIsPlaying);
 	void clearPendingAudio();
 	void processMidiMessages(juce::MidiBuffer &midiMessages, bool hostIsPlaying, double hostBpm);
-	void playTrack(const juce::MidiMessage &message, double hostBpm);
+	void playTrack(const juce::MidiMessage &message, int sampleOffset);
 	void handlePlayAndStop(bool hostIsPlaying);
 	void updateTimeStretchRatios(double hostBpm);
 	void updateMasterEQ();
@@ -424,9 +470,13 @@ private:
 	void performTrackDeletion(const juce::String &trackId);
 	void reassignTrackOutputsAndMidi();
 	void stopNotePlaybackForTrack(int noteNumber);
-	void updateSequencers(bool hostIsPlaying);
-	void handleAdvanceStep(TrackData *track, bool hostIsPlaying);
-	void triggerSequencerStep(TrackData *track);
+	void updateSequencers(bool hostIsPlaying, double hostBpm, int numSamples);
+	bool handleAdvanceStep(TrackData *track, bool hostIsPlaying, int stepsPerMeasure);
+	bool rollSequencerStep(const TrackData *track, int measure, int step);
+	static void stepCounterToPosition(int stepCounter, int stepsPerMeasure, int numMeasures, int &measure, int &step);
+	static int stepsUntilNextSequencerEvent(const TrackData *track, int stepsPerMeasure);
+	void triggerSequencerStep(TrackData *track, float velocity, int sampleOffset);
+	void startTrackVoice(TrackData *track, int noteNumber, int sampleOffset);
 	void saveBufferToFile(const juce::AudioBuffer<float> &buffer,
 						  const juce::File &outputFile,
 						  double sampleRate);
@@ -453,6 +503,7 @@ private:
 
 	juce::Slider *findBpmOffsetSliderInTrack(TrackComponent *trackComponent);
 
+	juce::File getAudioCacheDirectory() const;
 	juce::File getTrackAudioFile(const juce::String &trackId);
 
 	void handleGenerationComplete(const juce::String &trackId,
@@ -461,8 +512,14 @@ private:
 
 	juce::File createTempAudioFile(const std::vector<float> &audioData, float duration);
 	void performMigrationIfNeeded();
+	bool loadBinaryState(const void *data, int sizeInBytes);
+	bool loadXmlState(const void *data, int sizeInBytes);
+	void finishStateRestore();
+	void addRestoredMidiMapping(int midiType, int midiNumber, int midiChannel,
+								const juce::String &parameterName, const juce::String &description);
 	void updateTrackPathsAfterMigration();
-	void checkBeatRepeatWithSampleCounter();
+	void scheduleBeatRepeats(double blockStartBeats, double hostBpm, int numSamples);
+	static int samplesUntilNextGridLine(double positionInBeats, double gridBeats, double samplesPerBeat);
 	void generateLoopFromGlobalSettings();
 
 	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DjIaVstProcessor);
@@ -0,0 +1,124 @@
+#include "PromptIndex.h"
+#include "SampleBank.h"
+
+void PromptIndex::add(SampleBankEntry *entry)
+{
+	for (const auto &token : tokenise(entry->originalPrompt))
+		postings[token].insert(entry);
+}
+
+void PromptIndex::remove(SampleBankEntry *entry)
+{
+	for (const auto &token : tokenise(entry->originalPrompt))
+	{
+		auto it = postings.find(token);
+		if (it == postings.end())
+			continue;
+		it->second.erase(entry);
+		if (it->second.empty())
+			postings.erase(it);
+	}
+}
+
+juce::StringArray PromptIndex::tokenise(const juce::String &text)
+{
+	juce::StringArray tokens;
+	tokens.addTokens(text.toLowerCase(), " \t\r\n,.;:!?/\\-_()[]{}\"'", "");
+	tokens.removeEmptyStrings();
+	tokens.removeDuplicates(false);
+	return tokens;
+}
+
+PromptIndex::EntrySet PromptIndex::search(const juce::String &text) const
+{
+	const auto terms = tokenise(text);
+	const bool lastTermFinished = text.isEmpty() || juce::CharacterFunctions::isWhitespace(text.getLastCharacter());
+
+	EntrySet result;
+	for (int i = 0; i < terms.size(); ++i)
+	{
+		EntrySet matches;
+		collectMatches(terms[i], i == terms.size() - 1 && !lastTermFinished, matches);
+
+		if (i == 0)
+		{
+			result = std::move(matches);
+		}
+		else
+		{
+			if (matches.size() < result.size())
+				std::swap(matches, result);
+			for (auto it = result.begin(); it != result.end();)
+				it = matches.count(*it) > 0 ? std::next(it) : result.erase(it);
+		}
+
+		if (result.empty())
+			break;
+	}
+	return result;
+}
+
+void PromptIndex::collectMatches(const juce::String &term, bool asPrefix, EntrySet &matches) const
+{
+	auto it = postings.lower_bound(term);
+	if (asPrefix)
+	{
+		for (; it != postings.end() && it->first.startsWith(term); ++it)
+			matches.insert(it->second.begin(), it->second.end());
+	}
+	else if (it != postings.end() && it->first == term)
+	{
+		matches = it->second;
+	}
+
+	if (!matches.empty() || term.length() < minFuzzyLength || term.length() > maxFuzzyLength)
+		return;
+
+	// Typos rarely hit the first letter, so only that slice of the vocabulary is scanned
+	const int maxDistance = term.length() >= 8 ? 2 : 1;
+	const auto firstChar = term[0];
+	for (auto f = postings.lower_bound(juce::String::charToString(firstChar)); f != postings.end() && f->first[0] == firstChar; ++f)
+	{
+		if (withinEditDistance(f->first, term, asPrefix, maxDistance))
+			matches.insert(f->second.begin(), f->second.end());
+	}
+}
+
+bool PromptIndex::withinEditDistance(const juce::String &token, const juce::String &term, bool asPrefix, int maxDistance)
+{
+	juce::juce_wchar a[maxFuzzyLength + 2], b[maxFuzzyLength];
+	int n = 0, m = 0;
+	for (auto p = term.getCharPointer(); !p.isEmpty() && m < maxFuzzyLength;)
+		b[m++] = p.getAndAdvance();
+
+	// A prefix term is compared against the token's leading characters only
+	const int tokenLimit = asPrefix ? m + maxDistance : maxFuzzyLength + 2;
+	for (auto p = token.getCharPointer(); !p.isEmpty() && n < tokenLimit;)
+		a[n++] = p.getAndAdvance();
+	if (!asPrefix && (n > maxFuzzyLength || std::abs(n - m) > maxDistance))
+		return false;
+
+	int previous[maxFuzzyLength + 1], current[maxFuzzyLength + 1];
+	for (int j = 0; j <= m; ++j)
+		previous[j] = j;
+
+	int best = asPrefix ? previous[m] : maxDistance + 1;
+	for (int i = 1; i <= n; ++i)
+	{
+		current[0] = i;
+		int rowMin = current[0];
+		for (int j = 1; j <= m; ++j)
+		{
+			const int substitution = previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+			current[j] = std::min({previous[j] + 1, current[j - 1] + 1, substitution});
+			rowMin = std::min(rowMin, current[j]);
+		}
+		if (rowMin > maxDistance)
+			return false;
+		if (asPrefix)
+			best = std::min(best, current[m]);
+		std::copy(current, current + m + 1, previous);
+	}
+
+	return (asPrefix ? best : previous[m]) <= maxDistance;
+}
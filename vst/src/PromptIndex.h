@@ -0,0 +1,31 @@
+#pragma once
+#include "JuceHeader.h"
+#include <map>
+#include <unordered_set>
+
+struct SampleBankEntry;
+
+class PromptIndex
+{
+public:
+	using EntrySet = std::unordered_set<SampleBankEntry *>;
+
+	void add(SampleBankEntry *entry);
+	void remove(SampleBankEntry *entry);
+	void clear() { postings.clear(); }
+
+	// Every term must match; an unfinished last term matches as a prefix, and
+	// terms with no exact hit fall back to tokens within a small edit distance
+	EntrySet search(const juce::String &text) const;
+
+	static juce::StringArray tokenise(const juce::String &text);
+
+private:
+	static constexpr int minFuzzyLength = 4;
+	static constexpr int maxFuzzyLength = 32;
+
+	std::map<juce::String, EntrySet> postings;
+
+	void collectMatches(const juce::String &term, bool asPrefix, EntrySet &matches) const;
+	static bool withinEditDistance(const juce::String &token, const juce::String &term, bool asPrefix, int maxDistance);
+};
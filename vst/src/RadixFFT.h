@@ -0,0 +1,57 @@
+#pragma once
+#include "JuceHeader.h"
+#include <complex>
+#include <vector>
+
+// In-place radix-2 complex FFT with a matching Hann window
+class RadixFFT
+{
+public:
+	explicit RadixFFT(int order) : size(1 << order), window((size_t)size), twiddles((size_t)size / 2), bitReversed((size_t)size)
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			window[(size_t)i] = 0.5f - 0.5f * std::cos(juce::MathConstants<float>::twoPi * i / (float)(size - 1));
+			int reversed = 0;
+			for (int bit = 0; bit < order; ++bit)
+				reversed |= ((i >> bit) & 1) << (order - 1 - bit);
+			bitReversed[(size_t)i] = reversed;
+		}
+		for (int k = 0; k < size / 2; ++k)
+			twiddles[(size_t)k] = std::polar(1.0f, -juce::MathConstants<float>::twoPi * k / (float)size);
+	}
+
+	int getSize() const { return size; }
+	float windowAt(int index) const { return window[(size_t)index]; }
+
+	void perform(std::complex<float> *data) const
+	{
+		for (int i = 0; i < size; ++i)
+		{
+			const int j = bitReversed[(size_t)i];
+			if (i < j)
+				std::swap(data[i], data[j]);
+		}
+
+		for (int span = 2; span <= size; span <<= 1)
+		{
+			const int half = span >> 1;
+			const int step = size / span;
+			for (int start = 0; start < size; start += span)
+			{
+				for (int k = 0; k < half; ++k)
+				{
+					const std::complex<float> t = data[start + k + half] * twiddles[(size_t)(k * step)];
+					data[start + k + half] = data[start + k] - t;
+					data[start + k] += t;
+				}
+			}
+		}
+	}
+
+private:
+	int size;
+	std::vector<float> window;
+	std::vector<std::complex<float>> twiddles;
+	std::vector<int> bitReversed;
+};
@@ -1,11 +1,31 @@
 #include "SampleBank.h"
 
-SampleBank::SampleBank()
+SampleBank::SampleBank() : juce::Thread("Sample Bank Writer")
 {
 	bankDirectory = getBankDirectory();
 	bankIndexFile = bankDirectory.getChildFile("sample_bank.json");
+	bankJournalFile = bankDirectory.getChildFile("sample_bank.journal");
+	blobDirectory = bankDirectory.getChildFile("blobs");
 	ensureBankDirectoryExists();
 	loadBankData();
+	startThread(juce::Thread::Priority::low);
+	if (compactionRequested)
+		notify();
+}
+
+SampleBank::~SampleBank()
+{
+	signalThreadShouldExit();
+	notify();
+	stopThread(5000);
+
+	bool dirty;
+	{
+		juce::ScopedLock lock(journalLock);
+		dirty = compactionRequested || !pendingRecords.isEmpty() || journalRecordCount > 0;
+	}
+	if (dirty)
+		compactBankData();
 }
 
 juce::String SampleBank::addSample(const juce::String &prompt,
@@ -14,8 +34,81 @@ juce::String SampleBank::addSample(const juce::String &prompt,
 								   const juce::String &key,
 								   const std::vector<juce::String> &stems)
 {
+	return commitSample(prepareSample(audioFile), prompt, bpm, key, stems);
+}
+
+SampleBank::PreparedSample SampleBank::prepareSample(const juce::File &audioFile)
+{
+	PreparedSample prepared;
+
+	juce::AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+	std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
+	if (!reader || reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max())
+	{
+		DBG("Cannot read sample audio: " + audioFile.getFullPathName());
+		return prepared;
+	}
+
+	// Decoded once: the hash, features and peaks all come from this buffer
+	const int numSamples = (int)reader->lengthInSamples;
+	juce::AudioBuffer<float> audio((int)reader->numChannels, numSamples);
+	if (!reader->read(&audio, 0, numSamples, 0, true, true))
+	{
+		DBG("Cannot decode sample audio: " + audioFile.getFullPathName());
+		return prepared;
+	}
+
+	prepared.sampleRate = reader->sampleRate;
+	prepared.numChannels = audio.getNumChannels();
+	prepared.numSamples = numSamples;
+	reader.reset();
+
+	const auto contentHash = computeContentHash(audio, prepared.sampleRate);
+	prepared.features = SampleFeatures::compute(audio, prepared.sampleRate);
+
+	// Blobs are content addressed, so a concurrent prepare of the same audio writes identical bytes
+	const auto destinationFile = blobDirectory.getChildFile(contentHash + audioFile.getFileExtension());
+	if (destinationFile.existsAsFile())
+	{
+		DBG("Sample audio already stored as " + destinationFile.getFileName());
+	}
+	else
+	{
+		juce::TemporaryFile tempFile(destinationFile);
+		if (!audioFile.copyFileTo(tempFile.getFile()) || !tempFile.overwriteTargetFileWithTemporary())
+		{
+			DBG("Failed to copy sample to bank: " + destinationFile.getFullPathName());
+			return prepared;
+		}
+	}
+
+	const auto peakFile = WaveformPeaks::fileFor(destinationFile);
+	if (!peakFile.existsAsFile() && !WaveformPeaks::write(audio, prepared.sampleRate, peakFile))
+		DBG("Failed to write waveform peaks: " + peakFile.getFullPathName());
+
+	prepared.blobFile = destinationFile;
+	return prepared;
+}
+
+juce::String SampleBank::commitSample(const PreparedSample &prepared,
+									  const juce::String &prompt,
+									  float bpm,
+									  const juce::String &key,
+									  const std::vector<juce::String> &stems)
+{
+	if (!prepared.isValid())
+		return {};
+
 	juce::ScopedLock lock(bankLock);
 
+	// removeSample may have deleted an unreferenced blob between prepare and commit
+	if (!prepared.blobFile.existsAsFile())
+	{
+		DBG("Prepared sample blob was removed: " + prepared.blobFile.getFullPathName());
+		return {};
+	}
+
 	auto entry = std::make_unique<SampleBankEntry>();
 	entry->id = juce::Uuid().toString();
 	entry->originalPrompt = prompt;
@@ -23,6 +116,11 @@ juce::String SampleBank::addSample(const juce::String &prompt,
 	entry->bpm = bpm;
 	entry->key = key;
 	entry->stems = stems;
+	entry->features = prepared.features;
+	entry->sampleRate = prepared.sampleRate;
+	entry->numChannels = prepared.numChannels;
+	entry->numSamples = prepared.numSamples;
+	entry->duration = prepared.sampleRate > 0.0 ? (float)(prepared.numSamples / prepared.sampleRate) : 0.0f;
 
 	auto &categories = entry->categories;
 
@@ -58,27 +156,16 @@ juce::String SampleBank::addSample(const juce::String &prompt,
 		categories.push_back("Electronic");
 
 	entry->filename = createSafeFilename(prompt, entry->creationTime);
-
-	juce::File destinationFile = bankDirectory.getChildFile(entry->filename);
-	if (!audioFile.copyFileTo(destinationFile))
-	{
-		DBG("Failed to copy sample to bank: " + destinationFile.getFullPathName());
-		return {};
-	}
-
-	entry->filePath = destinationFile.getFullPathName();
-
-	analyzeSampleFile(entry.get(), destinationFile);
+	entry->filePath = prepared.blobFile.getFullPathName();
 
 	juce::String sampleId = entry->id;
+	indexEntry(entry.get());
+	journalEntry(*entry);
 	samples.push_back(std::move(entry));
 
-	saveBankData();
-
-	if (onBankChanged)
-		onBankChanged();
+	notifyBankChanged();
 
-	DBG("Sample added to bank: " + sampleId + " -> " + destinationFile.getFileName());
+	DBG("Sample added to bank: " + sampleId + " -> " + prepared.blobFile.getFileName());
 	return sampleId;
 }
 
@@ -86,26 +173,21 @@ bool SampleBank::removeSample(const juce::String &sampleId)
 {
 	juce::ScopedLock lock(bankLock);
 
-	auto it = std::find_if(samples.begin(), samples.end(),
-						   [&sampleId](const std::unique_ptr<SampleBankEntry> &entry)
-						   {
-							   return entry->id == sampleId;
-						   });
-
-	if (it == samples.end())
+	auto *entry = getSample(sampleId);
+	if (!entry)
 		return false;
 
-	juce::File sampleFile((*it)->filePath);
-	if (sampleFile.exists())
+	juce::File sampleFile(entry->filePath);
+	eraseEntry(entry);
+	journalRemoval(sampleId);
+
+	if (fileReferences.count(sampleFile.getFullPathName()) == 0 && sampleFile.exists())
 	{
 		sampleFile.deleteFile();
+		WaveformPeaks::fileFor(sampleFile).deleteFile();
 	}
 
-	samples.erase(it);
-	saveBankData();
-
-	if (onBankChanged)
-		onBankChanged();
+	notifyBankChanged();
 
 	return true;
 }
@@ -114,13 +196,8 @@ SampleBankEntry *SampleBank::getSample(const juce::String &sampleId)
 {
 	juce::ScopedLock lock(bankLock);
 
-	auto it = std::find_if(samples.begin(), samples.end(),
-						   [&sampleId](const std::unique_ptr<SampleBankEntry> &entry)
-						   {
-							   return entry->id == sampleId;
-						   });
-
-	return (it != samples.end()) ? it->get() : nullptr;
+	auto it = idIndex.find(sampleId);
+	return (it != idIndex.end()) ? it->second : nullptr;
 }
 
 std::vector<SampleBankEntry *> SampleBank::getAllSamples()
@@ -140,18 +217,247 @@ std::vector<juce::String> SampleBank::getUnusedSamples() const
 	juce::ScopedLock lock(bankLock);
 
 	std::vector<juce::String> unused;
-	for (const auto &entry : samples)
+	for (const auto *entry : unusedEntries)
 	{
-		if (entry->usedInProjects.empty())
+		unused.push_back(entry->id);
+	}
+	return unused;
+}
+
+std::vector<SampleBankEntry *> SampleBank::findSamples(const SampleQuery &query) const
+{
+	juce::ScopedLock lock(bankLock);
+
+	std::vector<SampleBankEntry *> result;
+	if (query.text.isNotEmpty())
+	{
+		for (auto *entry : promptIndex.search(query.text))
 		{
-			unused.push_back(entry->id);
+			if (matchesQuery(entry, query))
+				result.push_back(entry);
 		}
+		return result;
 	}
-	return unused;
+
+	if (query.bpmTolerance >= 0.0f)
+	{
+		auto first = bpmIndex.lower_bound(query.bpm - query.bpmTolerance);
+		auto last = bpmIndex.upper_bound(query.bpm + query.bpmTolerance);
+		for (auto it = first; it != last; ++it)
+		{
+			if (matchesQuery(it->second, query))
+				result.push_back(it->second);
+		}
+		return result;
+	}
+
+	const EntrySet *candidates = nullptr;
+	auto narrowTo = [&candidates](const std::unordered_map<juce::String, EntrySet> &index, const juce::String &value)
+	{
+		static const EntrySet empty;
+		auto it = index.find(value);
+		const EntrySet *bucket = it != index.end() ? &it->second : &empty;
+		if (candidates == nullptr || bucket->size() < candidates->size())
+			candidates = bucket;
+	};
+
+	if (query.category.isNotEmpty())
+		narrowTo(categoryIndex, query.category);
+	if (query.key.isNotEmpty())
+		narrowTo(keyIndex, normaliseKey(query.key));
+	if (query.projectId.isNotEmpty())
+		narrowTo(projectIndex, query.projectId);
+	if (query.unusedOnly && (candidates == nullptr || unusedEntries.size() < candidates->size()))
+		candidates = &unusedEntries;
+
+	if (candidates == nullptr)
+	{
+		for (const auto &entry : samples)
+			result.push_back(entry.get());
+		return result;
+	}
+
+	for (auto *entry : *candidates)
+	{
+		if (matchesQuery(entry, query))
+			result.push_back(entry);
+	}
+	return result;
+}
+
+std::vector<SampleBankEntry *> SampleBank::findSimilar(const juce::String &sampleId, int maxResults)
+{
+	juce::ScopedLock lock(bankLock);
+
+	auto *entry = getSample(sampleId);
+	if (!entry)
+		return {};
+
+	// Entries saved before feature extraction are analysed by the writer thread
+	if ((int)entry->features.size() != SampleFeatures::numFeatures)
+	{
+		notify();
+		return {};
+	}
+
+	return similarityIndex.nearest(entry->features.data(), maxResults, entry);
+}
+
+bool SampleBank::matchesQuery(const SampleBankEntry *entry, const SampleQuery &query)
+{
+	if (query.bpmTolerance >= 0.0f && std::abs(entry->bpm - query.bpm) > query.bpmTolerance)
+		return false;
+	if (query.category.isNotEmpty() &&
+		std::find(entry->categories.begin(), entry->categories.end(), query.category) == entry->categories.end())
+		return false;
+	if (query.key.isNotEmpty() && normaliseKey(entry->key) != normaliseKey(query.key))
+		return false;
+	if (query.projectId.isNotEmpty() &&
+		std::find(entry->usedInProjects.begin(), entry->usedInProjects.end(), query.projectId) == entry->usedInProjects.end())
+		return false;
+	if (query.unusedOnly && !entry->usedInProjects.empty())
+		return false;
+	return true;
+}
+
+void SampleBank::setSampleCategories(const juce::String &sampleId, const std::vector<juce::String> &categories)
+{
+	juce::ScopedLock lock(bankLock);
+
+	auto *entry = getSample(sampleId);
+	if (!entry)
+		return;
+
+	unindexCategories(entry);
+	entry->categories = categories;
+	indexCategories(entry);
+	journalEntry(*entry);
+}
+
+void SampleBank::renameCategory(const juce::String &oldName, const juce::String &newName)
+{
+	juce::ScopedLock lock(bankLock);
+
+	auto it = categoryIndex.find(oldName);
+	if (it == categoryIndex.end() || oldName == newName)
+		return;
+
+	EntrySet affected = std::move(it->second);
+	categoryIndex.erase(it);
+	for (auto *entry : affected)
+	{
+		auto &categories = entry->categories;
+		if (std::find(categories.begin(), categories.end(), newName) != categories.end())
+			categories.erase(std::remove(categories.begin(), categories.end(), oldName), categories.end());
+		else
+			std::replace(categories.begin(), categories.end(), oldName, newName);
+		categoryIndex[newName].insert(entry);
+		journalEntry(*entry);
+	}
+}
+
+void SampleBank::removeCategory(const juce::String &name)
+{
+	juce::ScopedLock lock(bankLock);
+
+	auto it = categoryIndex.find(name);
+	if (it == categoryIndex.end())
+		return;
+
+	for (auto *entry : it->second)
+	{
+		auto &categories = entry->categories;
+		categories.erase(std::remove(categories.begin(), categories.end(), name), categories.end());
+		journalEntry(*entry);
+	}
+	categoryIndex.erase(it);
+}
+
+void SampleBank::indexEntry(SampleBankEntry *entry)
+{
+	idIndex[entry->id] = entry;
+	++fileReferences[entry->filePath];
+	promptIndex.add(entry);
+	similarityIndex.add(entry);
+	if ((int)entry->features.size() != SampleFeatures::numFeatures)
+		unanalysedIds.insert(entry->id);
+	indexCategories(entry);
+	keyIndex[normaliseKey(entry->key)].insert(entry);
+	bpmIndex.emplace(entry->bpm, entry);
+	for (const auto &project : entry->usedInProjects)
+		projectIndex[project].insert(entry);
+	if (entry->usedInProjects.empty())
+		unusedEntries.insert(entry);
+}
+
+void SampleBank::unindexEntry(SampleBankEntry *entry)
+{
+	idIndex.erase(entry->id);
+	auto fileIt = fileReferences.find(entry->filePath);
+	if (fileIt != fileReferences.end() && --fileIt->second <= 0)
+		fileReferences.erase(fileIt);
+	promptIndex.remove(entry);
+	similarityIndex.remove(entry);
+	unanalysedIds.erase(entry->id);
+	unindexCategories(entry);
+
+	auto keyIt = keyIndex.find(normaliseKey(entry->key));
+	if (keyIt != keyIndex.end())
+	{
+		keyIt->second.erase(entry);
+		if (keyIt->second.empty())
+			keyIndex.erase(keyIt);
+	}
+
+	auto [first, last] = bpmIndex.equal_range(entry->bpm);
+	for (auto it = first; it != last; ++it)
+	{
+		if (it->second == entry)
+		{
+			bpmIndex.erase(it);
+			break;
+		}
+	}
+
+	for (const auto &project : entry->usedInProjects)
+	{
+		auto projectIt = projectIndex.find(project);
+		if (projectIt == projectIndex.end())
+			continue;
+		projectIt->second.erase(entry);
+		if (projectIt->second.empty())
+			projectIndex.erase(projectIt);
+	}
+	unusedEntries.erase(entry);
+}
+
+void SampleBank::indexCategories(SampleBankEntry *entry)
+{
+	for (const auto &category : entry->categories)
+		categoryIndex[category].insert(entry);
+}
+
+void SampleBank::unindexCategories(SampleBankEntry *entry)
+{
+	for (const auto &category : entry->categories)
+	{
+		auto it = categoryIndex.find(category);
+		if (it == categoryIndex.end())
+			continue;
+		it->second.erase(entry);
+		if (it->second.empty())
+			categoryIndex.erase(it);
+	}
+}
+
+juce::String SampleBank::normaliseKey(const juce::String &key)
+{
+	return key.trim().toLowerCase();
 }
 
 int SampleBank::removeUnusedSamples()
 {
+	ScopedBatch batch(*this);
 	auto unusedIds = getUnusedSamples();
 	int removedCount = 0;
 
@@ -175,7 +481,9 @@ void SampleBank::markSampleAsUsed(const juce::String &sampleId, const juce::Stri
 		if (std::find(projects.begin(), projects.end(), projectId) == projects.end())
 		{
 			projects.push_back(projectId);
-			saveBankData();
+			projectIndex[projectId].insert(entry);
+			unusedEntries.erase(entry);
+			journalEntry(*entry);
 		}
 	}
 }
@@ -189,7 +497,17 @@ void SampleBank::markSampleAsUnused(const juce::String &sampleId, const juce::St
 	{
 		auto &projects = entry->usedInProjects;
 		projects.erase(std::remove(projects.begin(), projects.end(), projectId), projects.end());
-		saveBankData();
+
+		auto projectIt = projectIndex.find(projectId);
+		if (projectIt != projectIndex.end())
+		{
+			projectIt->second.erase(entry);
+			if (projectIt->second.empty())
+				projectIndex.erase(projectIt);
+		}
+		if (projects.empty())
+			unusedEntries.insert(entry);
+		journalEntry(*entry);
 	}
 }
 
@@ -228,19 +546,23 @@ juce::String SampleBank::promptToSnakeCase(const juce::String &prompt)
 	return result.isEmpty() ? "sample" : result;
 }
 
-void SampleBank::analyzeSampleFile(SampleBankEntry *entry, const juce::File &audioFile)
+juce::String SampleBank::computeContentHash(const juce::AudioBuffer<float> &audio, double sampleRate)
 {
-	juce::AudioFormatManager formatManager;
-	formatManager.registerBasicFormats();
-
-	std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
-	if (reader)
+	// Hashes the decoded PCM, so files differing only in header metadata still share one blob
+	juce::MemoryBlock hashInput;
+	const int numChannels = audio.getNumChannels();
+	const int numSamples = audio.getNumSamples();
+	hashInput.append(&numChannels, sizeof(numChannels));
+	hashInput.append(&numSamples, sizeof(numSamples));
+	hashInput.append(&sampleRate, sizeof(sampleRate));
+
+	for (int ch = 0; ch < numChannels; ++ch)
 	{
-		entry->duration = static_cast<float>(reader->lengthInSamples / reader->sampleRate);
-		entry->sampleRate = reader->sampleRate;
-		entry->numChannels = reader->numChannels;
-		entry->numSamples = static_cast<int>(reader->lengthInSamples);
+		juce::SHA256 channelHash(audio.getReadPointer(ch), (size_t)numSamples * sizeof(float));
+		hashInput.append(channelHash.getRawData().getData(), channelHash.getRawData().getSize());
 	}
+
+	return juce::SHA256(hashInput).toHexString();
 }
 
 juce::File SampleBank::getBankDirectory()
@@ -256,127 +578,402 @@ void SampleBank::ensureBankDirectoryExists()
 	{
 		bankDirectory.createDirectory();
 	}
+	if (!blobDirectory.exists())
+	{
+		blobDirectory.createDirectory();
+	}
 }
 
-void SampleBank::saveBankData()
+void SampleBank::beginBatch()
 {
-	juce::DynamicObject::Ptr bankData = new juce::DynamicObject();
-	juce::Array<juce::var> samplesArray;
+	bankLock.enter();
+	++batchDepth;
+}
 
-	for (const auto &entry : samples)
-	{
-		juce::DynamicObject::Ptr sampleData = new juce::DynamicObject();
-		sampleData->setProperty("id", entry->id);
-		sampleData->setProperty("filename", entry->filename);
-		sampleData->setProperty("originalPrompt", entry->originalPrompt);
-		sampleData->setProperty("filePath", entry->filePath);
-		sampleData->setProperty("creationTime", entry->creationTime.toMilliseconds());
-		sampleData->setProperty("duration", entry->duration);
-		sampleData->setProperty("bpm", entry->bpm);
-		sampleData->setProperty("key", entry->key);
-		sampleData->setProperty("sampleRate", entry->sampleRate);
-		sampleData->setProperty("numChannels", entry->numChannels);
-		sampleData->setProperty("numSamples", entry->numSamples);
-		juce::Array<juce::var> categoriesArray;
-		for (const auto &category : entry->categories)
-			categoriesArray.add(category);
-		sampleData->setProperty("categories", categoriesArray);
-
-		juce::Array<juce::var> stemsArray;
-		for (const auto &stem : entry->stems)
-			stemsArray.add(stem);
-		sampleData->setProperty("stems", stemsArray);
-
-		juce::Array<juce::var> projectsArray;
-		for (const auto &project : entry->usedInProjects)
-			projectsArray.add(project);
-		sampleData->setProperty("usedInProjects", projectsArray);
-
-		samplesArray.add(sampleData.get());
+void SampleBank::endBatch()
+{
+	bool changed = false;
+	if (--batchDepth == 0)
+	{
+		if (!batchRecords.isEmpty())
+		{
+			juce::ScopedLock lock(journalLock);
+			if (batchRecords.size() >= journalCompactionThreshold)
+				compactionRequested = true;
+			else
+				pendingRecords.addArray(batchRecords);
+			batchRecords.clearQuick();
+			notify();
+		}
+		changed = std::exchange(batchChanged, false);
 	}
+	bankLock.exit();
 
-	bankData->setProperty("samples", samplesArray);
-	bankData->setProperty("version", "1.0");
+	if (changed && onBankChanged)
+		onBankChanged();
+}
 
-	juce::String jsonString = juce::JSON::toString(juce::var(bankData.get()));
-	bankIndexFile.replaceWithText(jsonString);
+void SampleBank::notifyBankChanged()
+{
+	if (batchDepth > 0)
+		batchChanged = true;
+	else if (onBankChanged)
+		onBankChanged();
+}
+
+void SampleBank::saveBankData()
+{
+	{
+		juce::ScopedLock lock(journalLock);
+		compactionRequested = true;
+	}
+	notify();
 }
 
 void SampleBank::loadBankData()
 {
 	juce::ScopedLock lock(bankLock);
-	if (!bankIndexFile.exists())
-		return;
+	samples.clear();
+	idIndex.clear();
+	categoryIndex.clear();
+	keyIndex.clear();
+	projectIndex.clear();
+	bpmIndex.clear();
+	unusedEntries.clear();
+	promptIndex.clear();
+	similarityIndex.clear();
+	fileReferences.clear();
+	unanalysedIds.clear();
+
+	if (bankIndexFile.exists())
+	{
+		juce::var bankJson = juce::JSON::parse(bankIndexFile);
+		auto samplesVar = bankJson.getProperty("samples", {});
+		if (auto *samplesArray = samplesVar.getArray())
+		{
+			for (const auto &sampleVar : *samplesArray)
+			{
+				if (auto entry = entryFromVar(sampleVar))
+					restoreEntry(std::move(entry));
+			}
+		}
+	}
 
-	juce::var bankJson = juce::JSON::parse(bankIndexFile);
-	if (!bankJson.isObject())
-		return;
+	replayJournal();
 
-	auto *bankObj = bankJson.getDynamicObject();
-	if (!bankObj)
-		return;
+	DBG("Loaded " + juce::String(samples.size()) + " samples from bank");
+}
 
-	auto samplesVar = bankObj->getProperty("samples");
-	if (!samplesVar.isArray())
+void SampleBank::replayJournal()
+{
+	journalRecordCount = 0;
+	if (!bankJournalFile.existsAsFile())
 		return;
 
-	auto *samplesArray = samplesVar.getArray();
-	samples.clear();
-
-	for (int i = 0; i < samplesArray->size(); ++i)
+	juce::StringArray lines;
+	bankJournalFile.readLines(lines);
+	for (const auto &line : lines)
 	{
-		auto sampleVar = samplesArray->getUnchecked(i);
-		if (!sampleVar.isObject())
+		if (line.isEmpty())
 			continue;
 
-		auto *sampleObj = sampleVar.getDynamicObject();
-		if (!sampleObj)
+		// A crash mid-append leaves at most one torn record at the end
+		juce::var record = juce::JSON::parse(line);
+		if (!record.isObject())
+		{
+			DBG("Skipping unreadable sample bank journal record");
 			continue;
+		}
 
-		auto entry = std::make_unique<SampleBankEntry>();
-		entry->id = sampleObj->getProperty("id").toString();
-		entry->filename = sampleObj->getProperty("filename").toString();
-		entry->originalPrompt = sampleObj->getProperty("originalPrompt").toString();
-		entry->filePath = sampleObj->getProperty("filePath").toString();
-		auto creationTimeVar = sampleObj->getProperty("creationTime");
-		entry->creationTime = juce::Time(creationTimeVar.isVoid() ? 0 : (juce::int64)creationTimeVar);
-		entry->duration = static_cast<float>(sampleObj->getProperty("duration"));
-		entry->bpm = static_cast<float>(sampleObj->getProperty("bpm"));
-		entry->key = sampleObj->getProperty("key").toString();
-		entry->sampleRate = sampleObj->getProperty("sampleRate");
-		entry->numChannels = sampleObj->getProperty("numChannels");
-		entry->numSamples = sampleObj->getProperty("numSamples");
-
-		auto categoriesVar = sampleObj->getProperty("categories");
-		if (categoriesVar.isArray())
+		const auto op = record["op"].toString();
+		if (op == "put")
 		{
-			auto *categoriesArray = categoriesVar.getArray();
-			for (int j = 0; j < categoriesArray->size(); ++j)
-				entry->categories.push_back(categoriesArray->getUnchecked(j).toString());
+			if (auto entry = entryFromVar(record["sample"]))
+				restoreEntry(std::move(entry));
 		}
-
-		auto stemsVar = sampleObj->getProperty("stems");
-		if (stemsVar.isArray())
+		else if (op == "remove")
 		{
-			auto *stemsArray = stemsVar.getArray();
-			for (int j = 0; j < stemsArray->size(); ++j)
-				entry->stems.push_back(stemsArray->getUnchecked(j).toString());
+			if (auto *entry = getSample(record["id"].toString()))
+				eraseEntry(entry);
 		}
+		++journalRecordCount;
+	}
+
+	if (journalRecordCount > 0)
+		compactionRequested = true;
+}
 
-		auto projectsVar = sampleObj->getProperty("usedInProjects");
-		if (projectsVar.isArray())
+void SampleBank::restoreEntry(std::unique_ptr<SampleBankEntry> entry)
+{
+	auto *existing = getSample(entry->id);
+	if (!juce::File(entry->filePath).exists())
+	{
+		if (existing)
+			eraseEntry(existing);
+		return;
+	}
+
+	if (existing)
+	{
+		unindexEntry(existing);
+		*existing = std::move(*entry);
+		indexEntry(existing);
+		return;
+	}
+
+	indexEntry(entry.get());
+	samples.push_back(std::move(entry));
+}
+
+void SampleBank::eraseEntry(SampleBankEntry *entry)
+{
+	unindexEntry(entry);
+	samples.erase(std::find_if(samples.begin(), samples.end(),
+							   [entry](const std::unique_ptr<SampleBankEntry> &candidate)
+							   {
+								   return candidate.get() == entry;
+							   }));
+}
+
+void SampleBank::journalEntry(const SampleBankEntry &entry)
+{
+	juce::DynamicObject::Ptr record = new juce::DynamicObject();
+	record->setProperty("op", "put");
+	record->setProperty("sample", entryToVar(entry));
+	queueJournalRecord(juce::var(record.get()));
+}
+
+void SampleBank::journalRemoval(const juce::String &sampleId)
+{
+	juce::DynamicObject::Ptr record = new juce::DynamicObject();
+	record->setProperty("op", "remove");
+	record->setProperty("id", sampleId);
+	queueJournalRecord(juce::var(record.get()));
+}
+
+void SampleBank::queueJournalRecord(const juce::var &record)
+{
+	const auto line = juce::JSON::toString(record, true);
+	if (batchDepth > 0)
+	{
+		batchRecords.add(line);
+		return;
+	}
+
+	{
+		juce::ScopedLock lock(journalLock);
+		pendingRecords.add(line);
+	}
+	notify();
+}
+
+void SampleBank::run()
+{
+	while (!threadShouldExit())
+	{
+		wait(1000);
+		writePendingRecords();
+		backfillFeatures();
+	}
+}
+
+void SampleBank::backfillFeatures()
+{
+	while (!threadShouldExit())
+	{
+		juce::String sampleId;
+		juce::File audioFile;
 		{
-			auto *projectsArray = projectsVar.getArray();
-			for (int j = 0; j < projectsArray->size(); ++j)
-				entry->usedInProjects.push_back(projectsArray->getUnchecked(j).toString());
+			juce::ScopedLock lock(bankLock);
+			if (unanalysedIds.empty())
+				return;
+
+			sampleId = *unanalysedIds.begin();
+			unanalysedIds.erase(unanalysedIds.begin());
+			if (auto *entry = getSample(sampleId))
+				audioFile = juce::File(entry->filePath);
 		}
 
-		juce::File sampleFile(entry->filePath);
-		if (sampleFile.exists())
+		if (audioFile == juce::File())
+			continue;
+
+		auto features = SampleFeatures::compute(audioFile);
+		if (features.empty())
 		{
-			samples.push_back(std::move(entry));
+			DBG("Cannot analyse sample for similarity: " + audioFile.getFullPathName());
+			continue;
 		}
+
+		juce::ScopedLock lock(bankLock);
+		auto *entry = getSample(sampleId);
+		if (!entry || juce::File(entry->filePath) != audioFile || (int)entry->features.size() == SampleFeatures::numFeatures)
+			continue;
+
+		entry->features = std::move(features);
+		similarityIndex.add(entry);
+		journalEntry(*entry);
 	}
+}
 
-	DBG("Loaded " + juce::String(samples.size()) + " samples from bank");
-}
\ No newline at end of file
+void SampleBank::writePendingRecords()
+{
+	juce::StringArray records;
+	bool compact;
+	{
+		juce::ScopedLock lock(journalLock);
+		records.swapWith(pendingRecords);
+		compact = compactionRequested;
+	}
+
+	if (!records.isEmpty() && !appendToJournal(records))
+	{
+		juce::ScopedLock lock(journalLock);
+		records.addArray(pendingRecords);
+		pendingRecords.swapWith(records);
+		compact = true;
+	}
+
+	if (compact || journalRecordCount >= journalCompactionThreshold)
+		compactBankData();
+}
+
+bool SampleBank::appendToJournal(const juce::StringArray &records)
+{
+	juce::FileOutputStream stream(bankJournalFile);
+	if (!stream.openedOk())
+	{
+		DBG("Cannot open sample bank journal: " + bankJournalFile.getFullPathName());
+		return false;
+	}
+
+	for (const auto &record : records)
+		stream << record << "\n";
+	stream.flush();
+	if (stream.getStatus().failed())
+		return false;
+
+	journalRecordCount += records.size();
+	return true;
+}
+
+void SampleBank::compactBankData()
+{
+	juce::Array<juce::var> samplesArray;
+	{
+		// Queued records describe changes the snapshot already contains
+		juce::ScopedLock lock(bankLock);
+		for (const auto &entry : samples)
+			samplesArray.add(entryToVar(*entry));
+
+		juce::ScopedLock journal(journalLock);
+		pendingRecords.clear();
+		compactionRequested = false;
+	}
+
+	juce::DynamicObject::Ptr bankData = new juce::DynamicObject();
+	bankData->setProperty("samples", samplesArray);
+	bankData->setProperty("version", "1.0");
+
+	juce::TemporaryFile tempFile(bankIndexFile);
+	if (!tempFile.getFile().replaceWithText(juce::JSON::toString(juce::var(bankData.get()))) ||
+		!tempFile.overwriteTargetFileWithTemporary())
+	{
+		DBG("Failed to compact sample bank index: " + bankIndexFile.getFullPathName());
+		juce::ScopedLock lock(journalLock);
+		compactionRequested = true;
+		return;
+	}
+
+	bankJournalFile.deleteFile();
+	journalRecordCount = 0;
+}
+
+juce::var SampleBank::entryToVar(const SampleBankEntry &entry)
+{
+	juce::DynamicObject::Ptr sampleData = new juce::DynamicObject();
+	sampleData->setProperty("id", entry.id);
+	sampleData->setProperty("filename", entry.filename);
+	sampleData->setProperty("originalPrompt", entry.originalPrompt);
+	sampleData->setProperty("filePath", entry.filePath);
+	sampleData->setProperty("creationTime", entry.creationTime.toMilliseconds());
+	sampleData->setProperty("duration", entry.duration);
+	sampleData->setProperty("bpm", entry.bpm);
+	sampleData->setProperty("key", entry.key);
+	sampleData->setProperty("sampleRate", entry.sampleRate);
+	sampleData->setProperty("numChannels", entry.numChannels);
+	sampleData->setProperty("numSamples", entry.numSamples);
+	juce::Array<juce::var> categoriesArray;
+	for (const auto &category : entry.categories)
+		categoriesArray.add(category);
+	sampleData->setProperty("categories", categoriesArray);
+
+	juce::Array<juce::var> stemsArray;
+	for (const auto &stem : entry.stems)
+		stemsArray.add(stem);
+	sampleData->setProperty("stems", stemsArray);
+
+	juce::Array<juce::var> projectsArray;
+	for (const auto &project : entry.usedInProjects)
+		projectsArray.add(project);
+	sampleData->setProperty("usedInProjects", projectsArray);
+
+	if (!entry.features.empty())
+		sampleData->setProperty("features", juce::MemoryBlock(entry.features.data(), entry.features.size() * sizeof(float)).toBase64Encoding());
+
+	return juce::var(sampleData.get());
+}
+
+std::unique_ptr<SampleBankEntry> SampleBank::entryFromVar(const juce::var &sampleVar)
+{
+	auto *sampleObj = sampleVar.getDynamicObject();
+	if (!sampleObj)
+		return nullptr;
+
+	auto entry = std::make_unique<SampleBankEntry>();
+	entry->id = sampleObj->getProperty("id").toString();
+	entry->filename = sampleObj->getProperty("filename").toString();
+	entry->originalPrompt = sampleObj->getProperty("originalPrompt").toString();
+	entry->filePath = sampleObj->getProperty("filePath").toString();
+	auto creationTimeVar = sampleObj->getProperty("creationTime");
+	entry->creationTime = juce::Time(creationTimeVar.isVoid() ? 0 : (juce::int64)creationTimeVar);
+	entry->duration = static_cast<float>(sampleObj->getProperty("duration"));
+	entry->bpm = static_cast<float>(sampleObj->getProperty("bpm"));
+	entry->key = sampleObj->getProperty("key").toString();
+	entry->sampleRate = sampleObj->getProperty("sampleRate");
+	entry->numChannels = sampleObj->getProperty("numChannels");
+	entry->numSamples = sampleObj->getProperty("numSamples");
+
+	auto categoriesVar = sampleObj->getProperty("categories");
+	if (categoriesVar.isArray())
+	{
+		auto *categoriesArray = categoriesVar.getArray();
+		for (int j = 0; j < categoriesArray->size(); ++j)
+			entry->categories.push_back(categoriesArray->getUnchecked(j).toString());
+	}
+
+	auto stemsVar = sampleObj->getProperty("stems");
+	if (stemsVar.isArray())
+	{
+		auto *stemsArray = stemsVar.getArray();
+		for (int j = 0; j < stemsArray->size(); ++j)
+			entry->stems.push_back(stemsArray->getUnchecked(j).toString());
+	}
+
+	auto projectsVar = sampleObj->getProperty("usedInProjects");
+	if (projectsVar.isArray())
+	{
+		auto *projectsArray = projectsVar.getArray();
+		for (int j = 0; j < projectsArray->size(); ++j)
+			entry->usedInProjects.push_back(projectsArray->getUnchecked(j).toString());
+	}
+
+	juce::MemoryBlock features;
+	if (features.fromBase64Encoding(sampleObj->getProperty("features").toString()) &&
+		features.getSize() == SampleFeatures::numFeatures * sizeof(float))
+	{
+		const auto *values = static_cast<const float *>(features.getData());
+		entry->features.assign(values, values + SampleFeatures::numFeatures);
+	}
+
+	return entry;
+}
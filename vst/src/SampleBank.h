@@ -1,7 +1,13 @@
 #pragma once
 #include "JuceHeader.h"
+#include "PromptIndex.h"
+#include "SampleFeatures.h"
+#include "WaveformPeaks.h"
 #include <vector>
 #include <memory>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
 
 struct SampleBankEntry
 {
@@ -17,6 +23,7 @@ struct SampleBankEntry
 	std::vector<juce::String> usedInProjects;
 
 	std::vector<juce::String> categories;
+	std::vector<float> features;
 
 	double sampleRate;
 	int numChannels;
@@ -28,11 +35,53 @@ struct SampleBankEntry
 	}
 };
 
-class SampleBank
+struct SampleQuery
+{
+	juce::String text;
+	juce::String category;
+	juce::String key;
+	juce::String projectId;
+	float bpm = 0.0f;
+	float bpmTolerance = -1.0f;
+	bool unusedOnly = false;
+};
+
+class SampleBank : private juce::Thread
 {
 public:
+	class ScopedBatch
+	{
+	public:
+		explicit ScopedBatch(SampleBank &bankToBatch) : bank(bankToBatch) { bank.beginBatch(); }
+		~ScopedBatch() { bank.endBatch(); }
+
+	private:
+		SampleBank &bank;
+		JUCE_DECLARE_NON_COPYABLE(ScopedBatch)
+	};
+
+	struct PreparedSample
+	{
+		juce::File blobFile;
+		std::vector<float> features;
+		double sampleRate = 0.0;
+		int numChannels = 0;
+		int numSamples = 0;
+
+		bool isValid() const { return blobFile != juce::File(); }
+	};
+
 	SampleBank();
-	~SampleBank() = default;
+	~SampleBank() override;
+
+	// Hashes, analyses and stores the audio in the blob directory without taking the bank lock
+	PreparedSample prepareSample(const juce::File &audioFile);
+
+	juce::String commitSample(const PreparedSample &prepared,
+							  const juce::String &prompt,
+							  float bpm = 126.0f,
+							  const juce::String &key = "",
+							  const std::vector<juce::String> &stems = {});
 
 	juce::String addSample(const juce::String &prompt,
 						   const juce::File &audioFile,
@@ -43,26 +92,82 @@ public:
 	bool removeSample(const juce::String &sampleId);
 	SampleBankEntry *getSample(const juce::String &sampleId);
 	std::vector<SampleBankEntry *> getAllSamples();
+	std::vector<SampleBankEntry *> findSamples(const SampleQuery &query) const;
+	std::vector<SampleBankEntry *> findSimilar(const juce::String &sampleId, int maxResults);
+
+	void setSampleCategories(const juce::String &sampleId, const std::vector<juce::String> &categories);
+	void renameCategory(const juce::String &oldName, const juce::String &newName);
+	void removeCategory(const juce::String &name);
 
 	std::vector<juce::String> getUnusedSamples() const;
 	int removeUnusedSamples();
 	void markSampleAsUsed(const juce::String &sampleId, const juce::String &projectId);
 	void markSampleAsUnused(const juce::String &sampleId, const juce::String &projectId);
 
+	void beginBatch();
+	void endBatch();
+
 	void saveBankData();
 	void loadBankData();
 
 	std::function<void()> onBankChanged;
 
 private:
+	static constexpr int journalCompactionThreshold = 500;
+
 	std::vector<std::unique_ptr<SampleBankEntry>> samples;
 	juce::File bankDirectory;
 	juce::File bankIndexFile;
+	juce::File bankJournalFile;
+	juce::File blobDirectory;
 	juce::CriticalSection bankLock;
 
+	juce::CriticalSection journalLock;
+	juce::StringArray pendingRecords;
+	bool compactionRequested = false;
+	int journalRecordCount = 0;
+
+	int batchDepth = 0;
+	bool batchChanged = false;
+	juce::StringArray batchRecords;
+
+	using EntrySet = std::unordered_set<SampleBankEntry *>;
+	std::unordered_map<juce::String, SampleBankEntry *> idIndex;
+	std::unordered_map<juce::String, EntrySet> categoryIndex;
+	std::unordered_map<juce::String, EntrySet> keyIndex;
+	std::unordered_map<juce::String, EntrySet> projectIndex;
+	std::multimap<float, SampleBankEntry *> bpmIndex;
+	EntrySet unusedEntries;
+	PromptIndex promptIndex;
+	SimilarityIndex similarityIndex;
+	std::unordered_map<juce::String, int> fileReferences;
+	std::unordered_set<juce::String> unanalysedIds;
+
+	void indexEntry(SampleBankEntry *entry);
+	void unindexEntry(SampleBankEntry *entry);
+	void indexCategories(SampleBankEntry *entry);
+	void unindexCategories(SampleBankEntry *entry);
+	static juce::String normaliseKey(const juce::String &key);
+	static bool matchesQuery(const SampleBankEntry *entry, const SampleQuery &query);
+
+	void notifyBankChanged();
+	void run() override;
+	void backfillFeatures();
+	void journalEntry(const SampleBankEntry &entry);
+	void journalRemoval(const juce::String &sampleId);
+	void queueJournalRecord(const juce::var &record);
+	void writePendingRecords();
+	bool appendToJournal(const juce::StringArray &records);
+	void compactBankData();
+	void replayJournal();
+	void restoreEntry(std::unique_ptr<SampleBankEntry> entry);
+	void eraseEntry(SampleBankEntry *entry);
+	static juce::var entryToVar(const SampleBankEntry &entry);
+	static std::unique_ptr<SampleBankEntry> entryFromVar(const juce::var &sampleVar);
+
 	juce::String createSafeFilename(const juce::String &prompt, const juce::Time &timestamp);
 	juce::String promptToSnakeCase(const juce::String &prompt);
-	void analyzeSampleFile(SampleBankEntry *entry, const juce::File &audioFile);
+	static juce::String computeContentHash(const juce::AudioBuffer<float> &audio, double sampleRate);
 	juce::File getBankDirectory();
 	void ensureBankDirectoryExists();
 
@@ -65,13 +65,18 @@ SampleBankItem::~SampleBankItem()
 }
 
 int SampleBankItem::getRequiredHeight()
+{
+	return getRequiredHeightFor(sampleEntry);
+}
+
+int SampleBankItem::getRequiredHeightFor(const SampleBankEntry *entry)
 {
 	const int labelsHeight = 16 + 16 + 4;
 	const int waveformHeight = 30;
 	const int margins = 16;
 	const int baseHeight = labelsHeight + waveformHeight + margins;
 
-	if (sampleEntry && !sampleEntry->categories.empty())
+	if (entry && !entry->categories.empty())
 	{
 		return baseHeight + 25;
 	}
@@ -79,9 +84,32 @@ int SampleBankItem::getRequiredHeight()
 	return baseHeight;
 }
 
+void SampleBankItem::setSampleEntry(SampleBankEntry *entry)
+{
+	sampleEntry = entry;
+
+	const auto entryId = entry != nullptr ? entry->id : juce::String();
+	if (entryId != boundSampleId)
+	{
+		// Loads still running for the previous entry see a dead flag and drop their result
+		validityFlag->store(false);
+		validityFlag = std::make_shared<std::atomic<bool>>(true);
+		boundSampleId = entryId;
+		peakValues.clear();
+		thumbnail.clear();
+		isSelected = false;
+		isDragging = false;
+		setIsPlaying(false);
+	}
+
+	updateLabels();
+	resized();
+	repaint();
+}
+
 void SampleBankItem::loadAudioDataIfNeeded()
 {
-	if (audioBuffer.getNumSamples() == 0)
+	if (peakValues.empty())
 	{
 		loadAudioData();
 		if (!waveformBounds.isEmpty())
@@ -354,42 +382,28 @@ void SampleBankItem::loadAudioData()
 						 {
 			if (!validity->load()) return;
 
-			juce::AudioFormatManager formatManager;
-			formatManager.registerBasicFormats();
-
-			auto reader = std::unique_ptr<juce::AudioFormatReader>(
-				formatManager.createReaderFor(audioFile));
+			// Samples banked before peak files existed get theirs on first display
+			const auto peakFile = WaveformPeaks::fileFor(audioFile);
+			if (!peakFile.existsAsFile() && !WaveformPeaks::write(audioFile, peakFile))
+				return;
 
-			if (reader && validity->load())
+			auto values = std::make_shared<std::vector<float>>(WaveformPeaks::read(peakFile, maxThumbnailPoints));
+			if (!values->empty() && validity->load())
 			{
-				const int downsampleRatio = std::max(1, (int)(reader->lengthInSamples / 4096));
-				const int numSamples = (int)(reader->lengthInSamples / downsampleRatio);
-
-				auto tempBuffer = std::make_shared<juce::AudioBuffer<float>>(reader->numChannels, numSamples);
-
-				for (int i = 0; i < numSamples; ++i)
-				{
-					if (!validity->load()) return;
-					reader->read(tempBuffer.get(), i, 1, i * downsampleRatio, true, true);
-				}
-
-				if (validity->load())
-				{
-					juce::MessageManager::callAsync([this, tempBuffer, currentSampleRate, validity]()
+				juce::MessageManager::callAsync([this, values, currentSampleRate, validity]()
+					{
+						if (validity->load() && !isDestroyed.load() && sampleEntry)
 						{
-							if (validity->load() && !isDestroyed.load() && sampleEntry)
-							{
-								audioBuffer = *tempBuffer;
-								sampleRate = currentSampleRate;
+							peakValues = std::move(*values);
+							sampleRate = currentSampleRate;
 
-								if (!waveformBounds.isEmpty())
-								{
-									generateThumbnail();
-									repaint();
-								}
+							if (!waveformBounds.isEmpty())
+							{
+								generateThumbnail();
+								repaint();
 							}
-						});
-				}
+						}
+					});
 			} });
 }
 
@@ -479,42 +493,25 @@ void SampleBankItem::generateThumbnail()
 {
 	thumbnail.clear();
 
-	if (audioBuffer.getNumSamples() == 0)
+	if (peakValues.empty())
 		return;
 
 	int targetPoints = waveformBounds.getWidth();
 	if (targetPoints <= 0)
 		targetPoints = 100;
 
-	int samplesPerPoint = juce::jmax(1, audioBuffer.getNumSamples() / targetPoints);
+	const double peaksPerPoint = (double)peakValues.size() / targetPoints;
 
 	for (int point = 0; point < targetPoints; ++point)
 	{
-		int sampleStart = point * samplesPerPoint;
-		int sampleEnd = std::min(sampleStart + samplesPerPoint, audioBuffer.getNumSamples());
+		const auto peakStart = (size_t)(point * peaksPerPoint);
+		const auto peakEnd = std::min(peakValues.size(), std::max(peakStart + 1, (size_t)((point + 1) * peaksPerPoint)));
 
-		if (sampleStart >= audioBuffer.getNumSamples())
+		if (peakStart >= peakValues.size())
 			break;
 
-		float rmsSum = 0.0f;
-		float peak = 0.0f;
-		int count = 0;
-
-		for (int sample = sampleStart; sample < sampleEnd; ++sample)
-		{
-			for (int ch = 0; ch < audioBuffer.getNumChannels(); ++ch)
-			{
-				float val = audioBuffer.getSample(ch, sample);
-				rmsSum += val * val;
-				peak = std::max(peak, std::abs(val));
-				count++;
-			}
-		}
-
-		float rms = count > 0 ? std::sqrt(rmsSum / count) : 0.0f;
-		float finalValue = (rms * 0.7f) + (peak * 0.3f);
-
-		thumbnail.push_back(finalValue);
+		thumbnail.push_back(*std::max_element(peakValues.begin() + (std::ptrdiff_t)peakStart,
+											  peakValues.begin() + (std::ptrdiff_t)peakEnd));
 	}
 }
 
@@ -551,7 +548,19 @@ void SampleBankItem::mouseDown(const juce::MouseEvent &event)
 	}
 	else if (event.mods.isRightButtonDown())
 	{
-		showCategoryMenu();
+		juce::PopupMenu menu;
+		menu.addItem(1, "Edit Categories...");
+		menu.addItem(2, "Find Similar", onFindSimilarRequested != nullptr);
+
+		juce::Component::SafePointer<SampleBankItem> safeThis(this);
+		menu.showMenuAsync(juce::PopupMenu::Options(), [safeThis](int result)
+						   {
+				if (safeThis == nullptr || safeThis->sampleEntry == nullptr)
+					return;
+				if (result == 1)
+					safeThis->showCategoryMenu();
+				else if (result == 2 && safeThis->onFindSimilarRequested)
+					safeThis->onFindSimilarRequested(safeThis->sampleEntry->id); });
 	}
 }
 
@@ -590,7 +599,7 @@ void SampleBankItem::showCategoryMenu()
 		if (!sample)
 			return;
 
-		sample->categories = newCategories;
+		bank->setSampleCategories(sampleId, newCategories);
 
 		if (onCategoriesChanged)
 			onCategoriesChanged(sample, newCategories);
@@ -718,6 +727,7 @@ SampleBankPanel::SampleBankPanel(DjIaVstProcessor &processor)
 SampleBankPanel::~SampleBankPanel()
 {
 	stopPreview();
+	samplesViewport.getVerticalScrollBar().removeListener(this);
 	if (auto *bank = audioProcessor.getSampleBank())
 	{
 		bank->onBankChanged = nullptr;
@@ -745,12 +755,12 @@ void SampleBankPanel::playPreview(SampleBankEntry *entry)
 
 	currentPreviewEntry = entry;
 
-	for (auto &item : sampleItems)
+	for (auto &row : activeRows)
 	{
-		if (item->getSampleEntry() == entry)
+		if (row.second->getSampleEntry() == entry)
 		{
-			item->setIsPlaying(true);
-			currentPreviewItem = item.get();
+			row.second->setIsPlaying(true);
+			currentPreviewItem = row.second;
 			break;
 		}
 	}
@@ -818,58 +828,45 @@ void SampleBankPanel::resized()
 	editCategoryButton.setBounds(buttonArea.removeFromLeft(60).reduced(5));
 	buttonArea.removeFromLeft(5);
 	deleteCategoryButton.setBounds(buttonArea.removeFromLeft(60).reduced(5));
+	buttonArea.removeFromLeft(10);
+	searchInput.setBounds(buttonArea.reduced(0, 3));
 
 	area.removeFromTop(5);
 	samplesViewport.setBounds(area);
 
-	int totalHeight = 5;
-	for (auto &item : sampleItems)
-	{
-		totalHeight += item->getRequiredHeight() + 5;
-	}
-	samplesContainer.setSize(area.getWidth() - 20, totalHeight);
+	samplesContainer.setSize(area.getWidth() - 20, rowOffsets.back() + rowSpacing);
+	updateVisibleRows();
 }
 
 void SampleBankPanel::refreshSampleList()
 {
-	sampleItems.clear();
-	samplesContainer.removeAllChildren();
 	auto *bank = audioProcessor.getSampleBank();
 	if (!bank)
 		return;
 
-	auto samples = bank->getAllSamples();
-
-	DBG("Before filtering: " + juce::String(samples.size()) + " samples");
-	DBG("Current category ID: " + juce::String(currentCategoryId));
+	if (similarToSampleId.isNotEmpty())
+	{
+		setListedSamples(bank->findSimilar(similarToSampleId, maxSimilarResults));
+		return;
+	}
 
+	SampleQuery query;
+	query.text = searchInput.getText();
 	if (currentCategoryId != 0)
 	{
-		juce::String selectedCategoryName;
 		for (const auto &info : categoryInfos)
 		{
 			if (info.id == currentCategoryId)
 			{
-				selectedCategoryName = info.name;
+				query.category = info.name;
 				break;
 			}
 		}
-
-		DBG("Filtering by category: " + selectedCategoryName);
-
-		if (!selectedCategoryName.isEmpty())
-		{
-			samples.erase(
-				std::remove_if(samples.begin(), samples.end(),
-							   [&selectedCategoryName](const SampleBankEntry *entry)
-							   {
-								   return std::find(entry->categories.begin(), entry->categories.end(),
-													selectedCategoryName) == entry->categories.end();
-							   }),
-				samples.end());
-		}
 	}
 
+	auto samples = bank->findSamples(query);
+	DBG("Category '" + query.category + "': " + juce::String(samples.size()) + " samples");
+
 	switch (currentSortType)
 	{
 	case SortType::Time:
@@ -913,7 +910,17 @@ void SampleBankPanel::refreshSampleList()
 		break;
 	}
 
-	createSampleItems(samples);
+	setListedSamples(samples);
+}
+
+void SampleBankPanel::clearSimilarFilter()
+{
+	if (similarToSampleId.isEmpty())
+		return;
+
+	similarToSampleId.clear();
+	searchInput.setTextToShowWhenEmpty("Search prompts...", ColourPalette::textSecondary);
+	searchInput.repaint();
 }
 
 void SampleBankPanel::setVisible(bool shouldBeVisible)
@@ -921,9 +928,9 @@ void SampleBankPanel::setVisible(bool shouldBeVisible)
 	Component::setVisible(shouldBeVisible);
 	if (shouldBeVisible)
 	{
-		for (auto &item : sampleItems)
+		for (auto &row : activeRows)
 		{
-			item->loadAudioDataIfNeeded();
+			row.second->loadAudioDataIfNeeded();
 		}
 		juce::Timer::callAfterDelay(100, [this]()
 									{ refreshSampleList(); });
@@ -931,8 +938,11 @@ void SampleBankPanel::setVisible(bool shouldBeVisible)
 	else
 	{
 		stopPreview();
+		activeRows.clear();
+		spareRows.clear();
 		sampleItems.clear();
 		samplesContainer.removeAllChildren();
+		setListedSamples({});
 	}
 }
 
@@ -971,6 +981,7 @@ void SampleBankPanel::setupUI()
 	addAndMakeVisible(samplesViewport);
 	samplesViewport.setViewedComponent(&samplesContainer, false);
 	samplesViewport.setScrollBarsShown(true, false);
+	samplesViewport.getVerticalScrollBar().addListener(this);
 
 	addAndMakeVisible(categoryFilter);
 	for (const auto &info : categoryInfos)
@@ -994,12 +1005,21 @@ void SampleBankPanel::setupUI()
 		editCategoryButton.setEnabled(editable);
 		deleteCategoryButton.setEnabled(editable);
 
+		clearSimilarFilter();
 		refreshSampleList();
 	};
 
 	addAndMakeVisible(categoryInput);
 	categoryInput.setTextToShowWhenEmpty("New category name...", ColourPalette::textSecondary);
 
+	addAndMakeVisible(searchInput);
+	searchInput.setTextToShowWhenEmpty("Search prompts...", ColourPalette::textSecondary);
+	searchInput.onTextChange = [this]()
+	{
+		clearSimilarFilter();
+		refreshSampleList();
+	};
+
 	addAndMakeVisible(addCategoryButton);
 	addCategoryButton.setButtonText("Add");
 	addCategoryButton.setColour(juce::TextButton::buttonColourId, ColourPalette::emerald);
@@ -1022,68 +1042,158 @@ void SampleBankPanel::setupUI()
 	deleteCategoryButton.setEnabled(false);
 }
 
-void SampleBankPanel::createSampleItems(const std::vector<SampleBankEntry *> &samples)
+void SampleBankPanel::setListedSamples(const std::vector<SampleBankEntry *> &samples)
 {
-	int yPos = 5;
+	listedSamples = samples;
+	rowOffsets.assign(1, rowSpacing);
+	for (auto *entry : listedSamples)
+		rowOffsets.push_back(rowOffsets.back() + SampleBankItem::getRequiredHeightFor(entry) + rowSpacing);
+
+	// Rows keep their binding while spare, so entries still in view pick their old row back
+	for (auto &row : activeRows)
+		releaseRow(row.second);
+	activeRows.clear();
+
+	samplesContainer.setSize(samplesViewport.getWidth() - 20, rowOffsets.back() + rowSpacing);
+	updateVisibleRows();
+}
 
-	for (auto *sampleEntry : samples)
-	{
-		auto item = std::make_unique<SampleBankItem>(sampleEntry, audioProcessor);
+void SampleBankPanel::scrollBarMoved(juce::ScrollBar * /*scrollBar*/, double /*newRangeStart*/)
+{
+	updateVisibleRows();
+}
 
-		item->onPreviewRequested = [this](SampleBankEntry *entry)
-		{
-			playPreview(entry);
-		};
-		item->onStopRequested = [this]()
-		{
-			stopPreview();
-		};
-		item->onDeleteRequested = [this](const juce::String &sampleId)
-		{
-			auto *entry = audioProcessor.getSampleBank()->getSample(sampleId);
-			if (entry)
-			{
-				showDeleteConfirmation(sampleId, entry->originalPrompt);
-			}
-		};
-		item->onCategoriesChanged = [this](SampleBankEntry *entry, const std::vector<juce::String> & /*newCategories*/)
-		{
-			auto *bank = audioProcessor.getSampleBank();
-			if (bank)
-			{
-				bank->saveBankData();
-			}
-			refreshSampleList();
-			DBG("Categories updated for sample: " + entry->originalPrompt);
-		};
-		item->getCategoriesList = [this]() -> std::vector<juce::String>
-		{
-			std::vector<juce::String> categories;
-			for (const auto &info : categoryInfos)
-			{
-				if (info.id > 0)
-				{
-					categories.push_back(info.name);
-				}
-			}
-			return categories;
-		};
-		int itemHeight = item->getRequiredHeight();
-		item->setBounds(5, yPos, samplesContainer.getWidth() - 10, itemHeight);
+void SampleBankPanel::updateVisibleRows()
+{
+	const auto viewArea = samplesViewport.getViewArea();
+	const int top = viewArea.getY() - rowOverscan;
+	const int bottom = viewArea.getBottom() + rowOverscan;
 
-		samplesContainer.addAndMakeVisible(item.get());
+	const int first = std::max(0, (int)(std::upper_bound(rowOffsets.begin(), rowOffsets.end(), top) - rowOffsets.begin()) - 1);
+	const int last = std::min((int)listedSamples.size(),
+							  (int)(std::lower_bound(rowOffsets.begin(), rowOffsets.end(), bottom) - rowOffsets.begin()));
 
-		if (isVisible())
+	for (auto it = activeRows.begin(); it != activeRows.end();)
+	{
+		if (it->first < first || it->first >= last)
+		{
+			releaseRow(it->second);
+			it = activeRows.erase(it);
+		}
+		else
 		{
-			item->loadAudioDataIfNeeded();
+			++it;
 		}
+	}
 
+	const int rowWidth = samplesContainer.getWidth() - 10;
+	for (int i = first; i < last; ++i)
+	{
+		auto *&row = activeRows[i];
+		if (row == nullptr)
+			row = acquireRow(listedSamples[(size_t)i]);
+		row->setBounds(5, rowOffsets[(size_t)i], rowWidth, rowOffsets[(size_t)i + 1] - rowOffsets[(size_t)i] - rowSpacing);
+	}
+}
+
+SampleBankItem *SampleBankPanel::acquireRow(SampleBankEntry *entry)
+{
+	auto match = std::find_if(spareRows.begin(), spareRows.end(),
+							  [entry](const SampleBankItem *row)
+							  { return row->getBoundSampleId() == entry->id; });
+	if (match == spareRows.end() && !spareRows.empty())
+		match = std::prev(spareRows.end());
+
+	SampleBankItem *row = nullptr;
+	if (match != spareRows.end())
+	{
+		row = *match;
+		spareRows.erase(match);
+	}
+	else
+	{
+		auto item = std::make_unique<SampleBankItem>(entry, audioProcessor);
+		row = item.get();
+		wireRow(*row);
+		samplesContainer.addChildComponent(row);
 		sampleItems.push_back(std::move(item));
-		yPos += itemHeight + 5;
 	}
 
-	samplesContainer.setSize(samplesViewport.getWidth() - 20, yPos + 5);
-	resized();
+	row->setSampleEntry(entry);
+	row->setVisible(true);
+	if (isVisible())
+		row->loadAudioDataIfNeeded();
+
+	if (entry == currentPreviewEntry)
+	{
+		row->setIsPlaying(true);
+		currentPreviewItem = row;
+	}
+	return row;
+}
+
+void SampleBankPanel::releaseRow(SampleBankItem *row)
+{
+	if (row == currentPreviewItem)
+		currentPreviewItem = nullptr;
+
+	row->setIsPlaying(false);
+	row->setVisible(false);
+	spareRows.push_back(row);
+}
+
+void SampleBankPanel::wireRow(SampleBankItem &item)
+{
+	item.onPreviewRequested = [this](SampleBankEntry *entry)
+	{
+		playPreview(entry);
+	};
+	item.onStopRequested = [this]()
+	{
+		stopPreview();
+	};
+	item.onDeleteRequested = [this](const juce::String &sampleId)
+	{
+		auto *entry = audioProcessor.getSampleBank()->getSample(sampleId);
+		if (entry)
+		{
+			showDeleteConfirmation(sampleId, entry->originalPrompt);
+		}
+	};
+	item.onFindSimilarRequested = [this](const juce::String &sampleId)
+	{
+		auto *entry = audioProcessor.getSampleBank()->getSample(sampleId);
+		if (!entry)
+			return;
+
+		similarToSampleId = sampleId;
+		searchInput.setText({}, false);
+		searchInput.setTextToShowWhenEmpty("Similar to: " + entry->originalPrompt, ColourPalette::amber);
+		searchInput.repaint();
+
+		juce::Component::SafePointer<SampleBankPanel> safeThis(this);
+		juce::MessageManager::callAsync([safeThis]()
+										{
+			if (safeThis != nullptr)
+				safeThis->refreshSampleList(); });
+	};
+	item.onCategoriesChanged = [this](SampleBankEntry *entry, const std::vector<juce::String> & /*newCategories*/)
+	{
+		refreshSampleList();
+		DBG("Categories updated for sample: " + entry->originalPrompt);
+	};
+	item.getCategoriesList = [this]() -> std::vector<juce::String>
+	{
+		std::vector<juce::String> categories;
+		for (const auto &info : categoryInfos)
+		{
+			if (info.id > 0)
+			{
+				categories.push_back(info.name);
+			}
+		}
+		return categories;
+	};
 }
 
 void SampleBankPanel::deleteSample(const juce::String &sampleId)
@@ -1127,7 +1237,6 @@ void SampleBankPanel::cleanupUnusedSamples()
 			if (result == 1)
 			{
 				int removed = bank->removeUnusedSamples();
-				refreshSampleList();
 
 				juce::AlertWindow::showMessageBoxAsync(
 					juce::MessageBoxIconType::InfoIcon,
@@ -1267,16 +1376,7 @@ void SampleBankPanel::editCategory()
 	auto *bank = audioProcessor.getSampleBank();
 	if (bank)
 	{
-		auto samples = bank->getAllSamples();
-		for (auto *sample : samples)
-		{
-			auto &categories = sample->categories;
-			auto catIt = std::find(categories.begin(), categories.end(), oldName);
-			if (catIt != categories.end())
-			{
-				*catIt = newName;
-			}
-		}
+		bank->renameCategory(oldName, newName);
 	}
 
 	categoryInput.clear();
@@ -1320,15 +1420,7 @@ void SampleBankPanel::deleteCategory()
 				auto *bank = audioProcessor.getSampleBank();
 				if (bank)
 				{
-					auto samples = bank->getAllSamples();
-					for (auto *sample : samples)
-					{
-						auto &categories = sample->categories;
-						categories.erase(
-							std::remove(categories.begin(), categories.end(), categoryName),
-							categories.end());
-					}
-					bank->saveBankData();
+					bank->removeCategory(categoryName);
 				}
 				categoryInfos.erase(
 					std::remove_if(categoryInfos.begin(), categoryInfos.end(),
@@ -22,18 +22,23 @@ public:
 	void loadAudioDataIfNeeded();
 	void showCategoryMenu();
 	int getRequiredHeight();
+	static int getRequiredHeightFor(const SampleBankEntry *entry);
 
+	void setSampleEntry(SampleBankEntry *entry);
 	SampleBankEntry *getSampleEntry() const { return sampleEntry; }
+	const juce::String &getBoundSampleId() const { return boundSampleId; }
 
 	std::function<void(const juce::String &)> onDeleteRequested;
 	std::function<void(SampleBankEntry *)> onPreviewRequested;
 	std::function<void()> onStopRequested;
 	std::function<void(SampleBankEntry *, const std::vector<juce::String> &)> onCategoriesChanged;
+	std::function<void(const juce::String &)> onFindSimilarRequested;
 
 	std::function<std::vector<juce::String>()> getCategoriesList;
 
 private:
 	SampleBankEntry *sampleEntry;
+	juce::String boundSampleId;
 	DjIaVstProcessor &audioProcessor;
 
 	juce::Label nameLabel;
@@ -45,7 +50,7 @@ private:
 
 	juce::Rectangle<int> waveformBounds;
 	std::vector<float> thumbnail;
-	juce::AudioBuffer<float> audioBuffer;
+	std::vector<float> peakValues;
 	std::shared_ptr<std::atomic<bool>> validityFlag;
 	std::atomic<bool> isDestroyed{false};
 
@@ -65,6 +70,7 @@ private:
 	void updatePlayButton();
 	void generateThumbnail();
 	void loadAudioData();
+	static constexpr int maxThumbnailPoints = 1024;
 	void drawMiniWaveform(juce::Graphics &g);
 	void setPlaybackPosition(float positionInSeconds);
 	void timerCallback() override;
@@ -106,7 +112,8 @@ struct CategoryInfo
 };
 
 class SampleBankPanel : public juce::Component,
-						public juce::Timer
+						public juce::Timer,
+						public juce::ScrollBar::Listener
 {
 public:
 	SampleBankPanel(DjIaVstProcessor &processor);
@@ -115,6 +122,7 @@ public:
 	void paint(juce::Graphics &g) override;
 	void resized() override;
 	void timerCallback() override;
+	void scrollBarMoved(juce::ScrollBar *scrollBar, double newRangeStart) override;
 	void refreshSampleList();
 	void setVisible(bool shouldBeVisible) override;
 
@@ -131,6 +139,10 @@ private:
 	juce::ComboBox sortMenu;
 
 	juce::TextEditor categoryInput;
+	juce::TextEditor searchInput;
+	juce::String similarToSampleId;
+	static constexpr int maxSimilarResults = 30;
+	void clearSimilarFilter();
 	juce::TextButton addCategoryButton;
 	juce::TextButton editCategoryButton;
 	juce::TextButton deleteCategoryButton;
@@ -173,13 +185,25 @@ private:
 	};
 	SortType currentSortType = SortType::Prompt;
 
+	static constexpr int rowSpacing = 5;
+	static constexpr int rowOverscan = 200;
+
+	// Rows exist only for the visible range; sampleItems owns every row ever built
 	std::vector<std::unique_ptr<SampleBankItem>> sampleItems;
+	std::vector<SampleBankEntry *> listedSamples;
+	std::vector<int> rowOffsets{rowSpacing};
+	std::map<int, SampleBankItem *> activeRows;
+	std::vector<SampleBankItem *> spareRows;
 
 	SampleBankEntry *currentPreviewEntry = nullptr;
 	SampleBankItem *currentPreviewItem = nullptr;
 
 	void setupUI();
-	void createSampleItems(const std::vector<SampleBankEntry *> &samples);
+	void setListedSamples(const std::vector<SampleBankEntry *> &samples);
+	void updateVisibleRows();
+	SampleBankItem *acquireRow(SampleBankEntry *entry);
+	void releaseRow(SampleBankItem *row);
+	void wireRow(SampleBankItem &item);
 	void playPreview(SampleBankEntry *entry);
 	void stopPreview();
 	void deleteSample(const juce::String &sampleId);
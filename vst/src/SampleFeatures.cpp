@@ -0,0 +1,226 @@
+#include "SampleFeatures.h"
+#include "SampleBank.h"
+#include "RadixFFT.h"
+#include <complex>
+#include <numeric>
+
+std::vector<float> SampleFeatures::compute(const juce::File &audioFile)
+{
+	juce::AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+
+	std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
+	if (!reader || reader->lengthInSamples < fftSize || reader->sampleRate <= 0.0)
+		return {};
+
+	const int numSamples = (int)std::min<juce::int64>(reader->lengthInSamples, (juce::int64)(maxAnalysisSeconds * reader->sampleRate));
+	juce::AudioBuffer<float> audio((int)reader->numChannels, numSamples);
+	if (!reader->read(&audio, 0, numSamples, 0, true, true))
+		return {};
+
+	return compute(audio, reader->sampleRate);
+}
+
+std::vector<float> SampleFeatures::compute(const juce::AudioBuffer<float> &audio, double sampleRate)
+{
+	const int numSamples = std::min(audio.getNumSamples(), (int)(maxAnalysisSeconds * sampleRate));
+	if (numSamples < fftSize || sampleRate <= 0.0 || audio.getNumChannels() == 0)
+		return {};
+
+	std::vector<float> mono((size_t)numSamples, 0.0f);
+	for (int ch = 0; ch < audio.getNumChannels(); ++ch)
+		juce::FloatVectorOperations::addWithMultiply(mono.data(), audio.getReadPointer(ch), 1.0f / audio.getNumChannels(), numSamples);
+
+	const RadixFFT fft(fftOrder);
+
+	constexpr int numBins = fftSize / 2 + 1;
+	const float binHz = (float)(sampleRate / fftSize);
+
+	auto hzToMel = [](float hz)
+	{ return 2595.0f * std::log10(1.0f + hz / 700.0f); };
+	auto melToBin = [binHz](float mel)
+	{ return 700.0f * (std::pow(10.0f, mel / 2595.0f) - 1.0f) / binHz; };
+
+	const float lowMel = hzToMel(30.0f);
+	const float highMel = hzToMel(std::min(16000.0f, (float)sampleRate * 0.5f));
+	float melEdges[numMelBands + 2];
+	for (int m = 0; m < numMelBands + 2; ++m)
+		melEdges[m] = melToBin(lowMel + (highMel - lowMel) * m / (float)(numMelBands + 1));
+
+	std::vector<int> pitchClass(numBins, -1);
+	for (int k = 1; k < numBins; ++k)
+	{
+		const float hz = k * binHz;
+		if (hz >= 55.0f && hz <= 5000.0f)
+			pitchClass[(size_t)k] = ((int)std::lround(12.0f * std::log2(hz / 440.0f)) + 69 + 1200) % 12;
+	}
+
+	double coefficientSum[numCoefficients] = {}, coefficientSquares[numCoefficients] = {};
+	double chroma[12] = {};
+	double centroidSum = 0.0;
+	std::vector<float> flux;
+
+	std::vector<std::complex<float>> data(fftSize);
+	std::vector<float> magnitude(numBins), previousMagnitude(numBins, 0.0f);
+	int numFrames = 0;
+
+	for (int start = 0; start + fftSize <= numSamples; start += hopSize)
+	{
+		for (int i = 0; i < fftSize; ++i)
+			data[(size_t)i] = {mono[(size_t)(start + i)] * fft.windowAt(i), 0.0f};
+		fft.perform(data.data());
+
+		float magnitudeSum = 0.0f, weightedSum = 0.0f, frameFlux = 0.0f;
+		float frameChroma[12] = {};
+		for (int k = 0; k < numBins; ++k)
+		{
+			const float value = std::abs(data[(size_t)k]);
+			magnitude[(size_t)k] = value;
+			magnitudeSum += value;
+			weightedSum += value * k;
+			frameFlux += std::max(0.0f, value - previousMagnitude[(size_t)k]);
+			if (pitchClass[(size_t)k] >= 0)
+				frameChroma[pitchClass[(size_t)k]] += value * value;
+		}
+		float logMel[numMelBands];
+		for (int m = 0; m < numMelBands; ++m)
+		{
+			const float left = melEdges[m], centre = melEdges[m + 1], right = melEdges[m + 2];
+			float energy = 0.0f;
+			for (int k = std::max(1, (int)std::ceil(left)); k <= std::min(numBins - 1, (int)right); ++k)
+			{
+				const float weight = k < centre ? (k - left) / (centre - left) : (right - k) / (right - centre);
+				energy += std::max(0.0f, weight) * magnitude[(size_t)k] * magnitude[(size_t)k];
+			}
+			logMel[m] = std::log(energy + 1.0e-10f);
+		}
+		std::swap(magnitude, previousMagnitude);
+
+		for (int c = 0; c < numCoefficients; ++c)
+		{
+			double coefficient = 0.0;
+			for (int m = 0; m < numMelBands; ++m)
+				coefficient += logMel[m] * std::cos(juce::MathConstants<double>::pi * (c + 1) * (m + 0.5) / numMelBands);
+			coefficientSum[c] += coefficient;
+			coefficientSquares[c] += coefficient * coefficient;
+		}
+
+		const float chromaTotal = std::accumulate(frameChroma, frameChroma + 12, 0.0f);
+		if (chromaTotal > 0.0f)
+		{
+			for (int p = 0; p < 12; ++p)
+				chroma[p] += frameChroma[p] / chromaTotal;
+		}
+
+		if (magnitudeSum > 0.0f)
+			centroidSum += weightedSum / magnitudeSum * binHz;
+		flux.push_back(frameFlux);
+		++numFrames;
+	}
+
+	if (numFrames == 0)
+		return {};
+
+	float fluxMean = 0.0f, fluxDeviation = 0.0f;
+	for (float value : flux)
+		fluxMean += value;
+	fluxMean /= (float)flux.size();
+	for (float value : flux)
+		fluxDeviation += (value - fluxMean) * (value - fluxMean);
+	fluxDeviation = std::sqrt(fluxDeviation / (float)flux.size());
+
+	int onsets = 0;
+	for (size_t i = 1; i + 1 < flux.size(); ++i)
+	{
+		if (flux[i] > fluxMean + fluxDeviation && flux[i] >= flux[i - 1] && flux[i] > flux[i + 1])
+			++onsets;
+	}
+	const float onsetRate = onsets / (float)(numSamples / sampleRate);
+
+	std::vector<float> features((size_t)numFeatures, 0.0f);
+	auto normaliseGroup = [&features](int offset, int count, float weight)
+	{
+		float length = 0.0f;
+		for (int i = 0; i < count; ++i)
+			length += features[(size_t)(offset + i)] * features[(size_t)(offset + i)];
+		length = std::sqrt(length);
+		for (int i = 0; i < count && length > 0.0f; ++i)
+			features[(size_t)(offset + i)] *= weight / length;
+	};
+
+	for (int c = 0; c < numCoefficients; ++c)
+	{
+		const double mean = coefficientSum[c] / numFrames;
+		features[(size_t)c] = (float)mean;
+		features[(size_t)(numCoefficients + c)] = (float)std::sqrt(std::max(0.0, coefficientSquares[c] / numFrames - mean * mean));
+	}
+	for (int p = 0; p < 12; ++p)
+		features[(size_t)(2 * numCoefficients + p)] = (float)(chroma[p] / numFrames);
+
+	normaliseGroup(0, numCoefficients, 1.0f);
+	normaliseGroup(numCoefficients, numCoefficients, 0.5f);
+	normaliseGroup(2 * numCoefficients, 12, 0.7f);
+	features[38] = 0.5f * std::log2(1.0f + onsetRate) / 4.0f;
+	features[39] = 0.5f * (float)(centroidSum / numFrames / (sampleRate * 0.5));
+	normaliseGroup(0, numFeatures, 1.0f);
+	return features;
+}
+
+void SimilarityIndex::add(SampleBankEntry *entry)
+{
+	if ((int)entry->features.size() != SampleFeatures::numFeatures || rowOf.count(entry) > 0)
+		return;
+
+	rowOf[entry] = rows.size();
+	rows.push_back(entry);
+	matrix.insert(matrix.end(), entry->features.begin(), entry->features.end());
+}
+
+void SimilarityIndex::remove(SampleBankEntry *entry)
+{
+	auto it = rowOf.find(entry);
+	if (it == rowOf.end())
+		return;
+
+	const size_t row = it->second;
+	const size_t last = rows.size() - 1;
+	if (row != last)
+	{
+		std::copy_n(matrix.begin() + (std::ptrdiff_t)(last * SampleFeatures::numFeatures), SampleFeatures::numFeatures,
+					matrix.begin() + (std::ptrdiff_t)(row * SampleFeatures::numFeatures));
+		rows[row] = rows[last];
+		rowOf[rows[row]] = row;
+	}
+	rows.pop_back();
+	matrix.resize(rows.size() * SampleFeatures::numFeatures);
+	rowOf.erase(it);
+}
+
+void SimilarityIndex::clear()
+{
+	matrix.clear();
+	rows.clear();
+	rowOf.clear();
+}
+
+std::vector<SampleBankEntry *> SimilarityIndex::nearest(const float *query, int maxResults, const SampleBankEntry *exclude) const
+{
+	std::vector<std::pair<float, SampleBankEntry *>> scored;
+	scored.reserve(rows.size());
+	const float *row = matrix.data();
+	for (size_t i = 0; i < rows.size(); ++i, row += SampleFeatures::numFeatures)
+	{
+		if (rows[i] != exclude)
+			scored.emplace_back(SampleFeatures::similarity(query, row), rows[i]);
+	}
+
+	const auto count = std::min(scored.size(), (size_t)std::max(0, maxResults));
+	std::partial_sort(scored.begin(), scored.begin() + (std::ptrdiff_t)count, scored.end(),
+					  [](const auto &a, const auto &b)
+					  { return a.first > b.first; });
+
+	std::vector<SampleBankEntry *> result;
+	for (size_t i = 0; i < count; ++i)
+		result.push_back(scored[i].second);
+	return result;
+}
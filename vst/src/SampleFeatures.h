@@ -0,0 +1,65 @@
+#pragma once
+#include "JuceHeader.h"
+#include "SimdConfig.h"
+#include <unordered_map>
+#include <vector>
+
+struct SampleBankEntry;
+
+class SampleFeatures
+{
+public:
+	// MFCC 1-13 mean and spread, 12 chroma bins, onset rate and spectral centroid,
+	// scaled to unit length so cosine similarity is a plain dot product
+	static constexpr int numFeatures = 40;
+
+	static std::vector<float> compute(const juce::File &audioFile);
+	static std::vector<float> compute(const juce::AudioBuffer<float> &audio, double sampleRate);
+
+	static float similarity(const float *a, const float *b)
+	{
+		int i = 0;
+		float total = 0.0f;
+#if SIMD_USE_SSE
+		__m128 accumulator = _mm_setzero_ps();
+		for (; i + 4 <= numFeatures; i += 4)
+			accumulator = _mm_add_ps(accumulator, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+		alignas(16) float lanes[4];
+		_mm_store_ps(lanes, accumulator);
+		total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif SIMD_USE_NEON
+		float32x4_t accumulator = vdupq_n_f32(0.0f);
+		for (; i + 4 <= numFeatures; i += 4)
+			accumulator = vmlaq_f32(accumulator, vld1q_f32(a + i), vld1q_f32(b + i));
+		float32x2_t pair = vadd_f32(vget_low_f32(accumulator), vget_high_f32(accumulator));
+		total = vget_lane_f32(vpadd_f32(pair, pair), 0);
+#endif
+		for (; i < numFeatures; ++i)
+			total += a[i] * b[i];
+		return total;
+	}
+
+private:
+	static constexpr int fftOrder = 11;
+	static constexpr int fftSize = 1 << fftOrder;
+	static constexpr int hopSize = fftSize / 2;
+	static constexpr int numMelBands = 26;
+	static constexpr int numCoefficients = 13;
+	static constexpr double maxAnalysisSeconds = 60.0;
+};
+
+class SimilarityIndex
+{
+public:
+	void add(SampleBankEntry *entry);
+	void remove(SampleBankEntry *entry);
+	void clear();
+
+	std::vector<SampleBankEntry *> nearest(const float *query, int maxResults, const SampleBankEntry *exclude) const;
+
+private:
+	// Rows stay contiguous: removal moves the last row into the gap
+	std::vector<float> matrix;
+	std::vector<SampleBankEntry *> rows;
+	std::unordered_map<SampleBankEntry *, size_t> rowOf;
+};
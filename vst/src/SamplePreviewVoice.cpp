@@ -0,0 +1,237 @@
+#include "SamplePreviewVoice.h"
+
+SamplePreviewVoice::SamplePreviewVoice() : juce::Thread("Sample Preview Streamer")
+{
+	formatManager.registerBasicFormats();
+	ringBuffer.clear();
+	startThread(juce::Thread::Priority::low);
+}
+
+SamplePreviewVoice::~SamplePreviewVoice()
+{
+	stopThread(2000);
+}
+
+void SamplePreviewVoice::prepare(double newHostSampleRate)
+{
+	if (newHostSampleRate > 0.0)
+		hostSampleRate.store(newHostSampleRate);
+}
+
+void SamplePreviewVoice::start(const juce::File &file)
+{
+	{
+		juce::ScopedLock lock(requestLock);
+		requestedFile = file;
+		latestRequestedSession.store(++requestedSession);
+	}
+	playing.store(true);
+	notify();
+}
+
+void SamplePreviewVoice::stop()
+{
+	{
+		juce::ScopedLock lock(requestLock);
+		requestedFile = juce::File();
+		latestRequestedSession.store(++requestedSession);
+	}
+	playing.store(false);
+	notify();
+}
+
+void SamplePreviewVoice::run()
+{
+	while (!threadShouldExit())
+	{
+		int session;
+		juce::File file;
+		{
+			juce::ScopedLock lock(requestLock);
+			session = requestedSession;
+			file = requestedFile;
+		}
+
+		if (session != loaderSession)
+		{
+			loaderSession = session;
+			reader.reset();
+			if (file == juce::File())
+				publishSession(session, hostSampleRate.load(), false);
+			else
+				openRequestedFile(session, file);
+		}
+
+		if (reader != nullptr)
+			fillRing();
+
+		wait(reader != nullptr ? 5 : -1);
+	}
+}
+
+bool SamplePreviewVoice::openRequestedFile(int session, const juce::File &file)
+{
+	reader.reset(formatManager.createReaderFor(file));
+	if (reader == nullptr || reader->lengthInSamples <= 0)
+	{
+		DBG("Cannot stream preview: " << file.getFullPathName());
+		reader.reset();
+		publishSession(session, hostSampleRate.load(), false);
+		if (latestRequestedSession.load() == session)
+			playing.store(false);
+		return false;
+	}
+
+	readerPosition = 0;
+	publishSession(session, reader->sampleRate, true);
+	return true;
+}
+
+void SamplePreviewVoice::publishSession(int session, double sampleRate, bool hasAudio)
+{
+	sessionStartFrame.store(framesWritten);
+	sessionSampleRate.store(sampleRate);
+	publishedSession.store(session, std::memory_order_release);
+	if (!hasAudio)
+		finishedSession.store(session, std::memory_order_release);
+}
+
+void SamplePreviewVoice::fillRing()
+{
+	while (reader != nullptr && !threadShouldExit())
+	{
+		const int freeSpace = ring.getFreeSpace();
+		if (freeSpace <= 0)
+			return;
+
+		const int chunk = (int)std::min<juce::int64>({(juce::int64)freeSpace, (juce::int64)readChunkSize,
+													   reader->lengthInSamples - readerPosition});
+		if (chunk > 0)
+		{
+			reader->read(&readBuffer, 0, chunk, readerPosition, true, true);
+
+			int start1, size1, start2, size2;
+			ring.prepareToWrite(chunk, start1, size1, start2, size2);
+			for (int ch = 0; ch < 2; ++ch)
+			{
+				ringBuffer.copyFrom(ch, start1, readBuffer, ch, 0, size1);
+				ringBuffer.copyFrom(ch, start2, readBuffer, ch, size1, size2);
+			}
+			ring.finishedWrite(size1 + size2);
+
+			readerPosition += chunk;
+			framesWritten += chunk;
+		}
+
+		if (readerPosition >= reader->lengthInSamples)
+		{
+			reader.reset();
+			finishedSession.store(loaderSession, std::memory_order_release);
+			return;
+		}
+
+		juce::ScopedLock lock(requestLock);
+		if (requestedSession != loaderSession)
+			return;
+	}
+}
+
+void SamplePreviewVoice::beginPublishedSession(int session)
+{
+	playingSession = session;
+
+	const juce::int64 skip = sessionStartFrame.load() - framesRead;
+	const int discard = (int)juce::jlimit<juce::int64>(0, ring.getNumReady(), skip);
+	ring.finishedRead(discard);
+	framesRead += discard;
+
+	fraction = 3.0;
+	std::memset(history, 0, sizeof(history));
+	voiceActive = true;
+}
+
+void SamplePreviewVoice::renderNextBlock(juce::AudioBuffer<float> &output, int numSamples)
+{
+	int session = publishedSession.load(std::memory_order_acquire);
+	bool finished = false;
+	int ready = 0;
+	for (int attempt = 0;; ++attempt)
+	{
+		if (session != playingSession)
+			beginPublishedSession(session);
+
+		finished = finishedSession.load(std::memory_order_acquire) == session;
+		ready = ring.getNumReady();
+
+		const int latest = publishedSession.load(std::memory_order_acquire);
+		if (latest == session)
+			break;
+		if (attempt == 2)
+			return;
+		session = latest;
+	}
+
+	if (!voiceActive || output.getNumChannels() == 0)
+		return;
+
+	const double ratio = sessionSampleRate.load() / hostSampleRate.load();
+	const float *ringLeft = ringBuffer.getReadPointer(0);
+	const float *ringRight = ringBuffer.getReadPointer(1);
+	float *outLeft = output.getWritePointer(0);
+	float *outRight = output.getNumChannels() > 1 ? output.getWritePointer(1) : nullptr;
+
+	int start1, size1, start2, size2;
+	ring.prepareToRead(ready, start1, size1, start2, size2);
+
+	int consumed = 0;
+	bool starved = false;
+	for (int i = 0; i < numSamples; ++i)
+	{
+		while (fraction >= 1.0 && consumed < ready)
+		{
+			const int index = consumed < size1 ? start1 + consumed : start2 + consumed - size1;
+			for (int ch = 0; ch < 2; ++ch)
+			{
+				history[ch][0] = history[ch][1];
+				history[ch][1] = history[ch][2];
+				history[ch][2] = history[ch][3];
+			}
+			history[0][3] = ringLeft[index];
+			history[1][3] = ringRight[index];
+			++consumed;
+			fraction -= 1.0;
+		}
+
+		if (fraction >= 1.0)
+		{
+			starved = true;
+			break;
+		}
+
+		const float t = (float)fraction;
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			const float *x = history[ch];
+			const float c1 = 0.5f * (x[2] - x[0]);
+			const float c2 = x[0] - 2.5f * x[1] + 2.0f * x[2] - 0.5f * x[3];
+			const float c3 = 0.5f * (x[3] - x[0]) + 1.5f * (x[1] - x[2]);
+			const float sample = (((c3 * t + c2) * t + c1) * t + x[1]) * previewGain;
+
+			if (ch == 0)
+				outLeft[i] += sample;
+			else if (outRight != nullptr)
+				outRight[i] += sample;
+		}
+		fraction += ratio;
+	}
+
+	ring.finishedRead(consumed);
+	framesRead += consumed;
+
+	if (starved && finished)
+	{
+		voiceActive = false;
+		if (latestRequestedSession.load() == playingSession)
+			playing.store(false);
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "JuceHeader.h"
+
+class SamplePreviewVoice : private juce::Thread
+{
+public:
+	SamplePreviewVoice();
+	~SamplePreviewVoice() override;
+
+	void prepare(double newHostSampleRate);
+	void start(const juce::File &file);
+	void stop();
+	bool isPlaying() const { return playing.load(); }
+
+	void renderNextBlock(juce::AudioBuffer<float> &output, int numSamples);
+
+private:
+	void run() override;
+	bool openRequestedFile(int session, const juce::File &file);
+	void fillRing();
+	void publishSession(int session, double sampleRate, bool hasAudio);
+	void beginPublishedSession(int session);
+
+	static constexpr int ringCapacity = 65536;
+	static constexpr int readChunkSize = 4096;
+	static constexpr float previewGain = 0.7f;
+
+	juce::AbstractFifo ring{ringCapacity};
+	juce::AudioBuffer<float> ringBuffer{2, ringCapacity};
+
+	std::atomic<bool> playing{false};
+	std::atomic<int> latestRequestedSession{0};
+	std::atomic<int> publishedSession{0};
+	std::atomic<int> finishedSession{0};
+	std::atomic<juce::int64> sessionStartFrame{0};
+	std::atomic<double> sessionSampleRate{44100.0};
+	std::atomic<double> hostSampleRate{44100.0};
+
+	juce::CriticalSection requestLock;
+	juce::File requestedFile;
+	int requestedSession = 0;
+
+	juce::AudioFormatManager formatManager;
+	std::unique_ptr<juce::AudioFormatReader> reader;
+	juce::AudioBuffer<float> readBuffer{2, readChunkSize};
+	juce::int64 readerPosition = 0;
+	juce::int64 framesWritten = 0;
+	int loaderSession = 0;
+
+	int playingSession = 0;
+	bool voiceActive = false;
+	juce::int64 framesRead = 0;
+	double fraction = 0.0;
+	float history[2][4] = {};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SamplePreviewVoice)
+};
@@ -0,0 +1,190 @@
+#pragma once
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+// Host-synced sixteenth-note step clock. Kept free of JUCE so the block
+// scheduling can be exercised against synthetic playheads in tests.
+class SequencerClock
+{
+public:
+	static constexpr double stepInPpq = 0.25;
+	static constexpr int maxDeferredTriggers = 8;
+
+	int stepCounter = 0;
+	double lastStepPpq = -1.0;
+
+	void reset()
+	{
+		stepCounter = 0;
+		lastStepPpq = -1.0;
+		numDeferredTriggers = 0;
+		earlyDecidedStep = noStep;
+	}
+
+	// Sequencer must provide:
+	//   int stepsUntilNextEvent(int stepCounter)
+	//   bool canTrigger()
+	//   double microTiming(int stepCounter)     fraction of a step, -0.5..0.5
+	//   bool advanceStep(int stepCounter)       true when the step sounds
+	//   bool canDecideEarly(int stepCounter)    false while a pending action may change the outcome
+	//   bool stepWillSound(int stepCounter)     decides a step ahead of its grid point
+	//   void trigger(int stepCounter, int sampleOffset)
+	//   void idleAt(int stepCounter)
+	//
+	// Micro-timed triggers fire in the block that contains them: late ones are
+	// deferred past the block end, early ones are decided up to half a step
+	// before their grid point.
+	template <typename Sequencer>
+	void process(double blockStartPpq, double ppqPerSample, int numSamples,
+				 int maxStepsPerBlock, Sequencer &sequencer)
+	{
+		const Block block{blockStartPpq, blockStartPpq + (numSamples - 1 + 1.0e-6) * ppqPerSample,
+						  ppqPerSample, numSamples};
+
+		bool hostJumped = lastStepPpq >= 0 &&
+						  (blockStartPpq + stepInPpq * 0.5 < lastStepPpq ||
+						   blockStartPpq - lastStepPpq > stepInPpq * maxStepsPerBlock);
+		if (lastStepPpq < 0 || hostJumped)
+		{
+			numDeferredTriggers = 0;
+			earlyDecidedStep = noStep;
+			stepCounter = (int)std::floor(blockStartPpq / stepInPpq);
+			lastStepPpq = stepCounter * stepInPpq;
+			scheduleStep(block, sequencer);
+		}
+
+		fireDeferredTriggers(block, sequencer);
+
+		int stepsInBlock = stepsUpTo(block.lastSamplePpq);
+		while (stepsInBlock > 0 && sequencer.canTrigger())
+		{
+			int stepsToEvent = sequencer.stepsUntilNextEvent(stepCounter);
+			int stepsToAdvance = std::min(stepsToEvent, stepsInBlock);
+			advance(stepsToAdvance);
+			stepsInBlock -= stepsToAdvance;
+
+			if (stepsToAdvance < stepsToEvent)
+			{
+				sequencer.idleAt(stepCounter);
+				break;
+			}
+
+			scheduleStep(block, sequencer);
+		}
+
+		if (stepsInBlock == 0)
+			decideEarlyStep(block, sequencer);
+	}
+
+	static int ppqToSampleOffset(double ppqFromBlockStart, double ppqPerSample, int numSamples)
+	{
+		int offset = (int)std::ceil(ppqFromBlockStart / ppqPerSample - 1.0e-6);
+		return std::clamp(offset, 0, std::max(0, numSamples - 1));
+	}
+
+	static void stepCounterToPosition(int stepCounter, int stepsPerMeasure, int numMeasures, int &measure, int &step)
+	{
+		stepsPerMeasure = std::max(1, stepsPerMeasure);
+		int patternLength = stepsPerMeasure * std::max(1, numMeasures);
+		int position = ((stepCounter % patternLength) + patternLength) % patternLength;
+		measure = position / stepsPerMeasure;
+		step = position % stepsPerMeasure;
+	}
+
+	static int stepsUntilNextEvent(int measure, int step, int stepsPerMeasure, int numMeasures, int stepsToActive)
+	{
+		int stepsToPatternStart = stepsPerMeasure * (numMeasures - measure) - step;
+		if (stepsToActive > 0)
+			return std::min(stepsToActive, stepsToPatternStart);
+		return stepsToPatternStart;
+	}
+
+private:
+	static constexpr int noStep = INT_MIN;
+
+	struct Block
+	{
+		double startPpq;
+		double lastSamplePpq;
+		double ppqPerSample;
+		int numSamples;
+
+		int offsetOf(double ppq) const { return ppqToSampleOffset(ppq - startPpq, ppqPerSample, numSamples); }
+	};
+
+	struct DeferredTrigger
+	{
+		int stepCounter;
+		double ppq;
+	};
+
+	DeferredTrigger deferredTriggers[maxDeferredTriggers] = {};
+	int numDeferredTriggers = 0;
+	int earlyDecidedStep = noStep;
+
+	int stepsUpTo(double ppq) const
+	{
+		return std::max(0, (int)std::floor((ppq - lastStepPpq) / stepInPpq));
+	}
+
+	void advance(int steps)
+	{
+		stepCounter += steps;
+		lastStepPpq = stepCounter * stepInPpq;
+	}
+
+	template <typename Sequencer>
+	void scheduleStep(const Block &block, Sequencer &sequencer)
+	{
+		bool sounds = sequencer.advanceStep(stepCounter);
+		if (stepCounter == earlyDecidedStep)
+		{
+			earlyDecidedStep = noStep;
+			return;
+		}
+		if (!sounds)
+			return;
+
+		double triggerPpq = lastStepPpq + sequencer.microTiming(stepCounter) * stepInPpq;
+		if (triggerPpq <= block.lastSamplePpq)
+		{
+			sequencer.trigger(stepCounter, block.offsetOf(triggerPpq));
+		}
+		else if (numDeferredTriggers < maxDeferredTriggers)
+		{
+			deferredTriggers[numDeferredTriggers++] = {stepCounter, triggerPpq};
+		}
+	}
+
+	template <typename Sequencer>
+	void fireDeferredTriggers(const Block &block, Sequencer &sequencer)
+	{
+		int kept = 0;
+		for (int i = 0; i < numDeferredTriggers; ++i)
+		{
+			const auto deferred = deferredTriggers[i];
+			if (deferred.ppq <= block.lastSamplePpq)
+				sequencer.trigger(deferred.stepCounter, block.offsetOf(deferred.ppq));
+			else
+				deferredTriggers[kept++] = deferred;
+		}
+		numDeferredTriggers = kept;
+	}
+
+	template <typename Sequencer>
+	void decideEarlyStep(const Block &block, Sequencer &sequencer)
+	{
+		const int nextStep = stepCounter + 1;
+		if (nextStep == earlyDecidedStep)
+			return;
+
+		double triggerPpq = (nextStep + sequencer.microTiming(nextStep)) * stepInPpq;
+		if (triggerPpq > block.lastSamplePpq || !sequencer.canDecideEarly(nextStep))
+			return;
+
+		earlyDecidedStep = nextStep;
+		if (sequencer.stepWillSound(nextStep))
+			sequencer.trigger(nextStep, block.offsetOf(triggerPpq));
+	}
+};
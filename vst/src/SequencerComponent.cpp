@@ -13,7 +13,7 @@ void SequencerComponent::setupUI()
 {
 
 	addAndMakeVisible(measureSlider);
-	measureSlider.setRange(1, 4, 1);
+	measureSlider.setRange(1, MAX_MEASURES, 1);
 	measureSlider.setValue(1);
 	measureSlider.setTextBoxStyle(juce::Slider::TextBoxRight, false, 30, 20);
 	measureSlider.setDoubleClickReturnValue(true, 1);
@@ -157,7 +157,7 @@ void SequencerComponent::paint(juce::Graphics &g)
 			stepColour = ColourPalette::backgroundDeep;
 			borderColour = ColourPalette::backgroundMid;
 		}
-		else if (track->sequencerData.steps[safeMeasure][i])
+		else if (track->sequencerData.pattern.isActive(safeMeasure, i))
 		{
 			stepColour = trackColour;
 			borderColour = trackColour.brighter(0.4f);
@@ -261,28 +261,8 @@ void SequencerComponent::mouseDown(const juce::MouseEvent &event)
 
 int SequencerComponent::getTotalStepsForCurrentSignature() const
 {
-	int numerator = audioProcessor.getTimeSignatureNumerator();
-	int denominator = audioProcessor.getTimeSignatureDenominator();
-
-	int stepsPerBeat;
-	if (denominator == 8)
-	{
-		stepsPerBeat = 2; // ← 2 subdivisions par croche (pas 4)
-	}
-	else if (denominator == 4)
-	{
-		stepsPerBeat = 4; // 4 subdivisions par noire (16th notes)
-	}
-	else if (denominator == 2)
-	{
-		stepsPerBeat = 8; // 8 subdivisions par blanche
-	}
-	else
-	{
-		stepsPerBeat = 4; // Default
-	}
-
-	return numerator * stepsPerBeat;
+	return SequencerPattern::stepsPerMeasureFor(audioProcessor.getTimeSignatureNumerator(),
+												audioProcessor.getTimeSignatureDenominator());
 }
 
 void SequencerComponent::toggleStep(int step)
@@ -292,8 +272,8 @@ void SequencerComponent::toggleStep(int step)
 	{
 		int safeMeasure = juce::jlimit(0, MAX_MEASURES - 1, currentMeasure);
 
-		track->sequencerData.steps[safeMeasure][step] = !track->sequencerData.steps[safeMeasure][step];
-		track->sequencerData.velocities[safeMeasure][step] = 0.8f;
+		track->sequencerData.pattern.toggle(safeMeasure, step);
+		track->sequencerData.pattern.setVelocity(safeMeasure, step, SequencerPattern::defaultVelocity);
 	}
 
 	// TODO: velocity
@@ -363,14 +343,9 @@ void SequencerComponent::setNumMeasures(int measures)
 
 		if (numMeasures < oldNumMeasures)
 		{
-			int maxSteps = getTotalStepsForCurrentSignature();
 			for (int m = numMeasures; m < oldNumMeasures; ++m)
 			{
-				for (int s = 0; s < maxSteps; ++s)
-				{
-					track->sequencerData.steps[m][s] = false;
-					track->sequencerData.velocities[m][s] = 0.8f;
-				}
+				track->sequencerData.pattern.clearMeasure(m);
 			}
 		}
 	}
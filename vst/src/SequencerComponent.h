@@ -1,5 +1,6 @@
 #pragma once
 #include "JuceHeader.h"
+#include "SequencerPattern.h"
 
 class DjIaVstProcessor;
 
@@ -25,8 +26,8 @@ private:
 	juce::String trackId;
 	DjIaVstProcessor &audioProcessor;
 
-	static const int MAX_STEPS_PER_MEASURE = 16;
-	static const int MAX_MEASURES = 4;
+	static const int MAX_STEPS_PER_MEASURE = SequencerPattern::maxStepsPerMeasure;
+	static const int MAX_MEASURES = SequencerPattern::maxMeasures;
 
 	bool isEditing = false;
 
@@ -0,0 +1,230 @@
+#pragma once
+#include <JuceHeader.h>
+
+#if JUCE_MSVC
+#include <intrin.h>
+#endif
+
+class SequencerPattern
+{
+public:
+	static constexpr int maxStepsPerMeasure = 64;
+	static constexpr int maxMeasures = 16;
+
+	static constexpr float defaultVelocity = 0.8f;
+	static constexpr float defaultProbability = 1.0f;
+
+	SequencerPattern()
+	{
+		clear();
+	}
+
+	static int stepsPerMeasureFor(int numerator, int denominator)
+	{
+		int stepsPerBeat = 4;
+		if (denominator == 8)
+			stepsPerBeat = 2;
+		else if (denominator == 2)
+			stepsPerBeat = 8;
+		return juce::jlimit(1, maxStepsPerMeasure, numerator * stepsPerBeat);
+	}
+
+	void clear()
+	{
+		for (int m = 0; m < maxMeasures; ++m)
+			clearMeasure(m);
+	}
+
+	void clearMeasure(int measure)
+	{
+		if (!isValid(measure, 0))
+			return;
+		activeSteps[measure] = 0;
+		for (int s = 0; s < maxStepsPerMeasure; ++s)
+			stepData[measure][s] = defaultStepData();
+	}
+
+	bool isActive(int measure, int step) const
+	{
+		if (!isValid(measure, step))
+			return false;
+		return (activeSteps[measure] >> step) & 1ULL;
+	}
+
+	void setActive(int measure, int step, bool active)
+	{
+		if (!isValid(measure, step))
+			return;
+		if (active)
+			activeSteps[measure] |= (1ULL << step);
+		else
+			activeSteps[measure] &= ~(1ULL << step);
+	}
+
+	void toggle(int measure, int step)
+	{
+		setActive(measure, step, !isActive(measure, step));
+	}
+
+	bool hasAnyActiveStep() const
+	{
+		juce::uint64 any = 0;
+		for (int m = 0; m < maxMeasures; ++m)
+			any |= activeSteps[m];
+		return any != 0;
+	}
+
+	float getVelocity(int measure, int step) const { return unpackUnit(measure, step, velocityShift); }
+	float getProbability(int measure, int step) const { return unpackUnit(measure, step, probabilityShift); }
+
+	float getMicroTiming(int measure, int step) const
+	{
+		if (!isValid(measure, step))
+			return 0.0f;
+		auto raw = (juce::int8)((stepData[measure][step] >> microTimingShift) & 0xff);
+		return raw / (2.0f * 127.0f);
+	}
+
+	void setVelocity(int measure, int step, float velocity) { packUnit(measure, step, velocityShift, velocity); }
+	void setProbability(int measure, int step, float probability) { packUnit(measure, step, probabilityShift, probability); }
+
+	void setMicroTiming(int measure, int step, float fractionOfStep)
+	{
+		if (!isValid(measure, step))
+			return;
+		auto raw = (juce::int8)juce::roundToInt(juce::jlimit(-0.5f, 0.5f, fractionOfStep) * 2.0f * 127.0f);
+		auto &data = stepData[measure][step];
+		data = (data & ~(0xffu << microTimingShift)) | ((juce::uint32)(juce::uint8)raw << microTimingShift);
+	}
+
+	int stepsUntilNextActive(int measure, int step, int stepsPerMeasure, int numMeasures) const
+	{
+		stepsPerMeasure = juce::jlimit(1, maxStepsPerMeasure, stepsPerMeasure);
+		numMeasures = juce::jlimit(1, maxMeasures, numMeasures);
+		measure = juce::jlimit(0, numMeasures - 1, measure);
+		step = juce::jlimit(0, stepsPerMeasure - 1, step);
+
+		const juce::uint64 measureMask = stepsPerMeasure >= 64 ? ~0ULL : ((1ULL << stepsPerMeasure) - 1);
+		const juce::uint64 afterStep = step >= 63 ? 0ULL : (~0ULL << (step + 1));
+
+		juce::uint64 bits = activeSteps[measure] & measureMask & afterStep;
+		if (bits != 0)
+			return findFirstSetBit(bits) - step;
+
+		for (int k = 1; k <= numMeasures; ++k)
+		{
+			bits = activeSteps[(measure + k) % numMeasures] & measureMask;
+			if (bits != 0)
+				return k * stepsPerMeasure - step + findFirstSetBit(bits);
+		}
+		return -1;
+	}
+
+	void writeTo(juce::OutputStream &stream) const
+	{
+		int usedMeasures = 0;
+		for (int m = 0; m < maxMeasures; ++m)
+		{
+			if (activeSteps[m] != 0)
+				usedMeasures = m + 1;
+		}
+
+		stream.writeByte((char)formatVersion);
+		stream.writeByte((char)usedMeasures);
+		for (int m = 0; m < usedMeasures; ++m)
+		{
+			stream.writeInt64((juce::int64)activeSteps[m]);
+			for (int s = 0; s < maxStepsPerMeasure; ++s)
+			{
+				if ((activeSteps[m] >> s) & 1ULL)
+					stream.writeInt((int)stepData[m][s]);
+			}
+		}
+	}
+
+	bool readFrom(juce::InputStream &stream)
+	{
+		if (stream.getNumBytesRemaining() < 2 || (juce::uint8)stream.readByte() != formatVersion)
+			return false;
+
+		int usedMeasures = (juce::uint8)stream.readByte();
+		if (usedMeasures > maxMeasures)
+			return false;
+
+		clear();
+		for (int m = 0; m < usedMeasures && !stream.isExhausted(); ++m)
+		{
+			activeSteps[m] = (juce::uint64)stream.readInt64();
+			for (int s = 0; s < maxStepsPerMeasure; ++s)
+			{
+				if ((activeSteps[m] >> s) & 1ULL)
+					stepData[m][s] = (juce::uint32)stream.readInt();
+			}
+		}
+		return true;
+	}
+
+	juce::String toBase64() const
+	{
+		juce::MemoryOutputStream stream;
+		writeTo(stream);
+		return stream.getMemoryBlock().toBase64Encoding();
+	}
+
+	bool fromBase64(const juce::String &encoded)
+	{
+		juce::MemoryBlock block;
+		if (!block.fromBase64Encoding(encoded))
+			return false;
+
+		juce::MemoryInputStream stream(block, false);
+		return readFrom(stream);
+	}
+
+private:
+	static constexpr juce::uint8 formatVersion = 1;
+	static constexpr int velocityShift = 0;
+	static constexpr int probabilityShift = 8;
+	static constexpr int microTimingShift = 16;
+
+	juce::uint64 activeSteps[maxMeasures];
+	juce::uint32 stepData[maxMeasures][maxStepsPerMeasure];
+
+	static bool isValid(int measure, int step)
+	{
+		return measure >= 0 && measure < maxMeasures && step >= 0 && step < maxStepsPerMeasure;
+	}
+
+	static juce::uint32 defaultStepData()
+	{
+		return ((juce::uint32)juce::roundToInt(defaultVelocity * 255.0f) << velocityShift) |
+			   ((juce::uint32)juce::roundToInt(defaultProbability * 255.0f) << probabilityShift);
+	}
+
+	float unpackUnit(int measure, int step, int shift) const
+	{
+		if (!isValid(measure, step))
+			return 0.0f;
+		return ((stepData[measure][step] >> shift) & 0xff) / 255.0f;
+	}
+
+	void packUnit(int measure, int step, int shift, float value)
+	{
+		if (!isValid(measure, step))
+			return;
+		auto raw = (juce::uint32)juce::roundToInt(juce::jlimit(0.0f, 1.0f, value) * 255.0f);
+		auto &data = stepData[measure][step];
+		data = (data & ~(0xffu << shift)) | (raw << shift);
+	}
+
+	static int findFirstSetBit(juce::uint64 bits)
+	{
+#if JUCE_MSVC
+		unsigned long index = 0;
+		_BitScanForward64(&index, bits);
+		return (int)index;
+#else
+		return __builtin_ctzll(bits);
+#endif
+	}
+};
@@ -0,0 +1,208 @@
+#include "SessionBundle.h"
+#include "BinaryState.h"
+
+bool SessionBundle::write(const juce::File &destination, const juce::MemoryBlock &state, const std::vector<AudioSource> &sources)
+{
+	juce::AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+
+	std::vector<AudioRegion> regions;
+	std::vector<std::unique_ptr<juce::AudioFormatReader>> readers;
+	for (const auto &source : sources)
+	{
+		if (!source.file.existsAsFile())
+			continue;
+
+		std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(source.file));
+		if (reader == nullptr || reader->lengthInSamples <= 0 || reader->lengthInSamples > std::numeric_limits<int>::max())
+		{
+			DBG("Skipping unreadable bundle audio: " << source.file.getFullPathName());
+			continue;
+		}
+
+		AudioRegion region;
+		region.trackId = source.trackId;
+		region.pageIndex = source.pageIndex;
+		region.isOriginal = source.isOriginal;
+		region.numChannels = juce::jlimit(1, 2, (int)reader->numChannels);
+		region.numFrames = reader->lengthInSamples;
+		region.sampleRate = reader->sampleRate;
+		region.channelStride = alignUp(region.numFrames * (juce::int64)sizeof(float));
+		regions.push_back(region);
+		readers.push_back(std::move(reader));
+	}
+
+	juce::MemoryOutputStream table;
+	writeRegionTable(table, regions);
+
+	const juce::int64 stateOffset = 28 + (juce::int64)table.getDataSize();
+	juce::int64 cursor = alignUp(stateOffset + (juce::int64)state.getSize());
+	for (auto &region : regions)
+	{
+		region.offset = cursor;
+		cursor += region.channelStride * region.numChannels;
+	}
+
+	table.reset();
+	writeRegionTable(table, regions);
+
+	juce::TemporaryFile tempFile(destination);
+	{
+		juce::FileOutputStream stream(tempFile.getFile());
+		if (!stream.openedOk())
+			return false;
+
+		stream.writeInt(magic);
+		stream.writeInt(formatVersion);
+		stream.writeInt64(stateOffset);
+		stream.writeInt64((juce::int64)state.getSize());
+		stream.writeInt((int)regions.size());
+		stream.write(table.getData(), table.getDataSize());
+		stream.write(state.getData(), state.getSize());
+
+		for (size_t i = 0; i < regions.size(); ++i)
+		{
+			const auto &region = regions[i];
+			const int numFrames = (int)region.numFrames;
+			juce::AudioBuffer<float> audio(region.numChannels, numFrames);
+			readers[i]->read(&audio, 0, numFrames, 0, true, region.numChannels > 1);
+			readers[i].reset();
+
+			for (int ch = 0; ch < region.numChannels; ++ch)
+			{
+				stream.writeRepeatedByte(0, (size_t)(region.offset + region.channelStride * ch - stream.getPosition()));
+				stream.write(audio.getReadPointer(ch), (size_t)numFrames * sizeof(float));
+			}
+		}
+
+		stream.flush();
+		if (stream.getStatus().failed())
+			return false;
+	}
+
+	return tempFile.overwriteTargetFileWithTemporary();
+}
+
+void SessionBundle::writeRegionTable(juce::OutputStream &stream, const std::vector<AudioRegion> &regions)
+{
+	for (const auto &region : regions)
+	{
+		BinaryState::writeString(stream, region.trackId);
+		stream.writeCompressedInt(region.pageIndex);
+		stream.writeBool(region.isOriginal);
+		stream.writeInt(region.numChannels);
+		stream.writeInt64(region.numFrames);
+		stream.writeDouble(region.sampleRate);
+		stream.writeInt64(region.offset);
+		stream.writeInt64(region.channelStride);
+	}
+}
+
+std::shared_ptr<SessionBundle> SessionBundle::open(const juce::File &source)
+{
+	std::shared_ptr<SessionBundle> bundle(new SessionBundle());
+	bundle->mappedFile = std::make_unique<juce::MemoryMappedFile>(source, juce::MemoryMappedFile::readOnly, false);
+
+	const auto *data = static_cast<const char *>(bundle->mappedFile->getData());
+	const auto size = (juce::int64)bundle->mappedFile->getSize();
+	if (data == nullptr || size < 28)
+		return nullptr;
+
+	juce::MemoryInputStream stream(data, (size_t)size, false);
+	if (stream.readInt() != magic || stream.readInt() != formatVersion)
+		return nullptr;
+
+	const juce::int64 stateOffset = stream.readInt64();
+	bundle->stateSize = stream.readInt64();
+	const int numRegions = stream.readInt();
+	if (stateOffset < 28 || bundle->stateSize < 0 || stateOffset + bundle->stateSize > size || numRegions < 0)
+		return nullptr;
+
+	for (int i = 0; i < numRegions; ++i)
+	{
+		AudioRegion region;
+		region.trackId = BinaryState::readString(stream);
+		region.pageIndex = stream.readCompressedInt();
+		region.isOriginal = stream.readBool();
+		region.numChannels = stream.readInt();
+		region.numFrames = stream.readInt64();
+		region.sampleRate = stream.readDouble();
+		region.offset = stream.readInt64();
+		region.channelStride = stream.readInt64();
+
+		const bool valid = region.numChannels >= 1 && region.numChannels <= 2 && region.numFrames > 0 &&
+						   region.numFrames <= std::numeric_limits<int>::max() && region.sampleRate > 0.0 &&
+						   region.channelStride >= region.numFrames * (juce::int64)sizeof(float) &&
+						   region.offset % alignment == 0 && region.channelStride % alignment == 0 &&
+						   region.offset + region.channelStride * region.numChannels <= size;
+		if (!valid || stream.isExhausted())
+		{
+			DBG("Corrupt session bundle region table: " << source.getFullPathName());
+			return nullptr;
+		}
+		bundle->regions.push_back(region);
+	}
+
+	bundle->mappedData = data;
+	bundle->stateData = data + stateOffset;
+	return bundle;
+}
+
+juce::String SessionBundle::audioFileName(const juce::String &trackId, int pageIndex, bool isOriginal)
+{
+	juce::String name = trackId;
+	if (pageIndex >= 0)
+		name << "_" << juce::String::charToString((juce::juce_wchar)('A' + pageIndex));
+	if (isOriginal)
+		name << "_original";
+	return name + ".wav";
+}
+
+const SessionBundle::AudioRegion *SessionBundle::findRegion(const juce::String &trackId, int pageIndex, bool isOriginal) const
+{
+	for (const auto &region : regions)
+	{
+		if (region.trackId == trackId && region.pageIndex == pageIndex && region.isOriginal == isOriginal)
+			return &region;
+	}
+	return nullptr;
+}
+
+juce::File SessionBundle::extractAudio(const juce::String &trackId, int pageIndex, bool isOriginal, const juce::File &directory) const
+{
+	const auto *region = findRegion(trackId, pageIndex, isOriginal);
+	if (region == nullptr || directory.createDirectory().failed())
+		return {};
+
+	const int numFrames = (int)region->numFrames;
+	const float *channels[2];
+	for (int ch = 0; ch < region->numChannels; ++ch)
+		channels[ch] = reinterpret_cast<const float *>(mappedData + region->offset + region->channelStride * ch);
+
+	const auto destination = directory.getChildFile(audioFileName(trackId, pageIndex, isOriginal));
+	juce::TemporaryFile tempFile(destination);
+	{
+		auto *fileStream = new juce::FileOutputStream(tempFile.getFile());
+		if (!fileStream->openedOk())
+		{
+			delete fileStream;
+			return {};
+		}
+
+		juce::WavAudioFormat wavFormat;
+		std::unique_ptr<juce::AudioFormatWriter> writer(
+			wavFormat.createWriterFor(fileStream, region->sampleRate, (unsigned int)region->numChannels, 32, {}, 0));
+		if (writer == nullptr)
+		{
+			delete fileStream;
+			return {};
+		}
+
+		if (!writer->writeFromFloatArrays(channels, region->numChannels, numFrames))
+			return {};
+	}
+
+	if (!tempFile.overwriteTargetFileWithTemporary())
+		return {};
+	return destination;
+}
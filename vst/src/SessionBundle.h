@@ -0,0 +1,62 @@
+#pragma once
+#include "JuceHeader.h"
+#include <memory>
+#include <vector>
+
+class SessionBundle
+{
+public:
+	static constexpr const char *fileExtension = ".djiabundle";
+
+	// Audio is keyed by track and page, never by the saving machine's paths
+	struct AudioSource
+	{
+		juce::String trackId;
+		int pageIndex = -1;
+		bool isOriginal = false;
+		juce::File file;
+	};
+
+	static bool write(const juce::File &destination, const juce::MemoryBlock &state, const std::vector<AudioSource> &sources);
+	static std::shared_ptr<SessionBundle> open(const juce::File &source);
+
+	// trackId[_<page>][_original].wav, the names the audio cache already uses
+	static juce::String audioFileName(const juce::String &trackId, int pageIndex, bool isOriginal);
+
+	const void *getStateData() const { return stateData; }
+	int getStateSize() const { return (int)stateSize; }
+
+	// Writes the region to directory/audioFileName(...); returns an empty File if the bundle has no such audio
+	juce::File extractAudio(const juce::String &trackId, int pageIndex, bool isOriginal, const juce::File &directory) const;
+
+private:
+	static constexpr int magic = 0x4253424f;
+	static constexpr int formatVersion = 2;
+	static constexpr juce::int64 alignment = 64;
+
+	struct AudioRegion
+	{
+		juce::String trackId;
+		int pageIndex = -1;
+		bool isOriginal = false;
+		int numChannels = 0;
+		juce::int64 numFrames = 0;
+		double sampleRate = 0.0;
+		juce::int64 offset = 0;
+		juce::int64 channelStride = 0;
+	};
+
+	SessionBundle() = default;
+	const AudioRegion *findRegion(const juce::String &trackId, int pageIndex, bool isOriginal) const;
+
+	static juce::int64 alignUp(juce::int64 value) { return (value + alignment - 1) & ~(alignment - 1); }
+	static void writeRegionTable(juce::OutputStream &stream, const std::vector<AudioRegion> &regions);
+
+	std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+	const char *mappedData = nullptr;
+	const void *stateData = nullptr;
+	juce::int64 stateSize = 0;
+	std::vector<AudioRegion> regions;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SessionBundle)
+};
@@ -0,0 +1,10 @@
+#pragma once
+#include "JuceHeader.h"
+
+#if JUCE_INTEL
+#include <emmintrin.h>
+#define SIMD_USE_SSE 1
+#elif JUCE_ARM && (defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define SIMD_USE_NEON 1
+#endif
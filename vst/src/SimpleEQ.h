@@ -1,5 +1,6 @@
 #pragma once
 #include "JuceHeader.h"
+#include "StereoBiquad.h"
 
 class SimpleEQ
 {
@@ -9,47 +10,67 @@ public:
 	void prepare(double newSampleRate, int /*samplesPerBlock*/)
 	{
 		sampleRate = newSampleRate;
-		for (int ch = 0; ch < 2; ++ch)
-		{
-			highFilters[ch].setCoefficients(
-				juce::IIRCoefficients::makeHighShelf(sampleRate, 8000.0, 0.7, 1.0));
-			midFilters[ch].setCoefficients(
-				juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 1.0, 1.0));
-			lowFilters[ch].setCoefficients(
-				juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7, 1.0));
-		}
+		coefficientRampLength = juce::jmax(1, (int)(sampleRate * coefficientRampSeconds));
+		outputGain.reset(sampleRate, outputRampSeconds);
+		outputPan.reset(sampleRate, outputRampSeconds);
+		outputGain.setCurrentAndTargetValue(outputGain.getTargetValue());
+		outputPan.setCurrentAndTargetValue(outputPan.getTargetValue());
+
+		updateTargetCoefficients(lowStage, juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7, juce::Decibels::decibelsToGain(lowGain)));
+		updateTargetCoefficients(midStage, juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 1.0, juce::Decibels::decibelsToGain(midGain)));
+		updateTargetCoefficients(highStage, juce::IIRCoefficients::makeHighShelf(sampleRate, 8000.0, 0.7, juce::Decibels::decibelsToGain(highGain)));
+		for (auto *stage : {&lowStage, &midStage, &highStage})
+			stage->snapToTarget();
+		reset();
 	}
 
 	void processBlock(juce::AudioBuffer<float> &buffer)
 	{
-		if (bypass)
-			return;
-
 		const int numChannels = std::min(2, buffer.getNumChannels());
 		const int numSamples = buffer.getNumSamples();
+		if (numChannels == 0)
+			return;
+
+		juce::ScopedNoDenormals noDenormals;
+
+		float *left = buffer.getWritePointer(0);
+		float *right = numChannels > 1 ? buffer.getWritePointer(1) : nullptr;
+		const bool runFilters = !bypass;
 
-		for (int ch = 0; ch < numChannels; ++ch)
+		for (int i = 0; i < numSamples; ++i)
 		{
-			auto *channelData = buffer.getWritePointer(ch);
-			lowFilters[ch].processSamples(channelData, numSamples);
-			midFilters[ch].processSamples(channelData, numSamples);
-			highFilters[ch].processSamples(channelData, numSamples);
+			StereoSample x = StereoSample::load(left[i], right != nullptr ? right[i] : left[i]);
+
+			if (runFilters)
+			{
+				x = lowStage.process(x);
+				x = midStage.process(x);
+				x = highStage.process(x);
+			}
+
+			const float gain = outputGain.getNextValue();
+			const float pan = outputPan.getNextValue();
+			const float leftGain = pan > 0.0f ? gain * (1.0f - pan) : gain;
+			const float rightGain = pan < 0.0f ? gain * (1.0f + pan) : gain;
+			x = x * StereoSample::load(leftGain, rightGain);
+
+			left[i] = x.left();
+			if (right != nullptr)
+				right[i] = x.right();
 		}
 	}
 
+	void setOutputGain(float gain) { outputGain.setTargetValue(gain); }
+	void setOutputPan(float pan) { outputPan.setTargetValue(juce::jlimit(-1.0f, 1.0f, pan)); }
+
 	void setHighGain(float gainDb)
 	{
 		if (std::abs(gainDb - highGain) < 0.1f)
 			return;
 
 		highGain = gainDb;
-		float linearGain = juce::Decibels::decibelsToGain(gainDb);
-
-		for (int ch = 0; ch < 2; ++ch)
-		{
-			highFilters[ch].setCoefficients(
-				juce::IIRCoefficients::makeHighShelf(sampleRate, 8000.0, 0.7, linearGain));
-		}
+		updateTargetCoefficients(highStage,
+								 juce::IIRCoefficients::makeHighShelf(sampleRate, 8000.0, 0.7, juce::Decibels::decibelsToGain(gainDb)));
 	}
 
 	void setMidGain(float gainDb)
@@ -58,13 +79,8 @@ public:
 			return;
 
 		midGain = gainDb;
-		float linearGain = juce::Decibels::decibelsToGain(gainDb);
-
-		for (int ch = 0; ch < 2; ++ch)
-		{
-			midFilters[ch].setCoefficients(
-				juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 1.0, linearGain));
-		}
+		updateTargetCoefficients(midStage,
+								 juce::IIRCoefficients::makePeakFilter(sampleRate, 1000.0, 1.0, juce::Decibels::decibelsToGain(gainDb)));
 	}
 
 	void setLowGain(float gainDb)
@@ -73,34 +89,40 @@ public:
 			return;
 
 		lowGain = gainDb;
-		float linearGain = juce::Decibels::decibelsToGain(gainDb);
-
-		for (int ch = 0; ch < 2; ++ch)
-		{
-			lowFilters[ch].setCoefficients(
-				juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7, linearGain));
-		}
+		updateTargetCoefficients(lowStage,
+								 juce::IIRCoefficients::makeLowShelf(sampleRate, 200.0, 0.7, juce::Decibels::decibelsToGain(gainDb)));
 	}
 
 	float getHighGain() const { return highGain; }
 	float getMidGain() const { return midGain; }
 	float getLowGain() const { return lowGain; }
 
+	bool isRamping() const
+	{
+		return lowStage.isRamping() || midStage.isRamping() || highStage.isRamping() ||
+			   outputGain.isSmoothing() || outputPan.isSmoothing();
+	}
+
 	void setBypass(bool shouldBypass) { bypass = shouldBypass; }
 	bool isBypassed() const { return bypass; }
 
 	void reset()
 	{
-		for (int ch = 0; ch < 2; ++ch)
-		{
-			highFilters[ch].reset();
-			midFilters[ch].reset();
-			lowFilters[ch].reset();
-		}
+		for (auto *stage : {&lowStage, &midStage, &highStage})
+			stage->reset();
 	}
 
 private:
+	void updateTargetCoefficients(StereoBiquad &stage, const juce::IIRCoefficients &coefficients)
+	{
+		stage.setTarget(coefficients, coefficientRampLength);
+	}
+
+	static constexpr double coefficientRampSeconds = 0.01;
+	static constexpr double outputRampSeconds = 0.02;
+
 	double sampleRate = 48000.0;
+	int coefficientRampLength = 480;
 
 	float highGain = 0.0f;
 	float midGain = 0.0f;
@@ -108,7 +130,10 @@ private:
 
 	bool bypass = false;
 
-	juce::IIRFilter highFilters[2];
-	juce::IIRFilter midFilters[2];
-	juce::IIRFilter lowFilters[2];
-};
\ No newline at end of file
+	StereoBiquad lowStage;
+	StereoBiquad midStage;
+	StereoBiquad highStage;
+
+	juce::SmoothedValue<float> outputGain{1.0f};
+	juce::SmoothedValue<float> outputPan{0.0f};
+};
@@ -0,0 +1,169 @@
+#include "SpectrumAnalyzer.h"
+
+SpectrumAnalyzer::SpectrumAnalyzer() : juce::Thread("Spectrum Analyzer")
+{
+	fftData.resize(fftSize);
+	fifoBuffer.clear();
+	history.clear();
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+	stopThread(1000);
+}
+
+void SpectrumAnalyzer::prepare(double sampleRate)
+{
+	stopThread(1000);
+	analysisSampleRate.store(sampleRate);
+	fifo.reset();
+	history.clear();
+	historyPosition = 0;
+	hasNewData = false;
+	startThread(juce::Thread::Priority::low);
+}
+
+void SpectrumAnalyzer::release()
+{
+	stopThread(1000);
+}
+
+void SpectrumAnalyzer::pushBlock(const juce::AudioBuffer<float> &master, const juce::AudioBuffer<float> *selectedTrack, int numSamples)
+{
+	if (!active.load(std::memory_order_relaxed) || master.getNumChannels() == 0)
+		return;
+
+	numSamples = std::min(numSamples, fifo.getFreeSpace());
+	if (numSamples <= 0)
+		return;
+
+	const float *sources[numFifoChannels] = {
+		master.getReadPointer(0),
+		master.getReadPointer(std::min(1, master.getNumChannels() - 1)),
+		selectedTrack != nullptr && selectedTrack->getNumChannels() > 0 ? selectedTrack->getReadPointer(0) : nullptr,
+		selectedTrack != nullptr && selectedTrack->getNumChannels() > 1 ? selectedTrack->getReadPointer(1) : nullptr};
+	if (selectedTrack != nullptr && selectedTrack->getNumSamples() < numSamples)
+		sources[2] = sources[3] = nullptr;
+
+	int start1, size1, start2, size2;
+	fifo.prepareToWrite(numSamples, start1, size1, start2, size2);
+	for (int ch = 0; ch < numFifoChannels; ++ch)
+	{
+		float *destination = fifoBuffer.getWritePointer(ch);
+		if (sources[ch] == nullptr)
+		{
+			juce::FloatVectorOperations::clear(destination + start1, size1);
+			juce::FloatVectorOperations::clear(destination + start2, size2);
+			continue;
+		}
+		juce::FloatVectorOperations::copy(destination + start1, sources[ch], size1);
+		juce::FloatVectorOperations::copy(destination + start2, sources[ch] + size1, size2);
+	}
+	fifo.finishedWrite(size1 + size2);
+}
+
+bool SpectrumAnalyzer::getBands(Source source, std::array<float, numBands> &bands, float &correlation) const
+{
+	juce::ScopedLock lock(resultsLock);
+	if (!hasResults)
+		return false;
+
+	bands = publishedBands[(int)source];
+	correlation = publishedCorrelation[(int)source];
+	return true;
+}
+
+float SpectrumAnalyzer::bandFrequency(int band)
+{
+	return 20.0f * std::pow(1000.0f, (float)band / (float)numBands);
+}
+
+void SpectrumAnalyzer::run()
+{
+	while (!threadShouldExit())
+	{
+		drainFifo();
+
+		if (hasNewData && active.load())
+		{
+			analyse((int)Source::Master);
+			analyse((int)Source::SelectedTrack);
+			hasNewData = false;
+
+			juce::ScopedLock lock(resultsLock);
+			for (int source = 0; source < 2; ++source)
+			{
+				publishedBands[source] = workingBands[source];
+				publishedCorrelation[source] = workingCorrelation[source];
+			}
+			hasResults = true;
+		}
+
+		wait(1000 / analysisRateHz);
+	}
+}
+
+void SpectrumAnalyzer::drainFifo()
+{
+	const int numReady = fifo.getNumReady();
+	if (numReady <= 0)
+		return;
+
+	int start1, size1, start2, size2;
+	fifo.prepareToRead(numReady, start1, size1, start2, size2);
+	for (auto [start, size] : {std::make_pair(start1, size1), std::make_pair(start2, size2)})
+	{
+		int copied = 0;
+		while (copied < size)
+		{
+			const int chunk = std::min(size - copied, fftSize - historyPosition);
+			for (int ch = 0; ch < numFifoChannels; ++ch)
+				history.copyFrom(ch, historyPosition, fifoBuffer, ch, start + copied, chunk);
+			historyPosition = (historyPosition + chunk) % fftSize;
+			copied += chunk;
+		}
+	}
+	fifo.finishedRead(size1 + size2);
+	hasNewData = true;
+}
+
+void SpectrumAnalyzer::analyse(int source)
+{
+	const float *left = history.getReadPointer(source * 2);
+	const float *right = history.getReadPointer(source * 2 + 1);
+
+	double sumLeft = 0.0, sumRight = 0.0, sumCross = 0.0;
+	for (int i = 0; i < fftSize; ++i)
+	{
+		const int index = (historyPosition + i) % fftSize;
+		const float l = left[index];
+		const float r = right[index];
+		sumLeft += l * l;
+		sumRight += r * r;
+		sumCross += l * r;
+		fftData[(size_t)i] = {0.5f * (l + r) * fft.windowAt(i), 0.0f};
+	}
+
+	fft.perform(fftData.data());
+
+	const double sampleRate = analysisSampleRate.load();
+	const float amplitudeScale = 4.0f / (float)fftSize;
+	auto &bands = workingBands[source];
+	for (int band = 0; band < numBands; ++band)
+	{
+		const int lowBin = juce::jlimit(1, fftSize / 2 - 1, (int)(bandFrequency(band) * fftSize / sampleRate));
+		const int highBin = juce::jlimit(lowBin, fftSize / 2 - 1, (int)(bandFrequency(band + 1) * fftSize / sampleRate));
+
+		float magnitude = 0.0f;
+		for (int bin = lowBin; bin <= highBin; ++bin)
+			magnitude = std::max(magnitude, std::abs(fftData[(size_t)bin]));
+
+		const float decibels = juce::Decibels::gainToDecibels(magnitude * amplitudeScale, minDecibels);
+		const float level = juce::jlimit(0.0f, 1.0f, juce::jmap(decibels, minDecibels, 0.0f, 0.0f, 1.0f));
+		bands[(size_t)band] = level > bands[(size_t)band] ? level : bands[(size_t)band] * 0.85f + level * 0.15f;
+	}
+
+	const double denominator = std::sqrt(sumLeft * sumRight);
+	const float correlation = denominator > 1.0e-12 ? (float)(sumCross / denominator) : 0.0f;
+	workingCorrelation[source] = workingCorrelation[source] * 0.7f + correlation * 0.3f;
+}
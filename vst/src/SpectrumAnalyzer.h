@@ -0,0 +1,68 @@
+#pragma once
+#include "JuceHeader.h"
+#include "RadixFFT.h"
+#include <array>
+#include <complex>
+
+class SpectrumAnalyzer : private juce::Thread
+{
+public:
+	enum class Source
+	{
+		Master = 0,
+		SelectedTrack = 1
+	};
+
+	static constexpr int numBands = 96;
+	static constexpr int fftOrder = 11;
+	static constexpr int fftSize = 1 << fftOrder;
+
+	SpectrumAnalyzer();
+	~SpectrumAnalyzer() override;
+
+	void prepare(double sampleRate);
+	void release();
+
+	void pushBlock(const juce::AudioBuffer<float> &master, const juce::AudioBuffer<float> *selectedTrack, int numSamples);
+
+	void setActive(bool shouldBeActive) { active.store(shouldBeActive); }
+	bool isActive() const { return active.load(); }
+	void setSelectedTrackSlot(int slot) { selectedTrackSlot.store(slot); }
+	int getSelectedTrackSlot() const { return selectedTrackSlot.load(); }
+
+	bool getBands(Source source, std::array<float, numBands> &bands, float &correlation) const;
+	static float bandFrequency(int band);
+
+private:
+	void run() override;
+	void drainFifo();
+	void analyse(int source);
+
+	static constexpr int numFifoChannels = 4;
+	static constexpr int fifoCapacity = 16384;
+	static constexpr int analysisRateHz = 30;
+	static constexpr float minDecibels = -90.0f;
+
+	juce::AbstractFifo fifo{fifoCapacity};
+	juce::AudioBuffer<float> fifoBuffer{numFifoChannels, fifoCapacity};
+
+	std::atomic<bool> active{false};
+	std::atomic<int> selectedTrackSlot{-1};
+	std::atomic<double> analysisSampleRate{48000.0};
+
+	juce::AudioBuffer<float> history{numFifoChannels, fftSize};
+	int historyPosition = 0;
+	bool hasNewData = false;
+
+	RadixFFT fft{fftOrder};
+	std::vector<std::complex<float>> fftData;
+	std::array<float, numBands> workingBands[2] = {};
+	float workingCorrelation[2] = {};
+
+	mutable juce::CriticalSection resultsLock;
+	std::array<float, numBands> publishedBands[2] = {};
+	float publishedCorrelation[2] = {};
+	bool hasResults = false;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
+};
@@ -0,0 +1,90 @@
+#include "SpectrumDisplay.h"
+#include "ColourPalette.h"
+#include "PluginProcessor.h"
+
+SpectrumDisplay::SpectrumDisplay(DjIaVstProcessor &processor) : audioProcessor(processor)
+{
+	audioProcessor.getSpectrumAnalyzer().setActive(true);
+	startTimerHz(30);
+}
+
+SpectrumDisplay::~SpectrumDisplay()
+{
+	stopTimer();
+	audioProcessor.getSpectrumAnalyzer().setActive(false);
+}
+
+void SpectrumDisplay::timerCallback()
+{
+	auto &analyzer = audioProcessor.getSpectrumAnalyzer();
+
+	int slot = -1;
+	if (auto *track = audioProcessor.getCurrentTrack())
+		slot = track->slotIndex;
+	analyzer.setSelectedTrackSlot(slot);
+
+	bool updated = analyzer.getBands(SpectrumAnalyzer::Source::Master, masterBands, masterCorrelation);
+	updated |= analyzer.getBands(SpectrumAnalyzer::Source::SelectedTrack, trackBands, trackCorrelation);
+	if (updated)
+		repaint();
+}
+
+void SpectrumDisplay::paint(juce::Graphics &g)
+{
+	auto bounds = getLocalBounds().toFloat();
+	g.setColour(ColourPalette::backgroundDeep);
+	g.fillRoundedRectangle(bounds, 4.0f);
+
+	auto content = bounds.reduced(4.0f);
+	auto masterArea = content.removeFromTop(content.getHeight() * 0.5f);
+
+	drawCorrelation(g, masterArea.removeFromBottom(14.0f), masterCorrelation);
+	drawSpectrum(g, masterArea.reduced(0.0f, 2.0f), masterBands, ColourPalette::emerald, "MASTER");
+
+	drawCorrelation(g, content.removeFromBottom(14.0f), trackCorrelation);
+	drawSpectrum(g, content.reduced(0.0f, 2.0f), trackBands, ColourPalette::violet, "TRACK");
+}
+
+void SpectrumDisplay::drawSpectrum(juce::Graphics &g, juce::Rectangle<float> area,
+								   const std::array<float, SpectrumAnalyzer::numBands> &bands,
+								   juce::Colour colour, const juce::String &title) const
+{
+	g.setColour(ColourPalette::backgroundDark);
+	g.fillRect(area);
+
+	juce::Path spectrum;
+	spectrum.startNewSubPath(area.getX(), area.getBottom());
+	for (int band = 0; band < SpectrumAnalyzer::numBands; ++band)
+	{
+		float x = area.getX() + area.getWidth() * (band + 0.5f) / SpectrumAnalyzer::numBands;
+		float y = area.getBottom() - bands[(size_t)band] * area.getHeight();
+		spectrum.lineTo(x, y);
+	}
+	spectrum.lineTo(area.getRight(), area.getBottom());
+	spectrum.closeSubPath();
+
+	g.setColour(colour.withAlpha(0.35f));
+	g.fillPath(spectrum);
+	g.setColour(colour);
+	g.strokePath(spectrum, juce::PathStrokeType(1.0f));
+
+	g.setColour(ColourPalette::textSecondary);
+	g.setFont(juce::FontOptions(9.0f));
+	g.drawText(title, area.reduced(3.0f), juce::Justification::topLeft);
+}
+
+void SpectrumDisplay::drawCorrelation(juce::Graphics &g, juce::Rectangle<float> area, float correlation) const
+{
+	auto bar = area.reduced(0.0f, 3.0f);
+	g.setColour(ColourPalette::backgroundDark);
+	g.fillRect(bar);
+
+	float centre = bar.getCentreX();
+	float position = centre + juce::jlimit(-1.0f, 1.0f, correlation) * bar.getWidth() * 0.5f;
+	g.setColour(correlation < 0.0f ? ColourPalette::vuRed : ColourPalette::vuGreen);
+	g.fillRect(juce::Rectangle<float>::leftTopRightBottom(std::min(centre, position), bar.getY(),
+														  std::max(centre, position), bar.getBottom()));
+
+	g.setColour(ColourPalette::textSecondary);
+	g.drawVerticalLine((int)centre, bar.getY(), bar.getBottom());
+}
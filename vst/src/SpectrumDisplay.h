@@ -0,0 +1,29 @@
+#pragma once
+#include "JuceHeader.h"
+#include "SpectrumAnalyzer.h"
+
+class DjIaVstProcessor;
+
+class SpectrumDisplay : public juce::Component, public juce::Timer
+{
+public:
+	SpectrumDisplay(DjIaVstProcessor &processor);
+	~SpectrumDisplay() override;
+
+	void paint(juce::Graphics &g) override;
+
+private:
+	void timerCallback() override;
+	void drawSpectrum(juce::Graphics &g, juce::Rectangle<float> area, const std::array<float, SpectrumAnalyzer::numBands> &bands,
+					  juce::Colour colour, const juce::String &title) const;
+	void drawCorrelation(juce::Graphics &g, juce::Rectangle<float> area, float correlation) const;
+
+	DjIaVstProcessor &audioProcessor;
+
+	std::array<float, SpectrumAnalyzer::numBands> masterBands = {};
+	std::array<float, SpectrumAnalyzer::numBands> trackBands = {};
+	float masterCorrelation = 0.0f;
+	float trackCorrelation = 0.0f;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumDisplay)
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include "JuceHeader.h"
+#include "SimdConfig.h"
+
+struct StereoSample
+{
+#if SIMD_USE_SSE
+	__m128 v;
+	static StereoSample load(float l, float r) { return {_mm_setr_ps(l, r, 0.0f, 0.0f)}; }
+	static StereoSample broadcast(float c) { return {_mm_set1_ps(c)}; }
+	static StereoSample zero() { return {_mm_setzero_ps()}; }
+	StereoSample operator+(StereoSample o) const { return {_mm_add_ps(v, o.v)}; }
+	StereoSample operator-(StereoSample o) const { return {_mm_sub_ps(v, o.v)}; }
+	StereoSample operator*(StereoSample o) const { return {_mm_mul_ps(v, o.v)}; }
+	float left() const { return _mm_cvtss_f32(v); }
+	float right() const { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))); }
+#elif SIMD_USE_NEON
+	float32x2_t v;
+	static StereoSample load(float l, float r) { return {vset_lane_f32(r, vdup_n_f32(l), 1)}; }
+	static StereoSample broadcast(float c) { return {vdup_n_f32(c)}; }
+	static StereoSample zero() { return {vdup_n_f32(0.0f)}; }
+	StereoSample operator+(StereoSample o) const { return {vadd_f32(v, o.v)}; }
+	StereoSample operator-(StereoSample o) const { return {vsub_f32(v, o.v)}; }
+	StereoSample operator*(StereoSample o) const { return {vmul_f32(v, o.v)}; }
+	float left() const { return vget_lane_f32(v, 0); }
+	float right() const { return vget_lane_f32(v, 1); }
+#else
+	float l, r;
+	static StereoSample load(float left, float right) { return {left, right}; }
+	static StereoSample broadcast(float c) { return {c, c}; }
+	static StereoSample zero() { return {0.0f, 0.0f}; }
+	StereoSample operator+(StereoSample o) const { return {l + o.l, r + o.r}; }
+	StereoSample operator-(StereoSample o) const { return {l - o.l, r - o.r}; }
+	StereoSample operator*(StereoSample o) const { return {l * o.l, r * o.r}; }
+	float left() const { return l; }
+	float right() const { return r; }
+#endif
+};
+
+class StereoBiquad
+{
+public:
+	void setTarget(const juce::IIRCoefficients &coefficients, int rampLength)
+	{
+		rampLength = juce::jmax(1, rampLength);
+		for (int c = 0; c < 5; ++c)
+		{
+			target[c] = coefficients.coefficients[c];
+			step[c] = (target[c] - current[c]) / (float)rampLength;
+		}
+		rampRemaining = rampLength;
+	}
+
+	bool isRamping() const { return rampRemaining > 0; }
+
+	void snapToTarget()
+	{
+		std::copy(std::begin(target), std::end(target), std::begin(current));
+		rampRemaining = 0;
+	}
+
+	void reset()
+	{
+		s1 = StereoSample::zero();
+		s2 = StereoSample::zero();
+	}
+
+	StereoSample process(StereoSample x)
+	{
+		if (rampRemaining > 0)
+		{
+			for (int c = 0; c < 5; ++c)
+				current[c] += step[c];
+			if (--rampRemaining == 0)
+				std::copy(std::begin(target), std::end(target), std::begin(current));
+		}
+
+		const StereoSample y = StereoSample::broadcast(current[0]) * x + s1;
+		s1 = StereoSample::broadcast(current[1]) * x - StereoSample::broadcast(current[3]) * y + s2;
+		s2 = StereoSample::broadcast(current[2]) * x - StereoSample::broadcast(current[4]) * y;
+		return y;
+	}
+
+private:
+	float current[5] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+	float target[5] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+	float step[5] = {};
+	int rampRemaining = 0;
+	StereoSample s1 = StereoSample::zero();
+	StereoSample s2 = StereoSample::zero();
+};
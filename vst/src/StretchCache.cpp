@@ -0,0 +1,196 @@
+#include "StretchCache.h"
+
+StretchCache::StretchCache()
+{
+	cacheDirectory = getCacheDirectory();
+}
+
+juce::String StretchCache::createKey(const juce::AudioBuffer<float> &source,
+									 double sampleRate,
+									 double ratio,
+									 const juce::String &algorithm) const
+{
+	juce::MemoryBlock hashInput;
+	const int numChannels = source.getNumChannels();
+	const int numSamples = source.getNumSamples();
+	hashInput.append(&numChannels, sizeof(numChannels));
+	hashInput.append(&numSamples, sizeof(numSamples));
+	hashInput.append(&sampleRate, sizeof(sampleRate));
+
+	for (int ch = 0; ch < numChannels; ++ch)
+	{
+		juce::MD5 channelHash(source.getReadPointer(ch), (size_t)numSamples * sizeof(float));
+		hashInput.append(channelHash.getRawChecksumData().getData(), channelHash.getRawChecksumData().getSize());
+	}
+
+	juce::String contentHash = juce::MD5(hashInput).toHexString();
+	juce::int64 ratioKey = (juce::int64)std::llround(ratio * 10000.0);
+	return contentHash + "_" + juce::String(ratioKey) + "_" + algorithm;
+}
+
+bool StretchCache::load(const juce::String &key, juce::AudioBuffer<float> &destination)
+{
+	juce::File cacheFile;
+	{
+		juce::ScopedLock lock(cacheLock);
+		ensureIndexLoaded();
+
+		auto it = entries.find(key);
+		if (it == entries.end())
+			return false;
+
+		if (!it->second.file.existsAsFile())
+		{
+			removeEntry(it);
+			return false;
+		}
+
+		it->second.lastUsedMs = juce::Time::currentTimeMillis();
+		cacheFile = it->second.file;
+	}
+
+	juce::FileInputStream input(cacheFile);
+	if (!input.openedOk())
+		return false;
+
+	int magic = input.readInt();
+	int version = input.readInt();
+	int numChannels = input.readInt();
+	int numSamples = input.readInt();
+
+	if (magic != fileMagic || version != fileVersion || numChannels <= 0 || numSamples <= 0)
+		return false;
+
+	const auto channelBytes = (size_t)numSamples * sizeof(float);
+	if (input.getTotalLength() - input.getPosition() < (juce::int64)(channelBytes * (size_t)numChannels))
+		return false;
+
+	juce::AudioBuffer<float> loaded(numChannels, numSamples);
+	for (int ch = 0; ch < numChannels; ++ch)
+	{
+		if (input.read(loaded.getWritePointer(ch), (int)channelBytes) != (int)channelBytes)
+			return false;
+	}
+
+	destination = std::move(loaded);
+	cacheFile.setLastModificationTime(juce::Time::getCurrentTime());
+
+	DBG("Stretch cache hit: " + key);
+	return true;
+}
+
+void StretchCache::store(const juce::String &key, const juce::AudioBuffer<float> &buffer)
+{
+	if (buffer.getNumSamples() == 0 || buffer.getNumChannels() == 0)
+		return;
+
+	juce::ScopedLock lock(cacheLock);
+	ensureIndexLoaded();
+
+	if (!cacheDirectory.exists())
+		cacheDirectory.createDirectory();
+
+	juce::File cacheFile = cacheDirectory.getChildFile(key + ".stretch");
+	juce::TemporaryFile tempFile(cacheFile);
+
+	{
+		juce::FileOutputStream output(tempFile.getFile());
+		if (!output.openedOk())
+			return;
+
+		output.writeInt(fileMagic);
+		output.writeInt(fileVersion);
+		output.writeInt(buffer.getNumChannels());
+		output.writeInt(buffer.getNumSamples());
+
+		for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+		{
+			output.write(buffer.getReadPointer(ch), (size_t)buffer.getNumSamples() * sizeof(float));
+		}
+		output.flush();
+
+		if (output.getStatus().failed())
+			return;
+	}
+
+	if (!tempFile.overwriteTargetFileWithTemporary())
+		return;
+
+	auto existing = entries.find(key);
+	if (existing != entries.end())
+	{
+		totalBytes -= existing->second.sizeBytes;
+	}
+
+	CacheEntry &entry = entries[key];
+	entry.file = cacheFile;
+	entry.sizeBytes = cacheFile.getSize();
+	entry.lastUsedMs = juce::Time::currentTimeMillis();
+	totalBytes += entry.sizeBytes;
+
+	evictIfNeeded();
+}
+
+void StretchCache::setMaxCacheBytes(juce::int64 newMaxBytes)
+{
+	maxCacheBytes = newMaxBytes;
+
+	juce::ScopedLock lock(cacheLock);
+	if (indexLoaded)
+		evictIfNeeded();
+}
+
+juce::File StretchCache::getCacheDirectory() const
+{
+	return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+		.getChildFile("OBSIDIAN-Neural")
+		.getChildFile("StretchCache");
+}
+
+void StretchCache::ensureIndexLoaded()
+{
+	if (indexLoaded)
+		return;
+
+	indexLoaded = true;
+	if (!cacheDirectory.isDirectory())
+		return;
+
+	for (const auto &file : cacheDirectory.findChildFiles(juce::File::findFiles, false, "*.stretch"))
+	{
+		CacheEntry entry;
+		entry.file = file;
+		entry.sizeBytes = file.getSize();
+		entry.lastUsedMs = file.getLastModificationTime().toMilliseconds();
+		totalBytes += entry.sizeBytes;
+		entries[file.getFileNameWithoutExtension()] = entry;
+	}
+
+	DBG("Stretch cache indexed " + juce::String((int)entries.size()) + " renders");
+	evictIfNeeded();
+}
+
+void StretchCache::evictIfNeeded()
+{
+	const juce::int64 limit = maxCacheBytes.load();
+
+	while (totalBytes > limit && !entries.empty())
+	{
+		auto oldest = entries.begin();
+		for (auto it = entries.begin(); it != entries.end(); ++it)
+		{
+			if (it->second.lastUsedMs < oldest->second.lastUsedMs)
+				oldest = it;
+		}
+
+		DBG("Stretch cache evicting: " + oldest->first);
+		oldest->second.file.deleteFile();
+		removeEntry(oldest);
+	}
+}
+
+void StretchCache::removeEntry(std::map<juce::String, CacheEntry>::iterator it)
+{
+	totalBytes -= it->second.sizeBytes;
+	entries.erase(it);
+}
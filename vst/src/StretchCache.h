@@ -0,0 +1,47 @@
+#pragma once
+#include "JuceHeader.h"
+#include <map>
+
+class StretchCache
+{
+public:
+	StretchCache();
+	~StretchCache() = default;
+
+	juce::String createKey(const juce::AudioBuffer<float> &source,
+						   double sampleRate,
+						   double ratio,
+						   const juce::String &algorithm) const;
+
+	bool load(const juce::String &key, juce::AudioBuffer<float> &destination);
+	void store(const juce::String &key, const juce::AudioBuffer<float> &buffer);
+
+	void setMaxCacheBytes(juce::int64 newMaxBytes);
+	juce::int64 getMaxCacheBytes() const { return maxCacheBytes.load(); }
+
+private:
+	struct CacheEntry
+	{
+		juce::File file;
+		juce::int64 sizeBytes = 0;
+		juce::int64 lastUsedMs = 0;
+	};
+
+	static constexpr juce::int64 defaultMaxCacheBytes = (juce::int64)512 * 1024 * 1024;
+	static constexpr int fileMagic = 0x4f425343;
+	static constexpr int fileVersion = 1;
+
+	std::map<juce::String, CacheEntry> entries;
+	juce::File cacheDirectory;
+	juce::CriticalSection cacheLock;
+	std::atomic<juce::int64> maxCacheBytes{defaultMaxCacheBytes};
+	juce::int64 totalBytes = 0;
+	bool indexLoaded = false;
+
+	juce::File getCacheDirectory() const;
+	void ensureIndexLoaded();
+	void evictIfNeeded();
+	void removeEntry(std::map<juce::String, CacheEntry>::iterator it);
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(StretchCache)
+};
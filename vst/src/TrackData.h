@@ -1,6 +1,9 @@
 #pragma once
 #include <JuceHeader.h>
 #include "DjIaClient.h"
+#include "SequencerClock.h"
+#include "SequencerPattern.h"
+#include "TrackInsertChain.h"
 
 struct TrackPage
 {
@@ -162,11 +165,46 @@ struct TrackData
 	std::atomic<double> lastBeatTime{ -1.0 };
 	std::atomic<bool> beatRepeatStopPending{ false };
 	std::atomic<bool> randomRetriggerDurationEnabled{ false };
-	std::atomic<int64_t> pendingBeatNumber{ -1 };
-	std::atomic<int64_t> pendingStopBeatNumber{ -1 };
+	int beatRepeatStartOffset = -1;
+	int beatRepeatStopOffset = -1;
+	double beatRepeatLengthSamples = 0.0;
 
-	int customStepCounter = 0;
-	double lastPpqPosition = -1.0;
+	SequencerClock sequencerClock;
+
+	int paramSnapshotSlot = -1;
+	double smoothingSampleRate = 0.0;
+	juce::SmoothedValue<float> smoothedVolume;
+	juce::SmoothedValue<float> smoothedPan;
+	juce::SmoothedValue<double, juce::ValueSmoothingTypes::Multiplicative> smoothedPlaybackRatio;
+
+	TrackInsertChain::Parameters insertParameters;
+	std::unique_ptr<TrackInsertChain> insertChain;
+
+	static constexpr int maxVoiceTriggersPerBlock = 16;
+	int voiceTriggerOffsets[maxVoiceTriggersPerBlock] = {};
+	int numVoiceTriggers = 0;
+	bool silentUntilFirstVoiceTrigger = false;
+
+	void queueVoiceTrigger(int sampleOffset)
+	{
+		if (numVoiceTriggers >= maxVoiceTriggersPerBlock)
+			return;
+		if (numVoiceTriggers == 0 && !isPlaying.load())
+			silentUntilFirstVoiceTrigger = true;
+		int insertAt = numVoiceTriggers++;
+		while (insertAt > 0 && voiceTriggerOffsets[insertAt - 1] > sampleOffset)
+		{
+			voiceTriggerOffsets[insertAt] = voiceTriggerOffsets[insertAt - 1];
+			--insertAt;
+		}
+		voiceTriggerOffsets[insertAt] = sampleOffset;
+	}
+
+	void clearVoiceTriggers()
+	{
+		numVoiceTriggers = 0;
+		silentUntilFirstVoiceTrigger = false;
+	}
 
 	juce::String currentSampleId;
 
@@ -185,8 +223,7 @@ struct TrackData
 
 	struct SequencerData
 	{
-		bool steps[4][16] = {};
-		float velocities[4][16] = {};
+		SequencerPattern pattern;
 		bool isPlaying = false;
 		int currentStep = 0;
 		int currentMeasure = 0;
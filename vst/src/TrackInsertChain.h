@@ -0,0 +1,405 @@
+#pragma once
+#include "JuceHeader.h"
+#include "SimpleEQ.h"
+#include "StereoBiquad.h"
+
+class TrackInsertChain
+{
+public:
+	enum class NodeType
+	{
+		Filter,
+		ThreeBandEq,
+		Gain,
+		Send
+	};
+
+	struct Parameters
+	{
+		std::atomic<float> filter{0.0f};
+		std::atomic<float> lowGainDb{0.0f};
+		std::atomic<float> midGainDb{0.0f};
+		std::atomic<float> highGainDb{0.0f};
+		std::atomic<float> gainDb{0.0f};
+		std::atomic<float> sendLevel{0.0f};
+	};
+
+	struct Graph
+	{
+		static constexpr int trackInput = -1;
+		static constexpr int trackOutput = -2;
+
+		struct Connection
+		{
+			int source;
+			int destination;
+		};
+
+		std::vector<NodeType> nodes;
+		std::vector<Connection> connections;
+
+		int addNode(NodeType type)
+		{
+			nodes.push_back(type);
+			return (int)nodes.size() - 1;
+		}
+
+		void connect(int source, int destination) { connections.push_back({source, destination}); }
+		bool isEmpty() const { return nodes.empty(); }
+	};
+
+	static constexpr int filterEngaged = 1 << 0;
+	static constexpr int eqEngaged = 1 << 1;
+	static constexpr int gainEngaged = 1 << 2;
+	static constexpr int sendEngaged = 1 << 3;
+	static constexpr int allInserts = filterEngaged | eqEngaged | gainEngaged | sendEngaged;
+
+	static Graph makeChannelStripGraph(int engagedMask)
+	{
+		Graph graph;
+		int previous = Graph::trackInput;
+		for (auto [flag, type] : {std::make_pair(filterEngaged, NodeType::Filter),
+								  std::make_pair(eqEngaged, NodeType::ThreeBandEq),
+								  std::make_pair(gainEngaged, NodeType::Gain)})
+		{
+			if ((engagedMask & flag) == 0)
+				continue;
+			int node = graph.addNode(type);
+			graph.connect(previous, node);
+			previous = node;
+		}
+		graph.connect(previous, Graph::trackOutput);
+
+		if (engagedMask & sendEngaged)
+			graph.connect(previous, graph.addNode(NodeType::Send));
+		return graph;
+	}
+
+	static std::unique_ptr<TrackInsertChain> compile(const Graph &graph, double sampleRate, int maxBlockSize)
+	{
+		const int numNodes = (int)graph.nodes.size();
+		if (numNodes == 0)
+			return nullptr;
+
+		std::vector<std::vector<int>> inputs((size_t)numNodes);
+		std::vector<int> outputInputs;
+		std::vector<int> fanOut((size_t)numNodes + 1, 0);
+		auto fanOutOf = [&](int source) -> int &
+		{ return fanOut[(size_t)(source == Graph::trackInput ? numNodes : source)]; };
+
+		for (const auto &connection : graph.connections)
+		{
+			const bool validSource = connection.source == Graph::trackInput ||
+									 (connection.source >= 0 && connection.source < numNodes);
+			const bool validDestination = connection.destination == Graph::trackOutput ||
+										  (connection.destination >= 0 && connection.destination < numNodes);
+			if (!validSource || !validDestination)
+			{
+				DBG("Insert graph has an invalid connection");
+				return nullptr;
+			}
+			if (connection.destination == Graph::trackOutput)
+				outputInputs.push_back(connection.source);
+			else
+				inputs[(size_t)connection.destination].push_back(connection.source);
+			++fanOutOf(connection.source);
+		}
+
+		std::vector<int> order;
+		std::vector<int> pending((size_t)numNodes);
+		for (int n = 0; n < numNodes; ++n)
+			pending[(size_t)n] = (int)std::count_if(inputs[(size_t)n].begin(), inputs[(size_t)n].end(),
+													 [](int source) { return source >= 0; });
+		for (int n = 0; n < numNodes; ++n)
+		{
+			if (pending[(size_t)n] == 0)
+				order.push_back(n);
+		}
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			for (int n = 0; n < numNodes; ++n)
+			{
+				for (int source : inputs[(size_t)n])
+				{
+					if (source == order[i] && --pending[(size_t)n] == 0)
+						order.push_back(n);
+				}
+			}
+		}
+		if ((int)order.size() != numNodes)
+		{
+			DBG("Insert graph contains a cycle");
+			return nullptr;
+		}
+
+		std::unique_ptr<TrackInsertChain> chain(new TrackInsertChain());
+		chain->capacity = juce::jmax(1, maxBlockSize);
+		chain->nodes.resize((size_t)numNodes);
+
+		std::vector<int> nodeBuffer((size_t)numNodes, 0);
+		int numPoolBuffers = 0;
+		auto bufferOf = [&](int source)
+		{ return source == Graph::trackInput ? 0 : nodeBuffer[(size_t)source]; };
+
+		for (int n : order)
+		{
+			auto &node = chain->nodes[(size_t)n];
+			node.type = graph.nodes[(size_t)n];
+			node.prepare(sampleRate, chain->capacity);
+
+			const auto &nodeInputs = inputs[(size_t)n];
+			const bool writesAudio = node.type != NodeType::Send;
+			const bool sourceIsTap = nodeInputs.size() == 1 && nodeInputs[0] >= 0 &&
+									 graph.nodes[(size_t)nodeInputs[0]] == NodeType::Send;
+			if (nodeInputs.size() == 1 && (!writesAudio || (fanOutOf(nodeInputs[0]) == 1 && !sourceIsTap)))
+			{
+				nodeBuffer[(size_t)n] = bufferOf(nodeInputs[0]);
+			}
+			else
+			{
+				nodeBuffer[(size_t)n] = ++numPoolBuffers;
+				chain->schedule.push_back({Op::Clear, -1, -1, nodeBuffer[(size_t)n]});
+				for (int source : nodeInputs)
+					chain->schedule.push_back({Op::Mix, -1, bufferOf(source), nodeBuffer[(size_t)n]});
+			}
+			chain->schedule.push_back({Op::Process, n, -1, nodeBuffer[(size_t)n]});
+		}
+
+		if (outputInputs.size() == 1)
+		{
+			if (bufferOf(outputInputs[0]) != 0)
+				chain->schedule.push_back({Op::Copy, -1, bufferOf(outputInputs[0]), 0});
+		}
+		else
+		{
+			const int mixBuffer = ++numPoolBuffers;
+			chain->schedule.push_back({Op::Clear, -1, -1, mixBuffer});
+			for (int source : outputInputs)
+				chain->schedule.push_back({Op::Mix, -1, bufferOf(source), mixBuffer});
+			chain->schedule.push_back({Op::Copy, -1, mixBuffer, 0});
+		}
+
+		chain->pool.setSize(juce::jmax(1, numPoolBuffers) * 2, chain->capacity);
+		chain->pool.clear();
+		return chain;
+	}
+
+	// True while every node has settled at its neutral setting and the parameters still ask for
+	// it, in which case the whole schedule can be skipped for the block.
+	bool isIdle(const Parameters &params, bool sendAudible) const
+	{
+		if (std::abs(params.filter.load()) >= 0.01f || std::abs(params.lowGainDb.load()) >= 0.1f ||
+			std::abs(params.midGainDb.load()) >= 0.1f || std::abs(params.highGainDb.load()) >= 0.1f ||
+			std::abs(params.gainDb.load()) > 0.1f || (sendAudible && params.sendLevel.load() > 0.001f))
+			return false;
+		return std::all_of(nodes.begin(), nodes.end(), [](const Node &node) { return node.idle; });
+	}
+
+	bool process(juce::AudioBuffer<float> &trackBuffer, juce::AudioBuffer<float> &sendBuffer,
+				 int numSamples, const Parameters &params, bool sendAudible)
+	{
+		juce::ScopedNoDenormals noDenormals;
+
+		bool wroteSend = false;
+		for (int offset = 0; offset < numSamples; offset += capacity)
+		{
+			const int chunk = std::min(capacity, numSamples - offset);
+			for (const auto &step : schedule)
+			{
+				switch (step.op)
+				{
+				case Op::Clear:
+					for (int ch = 0; ch < 2; ++ch)
+						juce::FloatVectorOperations::clear(channel(trackBuffer, step.target, ch, offset), chunk);
+					break;
+				case Op::Mix:
+					for (int ch = 0; ch < 2; ++ch)
+						juce::FloatVectorOperations::add(channel(trackBuffer, step.target, ch, offset),
+														 channel(trackBuffer, step.source, ch, offset), chunk);
+					break;
+				case Op::Copy:
+					for (int ch = 0; ch < 2; ++ch)
+						juce::FloatVectorOperations::copy(channel(trackBuffer, step.target, ch, offset),
+														  channel(trackBuffer, step.source, ch, offset), chunk);
+					break;
+				case Op::Process:
+					wroteSend |= nodes[(size_t)step.node].process(channel(trackBuffer, step.target, 0, offset),
+																  channel(trackBuffer, step.target, 1, offset),
+																  sendBuffer, offset, chunk, params, sendAudible);
+					break;
+				}
+			}
+		}
+		return wroteSend;
+	}
+
+private:
+	TrackInsertChain() = default;
+
+	enum class Op
+	{
+		Clear,
+		Mix,
+		Copy,
+		Process
+	};
+
+	struct Step
+	{
+		Op op;
+		int node;
+		int source;
+		int target;
+	};
+
+	struct Node
+	{
+		NodeType type = NodeType::Gain;
+		double sampleRate = 48000.0;
+		int rampLength = 480;
+
+		StereoBiquad filter;
+		float appliedFilter = 0.0f;
+		SimpleEQ eq;
+		juce::SmoothedValue<float> gain{1.0f};
+		float appliedSendLevel = 0.0f;
+		bool idle = true;
+
+		void prepare(double newSampleRate, int maxBlockSize)
+		{
+			sampleRate = newSampleRate;
+			rampLength = juce::jmax(1, (int)(sampleRate * 0.01));
+			appliedFilter = 0.0f;
+			appliedSendLevel = 0.0f;
+			idle = true;
+			filter.setTarget(juce::IIRCoefficients(1.0, 0.0, 0.0, 1.0, 0.0, 0.0), 1);
+			filter.snapToTarget();
+			filter.reset();
+			eq.prepare(sampleRate, maxBlockSize);
+			gain.reset(sampleRate, 0.02);
+			gain.setCurrentAndTargetValue(1.0f);
+		}
+
+		bool process(float *left, float *right, juce::AudioBuffer<float> &sendBuffer, int offset, int numSamples,
+					 const Parameters &params, bool sendAudible)
+		{
+			idle = false;
+			switch (type)
+			{
+			case NodeType::Filter:
+			{
+				const float target = juce::jlimit(-1.0f, 1.0f, params.filter.load());
+				if (std::abs(target - appliedFilter) > 0.001f)
+				{
+					filter.setTarget(djFilterCoefficients(target), rampLength);
+					appliedFilter = target;
+				}
+				if (std::abs(appliedFilter) < 0.01f && !filter.isRamping())
+				{
+					filter.reset();
+					idle = true;
+					return false;
+				}
+				for (int i = 0; i < numSamples; ++i)
+				{
+					const StereoSample y = filter.process(StereoSample::load(left[i], right[i]));
+					left[i] = y.left();
+					right[i] = y.right();
+				}
+				return false;
+			}
+			case NodeType::ThreeBandEq:
+			{
+				eq.setLowGain(params.lowGainDb.load());
+				eq.setMidGain(params.midGainDb.load());
+				eq.setHighGain(params.highGainDb.load());
+				if (std::abs(eq.getLowGain()) < 0.1f && std::abs(eq.getMidGain()) < 0.1f &&
+					std::abs(eq.getHighGain()) < 0.1f && !eq.isRamping())
+				{
+					eq.reset();
+					idle = true;
+					return false;
+				}
+				float *channels[] = {left, right};
+				juce::AudioBuffer<float> view(channels, 2, numSamples);
+				eq.processBlock(view);
+				return false;
+			}
+			case NodeType::Gain:
+			{
+				const float gainDb = params.gainDb.load();
+				gain.setTargetValue(std::abs(gainDb) > 0.1f ? juce::Decibels::decibelsToGain(gainDb) : 1.0f);
+				if (!gain.isSmoothing())
+				{
+					if (gain.getTargetValue() == 1.0f)
+					{
+						idle = true;
+						return false;
+					}
+					juce::FloatVectorOperations::multiply(left, gain.getTargetValue(), numSamples);
+					juce::FloatVectorOperations::multiply(right, gain.getTargetValue(), numSamples);
+					return false;
+				}
+				for (int i = 0; i < numSamples; ++i)
+				{
+					const float g = gain.getNextValue();
+					left[i] *= g;
+					right[i] *= g;
+				}
+				return false;
+			}
+			case NodeType::Send:
+			{
+				float level = sendAudible ? juce::jlimit(0.0f, 1.0f, params.sendLevel.load()) : 0.0f;
+				if (level <= 0.001f)
+					level = 0.0f;
+				if (level == 0.0f && appliedSendLevel == 0.0f)
+				{
+					idle = true;
+					return false;
+				}
+				const float step = (level - appliedSendLevel) / (float)juce::jmax(1, numSamples);
+				float *sendLeft = sendBuffer.getWritePointer(0, offset);
+				float *sendRight = sendBuffer.getWritePointer(1, offset);
+				float current = appliedSendLevel;
+				for (int i = 0; i < numSamples; ++i)
+				{
+					current += step;
+					sendLeft[i] += left[i] * current;
+					sendRight[i] += right[i] * current;
+				}
+				appliedSendLevel = level;
+				return true;
+			}
+			}
+			return false;
+		}
+
+		juce::IIRCoefficients djFilterCoefficients(float position) const
+		{
+			if (std::abs(position) < 0.01f)
+				return juce::IIRCoefficients(1.0, 0.0, 0.0, 1.0, 0.0, 0.0);
+
+			const double nyquistLimit = sampleRate * 0.45;
+			if (position < 0.0f)
+			{
+				const double cutoff = 20000.0 * std::pow(80.0 / 20000.0, (double)-position);
+				return juce::IIRCoefficients::makeLowPass(sampleRate, juce::jmin(cutoff, nyquistLimit), 0.9);
+			}
+			const double cutoff = 20.0 * std::pow(8000.0 / 20.0, (double)position);
+			return juce::IIRCoefficients::makeHighPass(sampleRate, juce::jmin(cutoff, nyquistLimit), 0.9);
+		}
+	};
+
+	float *channel(juce::AudioBuffer<float> &trackBuffer, int bufferIndex, int ch, int offset)
+	{
+		if (bufferIndex == 0)
+			return trackBuffer.getWritePointer(ch, offset);
+		return pool.getWritePointer((bufferIndex - 1) * 2 + ch);
+	}
+
+	std::vector<Node> nodes;
+	std::vector<Step> schedule;
+	juce::AudioBuffer<float> pool;
+	int capacity = 0;
+};
@@ -1,6 +1,8 @@
 #pragma once
 #include "JuceHeader.h"
 #include "TrackData.h"
+#include "BinaryState.h"
+#include "SessionBundle.h"
 
 class TrackManager
 {
@@ -9,71 +11,119 @@ public:
 
 	std::function<void(int slot, TrackData *track)> parameterUpdateCallback;
 
-	juce::String createTrack(const juce::String &name = "Track")
+	void prepare(double sampleRate, int maxBlockSize)
 	{
-		juce::ScopedLock lock(tracksLock);
-		for (int i = 0; i < 8; ++i)
+		renderSampleRate = sampleRate;
+		renderBlockSize = juce::jmax(1, maxBlockSize);
+		trackScratch.setSize(2, renderBlockSize);
+		sendBus.setSize(2, renderBlockSize);
+		updateInsertChains(true);
+	}
+
+	void updateInsertChains(bool forceRecompile = false)
+	{
+		if (renderBlockSize == 0)
+			return;
+
+		juce::StringArray missing;
 		{
-			usedSlots[i] = false;
+			juce::ScopedLock lock(tracksLock);
+			for (const auto &pair : tracks)
+			{
+				if (forceRecompile || pair.second->insertChain == nullptr)
+					missing.add(pair.second->trackId);
+			}
 		}
-		for (const auto &pair : tracks)
+
+		for (const auto &trackId : missing)
 		{
-			if (pair.second->slotIndex >= 0 && pair.second->slotIndex < 8)
+			auto chain = TrackInsertChain::compile(TrackInsertChain::makeChannelStripGraph(TrackInsertChain::allInserts),
+												   renderSampleRate, renderBlockSize);
 			{
-				usedSlots[pair.second->slotIndex] = true;
+				juce::ScopedLock lock(tracksLock);
+				auto it = tracks.find(trackId.toStdString());
+				if (it == tracks.end())
+					continue;
+				std::swap(it->second->insertChain, chain);
 			}
 		}
+	}
 
-		auto track = std::make_unique<TrackData>();
-		track->trackName = name + " " + juce::String(tracks.size() + 1);
-		track->bpmOffset = 0.0;
-		track->midiNote = 60 + static_cast<int>(tracks.size());
-		juce::String trackId = track->trackId;
-		std::string stdId = trackId.toStdString();
-		track->slotIndex = findFreeSlot();
-
-		if (track->slotIndex != -1)
+	juce::String createTrack(const juce::String &name = "Track")
+	{
+		juce::String trackId;
 		{
-			usedSlots[track->slotIndex] = true;
+			juce::ScopedLock lock(tracksLock);
+			for (int i = 0; i < 8; ++i)
+			{
+				usedSlots[i] = false;
+			}
+			for (const auto &pair : tracks)
+			{
+				if (pair.second->slotIndex >= 0 && pair.second->slotIndex < 8)
+				{
+					usedSlots[pair.second->slotIndex] = true;
+				}
+			}
+
+			auto track = std::make_unique<TrackData>();
+			track->trackName = name + " " + juce::String(tracks.size() + 1);
+			track->bpmOffset = 0.0;
+			track->midiNote = 60 + static_cast<int>(tracks.size());
+			trackId = track->trackId;
+			std::string stdId = trackId.toStdString();
+			track->slotIndex = findFreeSlot();
+
+			if (track->slotIndex != -1)
+			{
+				usedSlots[track->slotIndex] = true;
+			}
+			tracks[stdId] = std::move(track);
+			trackOrder.push_back(stdId);
 		}
-		tracks[stdId] = std::move(track);
-		trackOrder.push_back(stdId);
+		refreshTrackStates();
 		return trackId;
 	}
 
 	void removeTrack(const juce::String &trackId)
 	{
-		juce::ScopedLock lock(tracksLock);
-		std::string stdId = trackId.toStdString();
-		if (auto *track = getTrack(trackId))
 		{
-			if (track->slotIndex != -1)
+			juce::ScopedLock lock(tracksLock);
+			std::string stdId = trackId.toStdString();
+			if (auto *track = getTrack(trackId))
 			{
-				usedSlots[track->slotIndex] = false;
+				if (track->slotIndex != -1)
+				{
+					usedSlots[track->slotIndex] = false;
+				}
 			}
+			tracks.erase(stdId);
+			trackOrder.erase(std::remove(trackOrder.begin(), trackOrder.end(), stdId), trackOrder.end());
 		}
-		tracks.erase(stdId);
-		trackOrder.erase(std::remove(trackOrder.begin(), trackOrder.end(), stdId), trackOrder.end());
+		refreshTrackStates();
 	}
 
 	void reorderTracks(const juce::String &fromTrackId, const juce::String &toTrackId)
 	{
-		juce::ScopedLock lock(tracksLock);
+		{
+			juce::ScopedLock lock(tracksLock);
 
-		std::string fromStdId = fromTrackId.toStdString();
-		std::string toStdId = toTrackId.toStdString();
+			std::string fromStdId = fromTrackId.toStdString();
+			std::string toStdId = toTrackId.toStdString();
 
-		auto fromIt = std::find(trackOrder.begin(), trackOrder.end(), fromStdId);
-		auto toIt = std::find(trackOrder.begin(), trackOrder.end(), toStdId);
+			auto fromIt = std::find(trackOrder.begin(), trackOrder.end(), fromStdId);
+			auto toIt = std::find(trackOrder.begin(), trackOrder.end(), toStdId);
 
-		if (fromIt == trackOrder.end() || toIt == trackOrder.end())
-			return;
+			if (fromIt == trackOrder.end() || toIt == trackOrder.end())
+				return;
 
-		std::string movedId = *fromIt;
-		trackOrder.erase(fromIt);
+			std::string movedId = *fromIt;
+			trackOrder.erase(fromIt);
 
-		toIt = std::find(trackOrder.begin(), trackOrder.end(), toStdId);
-		trackOrder.insert(toIt, movedId);
+			toIt = std::find(trackOrder.begin(), trackOrder.end(), toStdId);
+			trackOrder.insert(toIt, movedId);
+		}
+		refreshTrackStates();
 	}
 
 	TrackData *getTrack(const juce::String &trackId)
@@ -123,6 +173,17 @@ public:
 
 		juce::ScopedLock lock(tracksLock);
 
+		if (trackScratch.getNumSamples() < numSamples)
+		{
+			trackScratch.setSize(2, numSamples, false, false, true);
+			sendBus.setSize(2, numSamples, false, false, true);
+		}
+
+		// Sends from every track are summed here and reach the master after the loop. They
+		// bypass mute and the individual outputs, but a track soloed out sends nothing.
+		sendBus.clear(0, numSamples);
+		bool sendBusWritten = false;
+
 		for (const auto &pair : tracks)
 		{
 			auto *track = pair.second.get();
@@ -132,28 +193,27 @@ public:
 			{
 				int bufferIndex = track->slotIndex;
 
-				juce::AudioBuffer<float> tempMixBuffer(outputBuffer.getNumChannels(), numSamples);
-				juce::AudioBuffer<float> tempIndividualBuffer(2, numSamples);
-				tempMixBuffer.clear();
-				tempIndividualBuffer.clear();
+				juce::AudioBuffer<float> trackBuffer(trackScratch.getArrayOfWritePointers(), 2, numSamples);
+				trackBuffer.clear();
+
+				renderSingleTrack(*track, trackBuffer, numSamples, hostBpm);
 
-				renderSingleTrack(*track, tempMixBuffer, tempIndividualBuffer,
-								  numSamples, bufferIndex, hostBpm);
+				const bool soloedOut = anyTrackSolo && !track->isSolo.load();
+				if (track->insertChain != nullptr && !track->insertChain->isIdle(track->insertParameters, !soloedOut))
+					sendBusWritten |= track->insertChain->process(trackBuffer, sendBus, numSamples,
+																  track->insertParameters, !soloedOut);
 
-				bool shouldHearTrack = !track->isMuted.load() &&
-									   (!anyTrackSolo || track->isSolo.load());
+				bool shouldHearTrack = !track->isMuted.load() && !soloedOut;
 
 				if (shouldHearTrack)
 				{
-					for (int ch = 0; ch < outputBuffer.getNumChannels(); ++ch)
-					{
-						outputBuffer.addFrom(ch, 0, tempMixBuffer, ch, 0, numSamples);
-					}
+					for (int ch = 0; ch < std::min(2, outputBuffer.getNumChannels()); ++ch)
+						outputBuffer.addFrom(ch, 0, trackBuffer, ch, 0, numSamples);
 				}
 
 				for (int ch = 0; ch < std::min(2, individualOutputs[bufferIndex].getNumChannels()); ++ch)
 				{
-					individualOutputs[bufferIndex].copyFrom(ch, 0, tempIndividualBuffer, ch, 0, numSamples);
+					individualOutputs[bufferIndex].copyFrom(ch, 0, trackBuffer, ch, 0, numSamples);
 
 					if (!shouldHearTrack)
 					{
@@ -161,392 +221,145 @@ public:
 					}
 				}
 			}
+
+			flushBeatRepeatEvents(*track);
+			track->clearVoiceTriggers();
+		}
+
+		if (sendBusWritten)
+		{
+			for (int ch = 0; ch < std::min(2, outputBuffer.getNumChannels()); ++ch)
+				outputBuffer.addFrom(ch, 0, sendBus, ch, 0, numSamples);
 		}
 	}
 
-	juce::ValueTree saveState() const
+	struct TrackState
 	{
-		juce::ValueTree state("TrackManager");
-
-		juce::ScopedLock lock(tracksLock);
-		for (const auto &pair : tracks)
-		{
-			auto trackState = juce::ValueTree("Track");
-			auto *track = pair.second.get();
+		juce::String trackId;
+		juce::MemoryBlock encoded;
+		std::vector<SessionBundle::AudioSource> audioSources;
+	};
 
-			trackState.setProperty("id", track->trackId, nullptr);
-			trackState.setProperty("name", track->trackName, nullptr);
-			trackState.setProperty("slotIndex", track->slotIndex, nullptr);
-			trackState.setProperty("prompt", track->prompt, nullptr);
-			trackState.setProperty("style", track->style, nullptr);
-			trackState.setProperty("stems", track->stems, nullptr);
-			trackState.setProperty("bpm", track->bpm, nullptr);
-			trackState.setProperty("originalBpm", track->originalBpm, nullptr);
-			trackState.setProperty("timeStretchMode", track->timeStretchMode, nullptr);
-			trackState.setProperty("bpmOffset", track->bpmOffset, nullptr);
-			trackState.setProperty("midiNote", track->midiNote, nullptr);
-			trackState.setProperty("loopStart", track->loopStart, nullptr);
-			trackState.setProperty("loopEnd", track->loopEnd, nullptr);
-			trackState.setProperty("volume", track->volume.load(), nullptr);
-			trackState.setProperty("pan", track->pan.load(), nullptr);
-			trackState.setProperty("muted", track->isMuted.load(), nullptr);
-			trackState.setProperty("solo", track->isSolo.load(), nullptr);
-			trackState.setProperty("enabled", track->isEnabled.load(), nullptr);
-			trackState.setProperty("fineOffset", track->fineOffset, nullptr);
-			trackState.setProperty("timeStretchRatio", track->timeStretchRatio, nullptr);
-			trackState.setProperty("stagingOriginalBpm", track->stagingOriginalBpm, nullptr);
-			trackState.setProperty("showWaveform", track->showWaveform, nullptr);
-			trackState.setProperty("showSequencer", track->showSequencer, nullptr);
-			trackState.setProperty("isPlaying", track->isPlaying.load(), nullptr);
-			trackState.setProperty("isArmed", track->isArmed.load(), nullptr);
-			trackState.setProperty("isArmedToStop", track->isArmedToStop.load(), nullptr);
-			trackState.setProperty("isCurrentlyPlaying", track->isCurrentlyPlaying.load(), nullptr);
-			trackState.setProperty("generationPrompt", track->generationPrompt, nullptr);
-			trackState.setProperty("generationBpm", track->generationBpm, nullptr);
-			trackState.setProperty("generationKey", track->generationKey, nullptr);
-			trackState.setProperty("generationDuration", track->generationDuration, nullptr);
-			trackState.setProperty("loopPointsLocked", track->loopPointsLocked.load(), nullptr);
-			trackState.setProperty("selectedPrompt", track->selectedPrompt, nullptr);
-			trackState.setProperty("useOriginalFile", track->useOriginalFile.load(), nullptr);
-			trackState.setProperty("hasOriginalVersion", track->hasOriginalVersion.load(), nullptr);
-			trackState.setProperty("nextHasOriginalVersion", track->nextHasOriginalVersion.load(), nullptr);
-			trackState.setProperty("randomRetriggerEnabled", track->randomRetriggerEnabled.load(), nullptr);
-			trackState.setProperty("randomRetriggerInterval", track->randomRetriggerInterval.load(), nullptr);
-			trackState.setProperty("beatRepeatPending", track->beatRepeatPending.load(), nullptr);
-			trackState.setProperty("beatRepeatStopPending", track->beatRepeatStopPending.load(), nullptr);
-			trackState.setProperty("originalReadPosition", track->originalReadPosition.load(), nullptr);
-			trackState.setProperty("beatRepeatStartPosition", track->beatRepeatStartPosition.load(), nullptr);
-			trackState.setProperty("beatRepeatEndPosition", track->beatRepeatEndPosition.load(), nullptr);
-			trackState.setProperty("beatRepeatActive", track->beatRepeatActive.load(), nullptr);
-			trackState.setProperty("randomRetriggerDurationEnabled", track->randomRetriggerDurationEnabled.load(), nullptr);
-			trackState.setProperty("usePages", track->usePages.load(), nullptr);
-			trackState.setProperty("currentPageIndex", track->currentPageIndex, nullptr);
-			for (int pageIndex = 0; pageIndex < 4; ++pageIndex)
-			{
-				auto pageState = juce::ValueTree("Page");
-				const auto &page = track->pages[pageIndex];
-
-				pageState.setProperty("index", pageIndex, nullptr);
-				pageState.setProperty("audioFilePath", page.audioFilePath, nullptr);
-				pageState.setProperty("numSamples", page.numSamples, nullptr);
-				pageState.setProperty("sampleRate", page.sampleRate, nullptr);
-				pageState.setProperty("originalBpm", page.originalBpm, nullptr);
-				pageState.setProperty("prompt", page.prompt, nullptr);
-				pageState.setProperty("selectedPrompt", page.selectedPrompt, nullptr);
-				pageState.setProperty("generationPrompt", page.generationPrompt, nullptr);
-				pageState.setProperty("generationBpm", page.generationBpm, nullptr);
-				pageState.setProperty("generationKey", page.generationKey, nullptr);
-				pageState.setProperty("generationDuration", page.generationDuration, nullptr);
-				pageState.setProperty("stems", page.stems, nullptr);
-				pageState.setProperty("loopStart", page.loopStart, nullptr);
-				pageState.setProperty("loopEnd", page.loopEnd, nullptr);
-				pageState.setProperty("useOriginalFile", page.useOriginalFile.load(), nullptr);
-				pageState.setProperty("hasOriginalVersion", page.hasOriginalVersion.load(), nullptr);
-				pageState.setProperty("isLoaded", page.isLoaded.load(), nullptr);
-
-				juce::String stemsString;
-				for (int i = 0; i < page.preferredStems.size(); ++i)
-				{
-					if (i > 0)
-						stemsString += ",";
-					stemsString += page.preferredStems[i];
-				}
-				pageState.setProperty("preferredStems", stemsString, nullptr);
+	using TrackStateList = std::vector<std::shared_ptr<const TrackState>>;
 
-				trackState.appendChild(pageState, nullptr);
-			}
+	std::shared_ptr<const TrackStateList> getTrackStates() const
+	{
+		return std::atomic_load(&publishedTrackStates);
+	}
 
-			juce::String stemsString;
-			for (int i = 0; i < track->preferredStems.size(); ++i)
-			{
-				if (i > 0)
-					stemsString += ",";
-				stemsString += track->preferredStems[i];
-			}
-			trackState.setProperty("preferredStems", stemsString, nullptr);
-			if (track->numSamples > 0 && !track->audioFilePath.isEmpty())
-			{
-				trackState.setProperty("audioFilePath", track->audioFilePath, nullptr);
-				trackState.setProperty("sampleRate", track->sampleRate, nullptr);
-				trackState.setProperty("numSamples", track->numSamples, nullptr);
-				trackState.setProperty("numChannels", track->audioBuffer.getNumChannels(), nullptr);
-			}
-			juce::ValueTree sequencerState("Sequencer");
-			sequencerState.setProperty("isPlaying", track->sequencerData.isPlaying, nullptr);
-			sequencerState.setProperty("currentStep", track->sequencerData.currentStep, nullptr);
-			sequencerState.setProperty("currentMeasure", track->sequencerData.currentMeasure, nullptr);
-			sequencerState.setProperty("numMeasures", track->sequencerData.numMeasures, nullptr);
-			sequencerState.setProperty("beatsPerMeasure", track->sequencerData.beatsPerMeasure, nullptr);
-			for (int m = 0; m < 4; ++m)
+	// Re-encodes every track and republishes the list if any of them changed. Runs on the
+	// message thread, and on whichever thread restored the tracks right after a load.
+	// Must not be called with tracksLock held: tracksLock is only taken to copy the track list.
+	void refreshTrackStates()
+	{
+		juce::ScopedLock refreshLock(trackStatesLock);
+		std::vector<std::shared_ptr<TrackData>> orderedTracks;
+		{
+			juce::ScopedLock lock(tracksLock);
+			orderedTracks.reserve(trackOrder.size());
+			for (const auto &id : trackOrder)
 			{
-				for (int s = 0; s < 16; ++s)
-				{
-					juce::String stepKey = "step_" + juce::String(m) + "_" + juce::String(s);
-					sequencerState.setProperty(stepKey, track->sequencerData.steps[m][s], nullptr);
-
-					juce::String velocityKey = "velocity_" + juce::String(m) + "_" + juce::String(s);
-					sequencerState.setProperty(velocityKey, track->sequencerData.velocities[m][s], nullptr);
-				}
+				auto it = tracks.find(id);
+				if (it != tracks.end())
+					orderedTracks.push_back(it->second);
 			}
-			trackState.appendChild(sequencerState, nullptr);
-			state.appendChild(trackState, nullptr);
 		}
 
-		return state;
-	}
-
-	void loadState(const juce::ValueTree &state)
-	{
-		juce::ScopedLock lock(tracksLock);
-		tracks.clear();
-		trackOrder.clear();
-		usedSlots.fill(false);
-		for (int i = 0; i < state.getNumChildren(); ++i)
+		auto previous = getTrackStates();
+		auto list = std::make_shared<TrackStateList>();
+		list->reserve(orderedTracks.size());
+		bool changed = orderedTracks.size() != previous->size();
+		for (const auto &track : orderedTracks)
 		{
-			auto trackState = state.getChild(i);
-			if (!trackState.hasType("Track"))
+			auto state = makeTrackState(*track);
+			const size_t index = list->size();
+			if (index < previous->size() && (*previous)[index]->trackId == state->trackId &&
+				(*previous)[index]->encoded == state->encoded)
 			{
+				list->push_back((*previous)[index]);
 				continue;
 			}
+			list->push_back(std::move(state));
+			changed = true;
+		}
 
-			auto track = std::make_unique<TrackData>();
-
-			track->trackId = trackState.getProperty("id", juce::Uuid().toString());
-			track->trackName = trackState.getProperty("name", "Track");
-			track->prompt = trackState.getProperty("prompt", "");
-			track->slotIndex = trackState.getProperty("slotIndex", -1);
-			track->style = trackState.getProperty("style", "");
-			track->stems = trackState.getProperty("stems", "");
-			track->bpm = trackState.getProperty("bpm", 126.0f);
-			track->originalBpm = trackState.getProperty("originalBpm", 126.0f);
-			track->timeStretchMode = 4;
-			track->bpmOffset = trackState.getProperty("bpmOffset", 0.0);
-			track->midiNote = trackState.getProperty("midiNote", 60);
-			track->loopStart = trackState.getProperty("loopStart", 0.0);
-			track->loopEnd = trackState.getProperty("loopEnd", 4.0);
-			track->volume = trackState.getProperty("volume", 0.8f);
-			track->pan = trackState.getProperty("pan", 0.0f);
-			track->isEnabled = trackState.getProperty("enabled", true);
-			track->fineOffset = trackState.getProperty("fineOffset", 0.0f);
-			track->timeStretchRatio = trackState.getProperty("timeStretchRatio", 1.0);
-			track->stagingOriginalBpm = trackState.getProperty("stagingOriginalBpm", 126.0f);
-			track->showWaveform = trackState.getProperty("showWaveform", false);
-			track->showSequencer = trackState.getProperty("showSequencer", false);
-			track->isMuted = trackState.getProperty("muted", false);
-			track->isSolo = trackState.getProperty("solo", false);
-			track->isPlaying = trackState.getProperty("isPlaying", false);
-			track->isArmed = trackState.getProperty("isArmed", false);
-			track->isArmedToStop = trackState.getProperty("isArmedToStop", false);
-			track->isCurrentlyPlaying = trackState.getProperty("isCurrentlyPlaying", false);
-			track->generationPrompt = trackState.getProperty("generationPrompt", "Generate a techno drum loop");
-			track->generationBpm = trackState.getProperty("generationBpm", 127.0f);
-			track->generationKey = trackState.getProperty("generationKey", "C Minor");
-			track->generationDuration = trackState.getProperty("generationDuration", 6);
-			track->loopPointsLocked = trackState.getProperty("loopPointsLocked", false);
-			track->selectedPrompt = trackState.getProperty("selectedPrompt", "");
-			track->useOriginalFile = trackState.getProperty("useOriginalFile", false);
-			track->hasOriginalVersion = trackState.getProperty("hasOriginalVersion", false);
-			track->nextHasOriginalVersion = trackState.getProperty("nextHasOriginalVersion", false);
-			track->randomRetriggerEnabled = trackState.getProperty("randomRetriggerEnabled", false);
-			track->randomRetriggerInterval = trackState.getProperty("randomRetriggerInterval", 3);
-			track->beatRepeatPending = trackState.getProperty("beatRepeatPending", false);
-			track->beatRepeatStopPending = trackState.getProperty("beatRepeatStopPending", false);
-			track->originalReadPosition = trackState.getProperty("originalReadPosition", 0.0);
-			track->beatRepeatStartPosition = trackState.getProperty("beatRepeatStartPosition", 0.0);
-			track->beatRepeatEndPosition = trackState.getProperty("beatRepeatEndPosition", 0.0);
-			track->beatRepeatActive = trackState.getProperty("beatRepeatActive", false);
-			track->randomRetriggerDurationEnabled = trackState.getProperty("randomRetriggerDurationEnabled", false);
-
-			track->usePages = trackState.getProperty("usePages", false);
-			track->currentPageIndex = trackState.getProperty("currentPageIndex", 0);
-
-			if (track->usePages.load())
-			{
-				DBG("Loading track " << track->trackName << " with pages system");
-
-				for (int pageIndex = 0; pageIndex < 4; ++pageIndex)
-				{
-					juce::ValueTree pageState;
+		if (changed)
+			std::atomic_store(&publishedTrackStates, std::shared_ptr<const TrackStateList>(std::move(list)));
+	}
 
-					for (int childIndex = 0; childIndex < trackState.getNumChildren(); ++childIndex)
-					{
-						auto child = trackState.getChild(childIndex);
-						if (child.hasType("Page"))
-						{
-							int storedPageIndex = child.getProperty("index", -1);
-							if (storedPageIndex == pageIndex)
-							{
-								pageState = child;
-								break;
-							}
-						}
-					}
+	void writeBinaryState(juce::OutputStream &stream) const
+	{
+		auto states = getTrackStates();
 
-					if (pageState.isValid())
-					{
-						auto &page = track->pages[pageIndex];
-						page.audioFilePath = pageState.getProperty("audioFilePath", "").toString();
-						page.numSamples = pageState.getProperty("numSamples", 0);
-						page.sampleRate = pageState.getProperty("sampleRate", 48000.0);
-						page.originalBpm = pageState.getProperty("originalBpm", 126.0f);
-						page.prompt = pageState.getProperty("prompt", "").toString();
-						page.selectedPrompt = pageState.getProperty("selectedPrompt", "").toString();
-						page.generationPrompt = pageState.getProperty("generationPrompt", "").toString();
-						page.generationBpm = pageState.getProperty("generationBpm", 126.0f);
-						page.generationKey = pageState.getProperty("generationKey", "").toString();
-						page.generationDuration = pageState.getProperty("generationDuration", 6);
-						page.stems = pageState.getProperty("stems", "").toString();
-						page.loopStart = pageState.getProperty("loopStart", 0.0);
-						page.loopEnd = pageState.getProperty("loopEnd", 4.0);
-						page.useOriginalFile = pageState.getProperty("useOriginalFile", false);
-						page.hasOriginalVersion = pageState.getProperty("hasOriginalVersion", false);
-						page.isLoaded = false;
-
-						juce::String stemsString = pageState.getProperty("preferredStems", "").toString();
-						page.preferredStems.clear();
-						if (stemsString.isNotEmpty())
-						{
-							juce::StringArray stemsArray = juce::StringArray::fromTokens(stemsString, ",", "");
-							for (const auto &stem : stemsArray)
-							{
-								page.preferredStems.push_back(stem.trim().toStdString());
-							}
-						}
+		stream.writeCompressedInt((int)states->size());
+		for (const auto &state : *states)
+			BinaryState::writeBlock(stream, state->encoded);
+	}
 
-						if (!page.audioFilePath.isEmpty())
-						{
-							juce::File audioFile(page.audioFilePath);
-							if (audioFile.existsAsFile())
-							{
-								DBG("Loading page " << (char)('A' + pageIndex) << " from: " << audioFile.getFullPathName());
-								loadAudioFileForPage(track.get(), pageIndex, audioFile);
-							}
-							else
-							{
-								DBG("Page " << (char)('A' + pageIndex) << " file not found: " << page.audioFilePath);
-								juce::String fileName = audioFile.getFileName();
-								if (fileName.contains("_" + juce::String('A' + pageIndex)))
-								{
-									char pageName = static_cast<char>('A' + pageIndex);
-									juce::String newFileName = fileName.replace("_" + juce::String('A' + pageIndex), "_" + juce::String(pageName));
-									juce::File newFile = audioFile.getParentDirectory().getChildFile(newFileName);
-
-									if (newFile.existsAsFile())
-									{
-										DBG("Found file with new naming: " << newFile.getFullPathName());
-										loadAudioFileForPage(track.get(), pageIndex, newFile);
-										page.audioFilePath = newFile.getFullPathName();
-									}
-								}
-							}
-						}
-					}
-					else
-					{
-						DBG("Page " << pageIndex << " state not found - empty page");
-					}
-				}
+	bool readBinaryState(juce::InputStream &stream)
+	{
+		std::vector<std::unique_ptr<TrackData>> loadedTracks;
+		const int numTracks = stream.readCompressedInt();
+		if (numTracks < 0)
+			return false;
 
-				track->syncLegacyProperties();
-				DBG("Track " << track->trackName << " loaded in pages mode - current page: " << (char)('A' + track->currentPageIndex) << " with " << track->numSamples << " samples");
-			}
-			else
-			{
-				DBG("Loading track " << track->trackName << " in legacy mode");
-				juce::String audioFilePath = trackState.getProperty("audioFilePath", "");
-				if (audioFilePath.isNotEmpty())
-				{
-					juce::File audioFile(audioFilePath);
-					DBG("LOADING STATE - audioFilePath: " + audioFilePath.toStdString());
-					if (audioFile.existsAsFile())
-					{
-						DBG("File exists: YES");
-						track->audioFilePath = audioFilePath;
-						track->sampleRate = trackState.getProperty("sampleRate", 48000.0);
-						track->numSamples = trackState.getProperty("numSamples", 0);
+		for (int i = 0; i < numTracks; ++i)
+		{
+			juce::MemoryBlock block;
+			if (!BinaryState::readBlock(stream, block))
+				return false;
 
-						juce::File fileToLoad = audioFile;
-						if (track->useOriginalFile.load() && track->hasOriginalVersion.load())
-						{
-							juce::String originalPath = audioFilePath.replace(".wav", "_original.wav");
-							juce::File originalFile(originalPath);
-							if (originalFile.existsAsFile())
-							{
-								fileToLoad = originalFile;
-								DBG("Loading original version: " + originalPath.toStdString());
-							}
-						}
+			juce::MemoryInputStream trackStream(block, false);
+			loadedTracks.push_back(readTrackBinary(trackStream));
+		}
 
-						loadAudioFileForTrack(track.get(), fileToLoad);
-						DBG("Loaded track audio from: " + fileToLoad.getFullPathName().toStdString());
-					}
-					else
-					{
-						DBG("File exists: NO");
-						DBG("Audio file not found: " + audioFilePath.toStdString());
-					}
-				}
-				else
-				{
-					DBG("No audioFilePath in state for track with slot index: " << juce::String(track->slotIndex));
-				}
-			}
+		for (auto &track : loadedTracks)
+			extractBundledAudio(*track);
 
-			if (!track->usePages.load())
-			{
-				juce::String stemsString = trackState.getProperty("preferredStems", "drums,bass");
-				track->lastPpqPosition = -1.0;
-				track->customStepCounter = 0;
-				track->sequencerData.stepAccumulator = 0.0;
-				track->preferredStems.clear();
-				if (stemsString.isNotEmpty())
-				{
-					juce::StringArray stemsArray = juce::StringArray::fromTokens(stemsString, ",", "");
-					for (const auto &stem : stemsArray)
-					{
-						track->preferredStems.push_back(stem.trim());
-					}
-				}
-			}
+		{
+			juce::ScopedLock lock(tracksLock);
+			clearTracksForLoad();
+			for (auto &track : loadedTracks)
+				adoptLoadedTrack(std::move(track));
+		}
+		refreshTrackStates();
+		return true;
+	}
 
-			auto sequencerState = trackState.getChildWithName("Sequencer");
-			if (sequencerState.isValid())
+	void loadState(const juce::ValueTree &state)
+	{
+		{
+			juce::ScopedLock lock(tracksLock);
+			clearTracksForLoad();
+			for (int i = 0; i < state.getNumChildren(); ++i)
 			{
-				track->sequencerData.isPlaying = sequencerState.getProperty("isPlaying", false);
-				track->sequencerData.currentStep = 0;
-				track->sequencerData.currentMeasure = 0;
-				track->sequencerData.numMeasures = sequencerState.getProperty("numMeasures", 1);
-				track->sequencerData.beatsPerMeasure = sequencerState.getProperty("beatsPerMeasure", 4);
-				for (int m = 0; m < 4; ++m)
+				auto trackState = state.getChild(i);
+				if (!trackState.hasType("Track"))
 				{
-					for (int s = 0; s < 16; ++s)
-					{
-						juce::String stepKey = "step_" + juce::String(m) + "_" + juce::String(s);
-						track->sequencerData.steps[m][s] = sequencerState.getProperty(stepKey, false);
-
-						juce::String velocityKey = "velocity_" + juce::String(m) + "_" + juce::String(s);
-						track->sequencerData.velocities[m][s] = sequencerState.getProperty(velocityKey, 0.8f);
-					}
+					continue;
 				}
+				adoptLoadedTrack(trackFromValueTree(trackState));
 			}
-
-			if (track->slotIndex < 0 || track->slotIndex >= 8 || usedSlots[track->slotIndex])
-			{
-				track->slotIndex = findFreeSlot();
-			}
-			if (track->slotIndex >= 0 && track->slotIndex < 8)
-			{
-				usedSlots[track->slotIndex] = true;
-			}
-
-			std::string stdId = track->trackId.toStdString();
-			tracks[stdId] = std::move(track);
-			trackOrder.push_back(stdId);
 		}
+		refreshTrackStates();
 	}
 
 	std::array<bool, 8> usedSlots{false};
 
+	// While a bundle is attached, restored tracks get their audio extracted into
+	// audioDirectory() and their paths pointed at the extracted files
+	void useSessionBundle(std::shared_ptr<SessionBundle> bundle, std::function<juce::File()> audioDirectory)
+	{
+		bundledAudio = std::move(bundle);
+		bundleAudioDirectory = std::move(audioDirectory);
+	}
+
+	void releaseSessionBundle()
+	{
+		bundledAudio.reset();
+		bundleAudioDirectory = nullptr;
+	}
+
 	void loadAudioFileForPage(TrackData *track, int pageIndex, const juce::File &audioFile)
 	{
 		if (!track || pageIndex < 0 || pageIndex >= 4)
@@ -671,9 +484,495 @@ public:
 	}
 
 private:
+	static constexpr double parameterRampSeconds = 0.02;
+	double renderSampleRate = 48000.0;
+	int renderBlockSize = 0;
+	juce::AudioBuffer<float> trackScratch;
+	juce::AudioBuffer<float> sendBus;
 	mutable juce::CriticalSection tracksLock;
-	std::unordered_map<std::string, std::unique_ptr<TrackData>> tracks;
+	std::unordered_map<std::string, std::shared_ptr<TrackData>> tracks;
 	std::vector<std::string> trackOrder;
+	juce::CriticalSection trackStatesLock;
+	std::shared_ptr<const TrackStateList> publishedTrackStates = std::make_shared<const TrackStateList>();
+	std::shared_ptr<SessionBundle> bundledAudio;
+	std::function<juce::File()> bundleAudioDirectory;
+
+	void extractBundledAudio(TrackData &track)
+	{
+		if (bundledAudio == nullptr || bundleAudioDirectory == nullptr)
+			return;
+
+		const auto directory = bundleAudioDirectory();
+		auto extract = [this, &track, &directory](int pageIndex, juce::String &audioFilePath)
+		{
+			if (audioFilePath.isEmpty())
+				return;
+
+			auto extracted = bundledAudio->extractAudio(track.trackId, pageIndex, false, directory);
+			if (extracted == juce::File())
+				return;
+
+			audioFilePath = extracted.getFullPathName();
+			bundledAudio->extractAudio(track.trackId, pageIndex, true, directory);
+		};
+
+		if (track.usePages.load())
+		{
+			for (int pageIndex = 0; pageIndex < 4; ++pageIndex)
+				extract(pageIndex, track.pages[pageIndex].audioFilePath);
+		}
+		else
+		{
+			extract(-1, track.audioFilePath);
+		}
+	}
+
+	static std::shared_ptr<const TrackState> makeTrackState(const TrackData &track)
+	{
+		auto state = std::make_shared<TrackState>();
+		state->trackId = track.trackId;
+
+		juce::MemoryOutputStream stream(state->encoded, false);
+		writeTrackBinary(stream, track);
+		stream.flush();
+
+		auto addAudio = [&state, &track](int pageIndex, const juce::String &audioFilePath)
+		{
+			if (audioFilePath.isEmpty())
+				return;
+			state->audioSources.push_back({track.trackId, pageIndex, false, juce::File(audioFilePath)});
+			state->audioSources.push_back({track.trackId, pageIndex, true, juce::File(audioFilePath.replace(".wav", "_original.wav"))});
+		};
+
+		if (track.usePages.load())
+		{
+			for (int pageIndex = 0; pageIndex < 4; ++pageIndex)
+				addAudio(pageIndex, track.pages[pageIndex].audioFilePath);
+		}
+		else
+		{
+			addAudio(-1, track.audioFilePath);
+		}
+		return state;
+	}
+
+	void clearTracksForLoad()
+	{
+		tracks.clear();
+		trackOrder.clear();
+		usedSlots.fill(false);
+	}
+
+	static std::vector<juce::String> parseStemList(const juce::String &stemsString)
+	{
+		std::vector<juce::String> stems;
+		if (stemsString.isNotEmpty())
+		{
+			juce::StringArray stemsArray = juce::StringArray::fromTokens(stemsString, ",", "");
+			for (const auto &stem : stemsArray)
+			{
+				stems.push_back(stem.trim());
+			}
+		}
+		return stems;
+	}
+
+	std::unique_ptr<TrackData> trackFromValueTree(const juce::ValueTree &trackState) const
+	{
+		auto track = std::make_unique<TrackData>();
+
+		track->trackId = trackState.getProperty("id", juce::Uuid().toString());
+		track->trackName = trackState.getProperty("name", "Track");
+		track->prompt = trackState.getProperty("prompt", "");
+		track->slotIndex = trackState.getProperty("slotIndex", -1);
+		track->style = trackState.getProperty("style", "");
+		track->stems = trackState.getProperty("stems", "");
+		track->bpm = trackState.getProperty("bpm", 126.0f);
+		track->originalBpm = trackState.getProperty("originalBpm", 126.0f);
+		track->timeStretchMode = 4;
+		track->bpmOffset = trackState.getProperty("bpmOffset", 0.0);
+		track->midiNote = trackState.getProperty("midiNote", 60);
+		track->loopStart = trackState.getProperty("loopStart", 0.0);
+		track->loopEnd = trackState.getProperty("loopEnd", 4.0);
+		track->volume = trackState.getProperty("volume", 0.8f);
+		track->pan = trackState.getProperty("pan", 0.0f);
+		track->isEnabled = trackState.getProperty("enabled", true);
+		track->fineOffset = trackState.getProperty("fineOffset", 0.0f);
+		track->timeStretchRatio = trackState.getProperty("timeStretchRatio", 1.0);
+		track->stagingOriginalBpm = trackState.getProperty("stagingOriginalBpm", 126.0f);
+		track->showWaveform = trackState.getProperty("showWaveform", false);
+		track->showSequencer = trackState.getProperty("showSequencer", false);
+		track->isMuted = trackState.getProperty("muted", false);
+		track->isSolo = trackState.getProperty("solo", false);
+		track->isPlaying = trackState.getProperty("isPlaying", false);
+		track->isArmed = trackState.getProperty("isArmed", false);
+		track->isArmedToStop = trackState.getProperty("isArmedToStop", false);
+		track->isCurrentlyPlaying = trackState.getProperty("isCurrentlyPlaying", false);
+		track->generationPrompt = trackState.getProperty("generationPrompt", "Generate a techno drum loop");
+		track->generationBpm = trackState.getProperty("generationBpm", 127.0f);
+		track->generationKey = trackState.getProperty("generationKey", "C Minor");
+		track->generationDuration = trackState.getProperty("generationDuration", 6);
+		track->loopPointsLocked = trackState.getProperty("loopPointsLocked", false);
+		track->selectedPrompt = trackState.getProperty("selectedPrompt", "");
+		track->useOriginalFile = trackState.getProperty("useOriginalFile", false);
+		track->hasOriginalVersion = trackState.getProperty("hasOriginalVersion", false);
+		track->nextHasOriginalVersion = trackState.getProperty("nextHasOriginalVersion", false);
+		track->randomRetriggerEnabled = trackState.getProperty("randomRetriggerEnabled", false);
+		track->randomRetriggerInterval = trackState.getProperty("randomRetriggerInterval", 3);
+		track->beatRepeatPending = trackState.getProperty("beatRepeatPending", false);
+		track->beatRepeatStopPending = trackState.getProperty("beatRepeatStopPending", false);
+		track->originalReadPosition = trackState.getProperty("originalReadPosition", 0.0);
+		track->beatRepeatStartPosition = trackState.getProperty("beatRepeatStartPosition", 0.0);
+		track->beatRepeatEndPosition = trackState.getProperty("beatRepeatEndPosition", 0.0);
+		track->beatRepeatActive = trackState.getProperty("beatRepeatActive", false);
+		track->randomRetriggerDurationEnabled = trackState.getProperty("randomRetriggerDurationEnabled", false);
+
+		track->usePages = trackState.getProperty("usePages", false);
+		track->currentPageIndex = trackState.getProperty("currentPageIndex", 0);
+
+		if (track->usePages.load())
+		{
+			for (int childIndex = 0; childIndex < trackState.getNumChildren(); ++childIndex)
+			{
+				auto pageState = trackState.getChild(childIndex);
+				int pageIndex = pageState.getProperty("index", -1);
+				if (!pageState.hasType("Page") || pageIndex < 0 || pageIndex >= 4)
+					continue;
+
+				auto &page = track->pages[pageIndex];
+				page.audioFilePath = pageState.getProperty("audioFilePath", "").toString();
+				page.numSamples = pageState.getProperty("numSamples", 0);
+				page.sampleRate = pageState.getProperty("sampleRate", 48000.0);
+				page.originalBpm = pageState.getProperty("originalBpm", 126.0f);
+				page.prompt = pageState.getProperty("prompt", "").toString();
+				page.selectedPrompt = pageState.getProperty("selectedPrompt", "").toString();
+				page.generationPrompt = pageState.getProperty("generationPrompt", "").toString();
+				page.generationBpm = pageState.getProperty("generationBpm", 126.0f);
+				page.generationKey = pageState.getProperty("generationKey", "").toString();
+				page.generationDuration = pageState.getProperty("generationDuration", 6);
+				page.stems = pageState.getProperty("stems", "").toString();
+				page.loopStart = pageState.getProperty("loopStart", 0.0);
+				page.loopEnd = pageState.getProperty("loopEnd", 4.0);
+				page.useOriginalFile = pageState.getProperty("useOriginalFile", false);
+				page.hasOriginalVersion = pageState.getProperty("hasOriginalVersion", false);
+				page.isLoaded = false;
+				page.preferredStems = parseStemList(pageState.getProperty("preferredStems", "").toString());
+			}
+		}
+		else
+		{
+			track->audioFilePath = trackState.getProperty("audioFilePath", "").toString();
+			track->sampleRate = trackState.getProperty("sampleRate", 48000.0);
+			track->numSamples = trackState.getProperty("numSamples", 0);
+			track->preferredStems = parseStemList(trackState.getProperty("preferredStems", "drums,bass"));
+		}
+
+		auto sequencerState = trackState.getChildWithName("Sequencer");
+		if (sequencerState.isValid())
+		{
+			track->sequencerData.isPlaying = sequencerState.getProperty("isPlaying", false);
+			track->sequencerData.numMeasures = sequencerState.getProperty("numMeasures", 1);
+			track->sequencerData.beatsPerMeasure = sequencerState.getProperty("beatsPerMeasure", 4);
+			auto &pattern = track->sequencerData.pattern;
+			if (!pattern.fromBase64(sequencerState.getProperty("pattern").toString()))
+			{
+				pattern.clear();
+				for (int m = 0; m < 4; ++m)
+				{
+					for (int s = 0; s < 16; ++s)
+					{
+						juce::String stepKey = "step_" + juce::String(m) + "_" + juce::String(s);
+						pattern.setActive(m, s, sequencerState.getProperty(stepKey, false));
+
+						juce::String velocityKey = "velocity_" + juce::String(m) + "_" + juce::String(s);
+						pattern.setVelocity(m, s, sequencerState.getProperty(velocityKey, SequencerPattern::defaultVelocity));
+					}
+				}
+			}
+		}
+
+		return track;
+	}
+
+	static void writeTrackBinary(juce::OutputStream &stream, const TrackData &track)
+	{
+		// Paged tracks mirror these strings from the current page on the audio thread, so only the pages are written
+		const bool usesPages = track.usePages.load();
+		const bool hasLegacyAudio = !usesPages && track.numSamples > 0 && track.audioFilePath.isNotEmpty();
+		auto unlessPaged = [usesPages](const juce::String &text)
+		{ return usesPages ? juce::String() : text; };
+
+		BinaryState::writeString(stream, track.trackId);
+		BinaryState::writeString(stream, track.trackName);
+		BinaryState::writeString(stream, unlessPaged(track.prompt));
+		BinaryState::writeString(stream, track.style);
+		BinaryState::writeString(stream, unlessPaged(track.stems));
+		BinaryState::writeString(stream, unlessPaged(track.generationPrompt));
+		BinaryState::writeString(stream, unlessPaged(track.generationKey));
+		BinaryState::writeString(stream, unlessPaged(track.selectedPrompt));
+		BinaryState::writeString(stream, hasLegacyAudio ? track.audioFilePath : juce::String());
+
+		stream.writeCompressedInt(track.slotIndex);
+		stream.writeCompressedInt(track.midiNote);
+		stream.writeCompressedInt(track.generationDuration);
+		stream.writeCompressedInt(track.randomRetriggerInterval.load());
+		stream.writeCompressedInt(track.currentPageIndex);
+		stream.writeCompressedInt(hasLegacyAudio ? track.numSamples : 0);
+
+		stream.writeFloat(track.bpm);
+		stream.writeFloat(track.originalBpm);
+		stream.writeFloat(track.volume.load());
+		stream.writeFloat(track.pan.load());
+		stream.writeFloat(track.fineOffset);
+		stream.writeFloat(track.stagingOriginalBpm);
+		stream.writeFloat(track.generationBpm);
+
+		stream.writeDouble(track.bpmOffset);
+		stream.writeDouble(track.loopStart);
+		stream.writeDouble(track.loopEnd);
+		stream.writeDouble(track.timeStretchRatio);
+		stream.writeDouble(track.originalReadPosition.load());
+		stream.writeDouble(track.beatRepeatStartPosition.load());
+		stream.writeDouble(track.beatRepeatEndPosition.load());
+		stream.writeDouble(track.sampleRate);
+
+		stream.writeInt((int)BinaryState::packFlags({track.isMuted.load(), track.isSolo.load(), track.isEnabled.load(),
+													  track.showWaveform, track.showSequencer, track.isPlaying.load(),
+													  track.isArmed.load(), track.isArmedToStop.load(), track.isCurrentlyPlaying.load(),
+													  track.loopPointsLocked.load(), track.useOriginalFile.load(), track.hasOriginalVersion.load(),
+													  track.nextHasOriginalVersion.load(), track.randomRetriggerEnabled.load(),
+													  track.beatRepeatPending.load(), track.beatRepeatStopPending.load(),
+													  track.beatRepeatActive.load(), track.randomRetriggerDurationEnabled.load(),
+													  track.usePages.load(), track.sequencerData.isPlaying}));
+		BinaryState::writeStringList(stream, usesPages ? std::vector<juce::String>() : track.preferredStems);
+
+		const int numPages = usesPages ? 4 : 0;
+		stream.writeByte((char)numPages);
+		for (int pageIndex = 0; pageIndex < numPages; ++pageIndex)
+		{
+			const auto &page = track.pages[pageIndex];
+			BinaryState::writeString(stream, page.audioFilePath);
+			BinaryState::writeString(stream, page.prompt);
+			BinaryState::writeString(stream, page.selectedPrompt);
+			BinaryState::writeString(stream, page.generationPrompt);
+			BinaryState::writeString(stream, page.generationKey);
+			BinaryState::writeString(stream, page.stems);
+			stream.writeCompressedInt(page.numSamples);
+			stream.writeCompressedInt(page.generationDuration);
+			stream.writeFloat(page.originalBpm);
+			stream.writeFloat(page.generationBpm);
+			stream.writeDouble(page.sampleRate);
+			stream.writeDouble(page.loopStart);
+			stream.writeDouble(page.loopEnd);
+			stream.writeByte((char)BinaryState::packFlags({page.useOriginalFile.load(), page.hasOriginalVersion.load()}));
+			BinaryState::writeStringList(stream, page.preferredStems);
+		}
+
+		stream.writeByte((char)track.sequencerData.numMeasures);
+		stream.writeByte((char)track.sequencerData.beatsPerMeasure);
+		track.sequencerData.pattern.writeTo(stream);
+	}
+
+	static std::unique_ptr<TrackData> readTrackBinary(juce::InputStream &stream)
+	{
+		auto track = std::make_unique<TrackData>();
+
+		track->trackId = BinaryState::readString(stream);
+		if (track->trackId.isEmpty())
+			track->trackId = juce::Uuid().toString();
+		track->trackName = BinaryState::readString(stream);
+		track->prompt = BinaryState::readString(stream);
+		track->style = BinaryState::readString(stream);
+		track->stems = BinaryState::readString(stream);
+		track->generationPrompt = BinaryState::readString(stream);
+		track->generationKey = BinaryState::readString(stream);
+		track->selectedPrompt = BinaryState::readString(stream);
+		track->audioFilePath = BinaryState::readString(stream);
+
+		track->slotIndex = stream.readCompressedInt();
+		track->midiNote = stream.readCompressedInt();
+		track->generationDuration = stream.readCompressedInt();
+		track->randomRetriggerInterval = stream.readCompressedInt();
+		track->currentPageIndex = juce::jlimit(0, 3, stream.readCompressedInt());
+		track->numSamples = stream.readCompressedInt();
+
+		track->bpm = stream.readFloat();
+		track->originalBpm = stream.readFloat();
+		track->volume = stream.readFloat();
+		track->pan = stream.readFloat();
+		track->fineOffset = stream.readFloat();
+		track->stagingOriginalBpm = stream.readFloat();
+		track->generationBpm = stream.readFloat();
+
+		track->bpmOffset = stream.readDouble();
+		track->loopStart = stream.readDouble();
+		track->loopEnd = stream.readDouble();
+		track->timeStretchRatio = stream.readDouble();
+		track->originalReadPosition = stream.readDouble();
+		track->beatRepeatStartPosition = stream.readDouble();
+		track->beatRepeatEndPosition = stream.readDouble();
+		track->sampleRate = stream.readDouble();
+
+		const auto flags = (juce::uint32)stream.readInt();
+		track->isMuted = BinaryState::flag(flags, 0);
+		track->isSolo = BinaryState::flag(flags, 1);
+		track->isEnabled = BinaryState::flag(flags, 2);
+		track->showWaveform = BinaryState::flag(flags, 3);
+		track->showSequencer = BinaryState::flag(flags, 4);
+		track->isPlaying = BinaryState::flag(flags, 5);
+		track->isArmed = BinaryState::flag(flags, 6);
+		track->isArmedToStop = BinaryState::flag(flags, 7);
+		track->isCurrentlyPlaying = BinaryState::flag(flags, 8);
+		track->loopPointsLocked = BinaryState::flag(flags, 9);
+		track->useOriginalFile = BinaryState::flag(flags, 10);
+		track->hasOriginalVersion = BinaryState::flag(flags, 11);
+		track->nextHasOriginalVersion = BinaryState::flag(flags, 12);
+		track->randomRetriggerEnabled = BinaryState::flag(flags, 13);
+		track->beatRepeatPending = BinaryState::flag(flags, 14);
+		track->beatRepeatStopPending = BinaryState::flag(flags, 15);
+		track->beatRepeatActive = BinaryState::flag(flags, 16);
+		track->randomRetriggerDurationEnabled = BinaryState::flag(flags, 17);
+		track->usePages = BinaryState::flag(flags, 18);
+		track->sequencerData.isPlaying = BinaryState::flag(flags, 19);
+		track->preferredStems = BinaryState::readStringList(stream);
+
+		const int numPages = juce::jmin(4, (int)(juce::uint8)stream.readByte());
+		for (int pageIndex = 0; pageIndex < numPages; ++pageIndex)
+		{
+			auto &page = track->pages[pageIndex];
+			page.audioFilePath = BinaryState::readString(stream);
+			page.prompt = BinaryState::readString(stream);
+			page.selectedPrompt = BinaryState::readString(stream);
+			page.generationPrompt = BinaryState::readString(stream);
+			page.generationKey = BinaryState::readString(stream);
+			page.stems = BinaryState::readString(stream);
+			page.numSamples = stream.readCompressedInt();
+			page.generationDuration = stream.readCompressedInt();
+			page.originalBpm = stream.readFloat();
+			page.generationBpm = stream.readFloat();
+			page.sampleRate = stream.readDouble();
+			page.loopStart = stream.readDouble();
+			page.loopEnd = stream.readDouble();
+			const auto pageFlags = (juce::uint32)(juce::uint8)stream.readByte();
+			page.useOriginalFile = BinaryState::flag(pageFlags, 0);
+			page.hasOriginalVersion = BinaryState::flag(pageFlags, 1);
+			page.isLoaded = false;
+			page.preferredStems = BinaryState::readStringList(stream);
+		}
+
+		track->sequencerData.numMeasures = juce::jmax(1, (int)(juce::uint8)stream.readByte());
+		track->sequencerData.beatsPerMeasure = juce::jmax(1, (int)(juce::uint8)stream.readByte());
+		if (!track->sequencerData.pattern.readFrom(stream))
+			track->sequencerData.pattern.clear();
+
+		return track;
+	}
+
+	void adoptLoadedTrack(std::unique_ptr<TrackData> track)
+	{
+		track->sequencerData.currentStep = 0;
+		track->sequencerData.currentMeasure = 0;
+		track->sequencerData.stepAccumulator = 0.0;
+		track->sequencerClock.reset();
+
+		if (track->usePages.load())
+		{
+			DBG("Loading track " << track->trackName << " with pages system");
+
+			for (int pageIndex = 0; pageIndex < 4; ++pageIndex)
+			{
+				auto &page = track->pages[pageIndex];
+				if (page.audioFilePath.isEmpty())
+				{
+					DBG("Page " << pageIndex << " state not found - empty page");
+					continue;
+				}
+
+				juce::File audioFile(page.audioFilePath);
+				if (audioFile.existsAsFile())
+				{
+					DBG("Loading page " << (char)('A' + pageIndex) << " from: " << audioFile.getFullPathName());
+					loadAudioFileForPage(track.get(), pageIndex, audioFile);
+				}
+				else
+				{
+					DBG("Page " << (char)('A' + pageIndex) << " file not found: " << page.audioFilePath);
+					juce::String fileName = audioFile.getFileName();
+					if (fileName.contains("_" + juce::String('A' + pageIndex)))
+					{
+						char pageName = static_cast<char>('A' + pageIndex);
+						juce::String newFileName = fileName.replace("_" + juce::String('A' + pageIndex), "_" + juce::String(pageName));
+						juce::File newFile = audioFile.getParentDirectory().getChildFile(newFileName);
+
+						if (newFile.existsAsFile())
+						{
+							DBG("Found file with new naming: " << newFile.getFullPathName());
+							loadAudioFileForPage(track.get(), pageIndex, newFile);
+							page.audioFilePath = newFile.getFullPathName();
+						}
+					}
+				}
+			}
+
+			track->syncLegacyProperties();
+			DBG("Track " << track->trackName << " loaded in pages mode - current page: " << (char)('A' + track->currentPageIndex) << " with " << track->numSamples << " samples");
+		}
+		else
+		{
+			DBG("Loading track " << track->trackName << " in legacy mode");
+			juce::String audioFilePath = track->audioFilePath;
+			track->audioFilePath = {};
+			if (audioFilePath.isNotEmpty())
+			{
+				juce::File audioFile(audioFilePath);
+				DBG("LOADING STATE - audioFilePath: " + audioFilePath.toStdString());
+				if (audioFile.existsAsFile())
+				{
+					DBG("File exists: YES");
+					track->audioFilePath = audioFilePath;
+
+					juce::File fileToLoad = audioFile;
+					if (track->useOriginalFile.load() && track->hasOriginalVersion.load())
+					{
+						juce::String originalPath = audioFilePath.replace(".wav", "_original.wav");
+						juce::File originalFile(originalPath);
+						if (originalFile.existsAsFile())
+						{
+							fileToLoad = originalFile;
+							DBG("Loading original version: " + originalPath.toStdString());
+						}
+					}
+
+					loadAudioFileForTrack(track.get(), fileToLoad);
+					DBG("Loaded track audio from: " + fileToLoad.getFullPathName().toStdString());
+				}
+				else
+				{
+					DBG("File exists: NO");
+					DBG("Audio file not found: " + audioFilePath.toStdString());
+					track->numSamples = 0;
+				}
+			}
+			else
+			{
+				DBG("No audioFilePath in state for track with slot index: " << juce::String(track->slotIndex));
+				track->numSamples = 0;
+			}
+		}
+
+		if (track->slotIndex < 0 || track->slotIndex >= 8 || usedSlots[track->slotIndex])
+		{
+			track->slotIndex = findFreeSlot();
+		}
+		if (track->slotIndex >= 0 && track->slotIndex < 8)
+		{
+			usedSlots[track->slotIndex] = true;
+		}
+
+		std::string stdId = track->trackId.toStdString();
+		tracks[stdId] = std::move(track);
+		trackOrder.push_back(stdId);
+	}
 
 	int findFreeSlot()
 	{
@@ -717,9 +1016,8 @@ private:
 	}
 
 	void renderSingleTrack(TrackData &track,
-						   juce::AudioBuffer<float> &mixOutput,
-						   juce::AudioBuffer<float> &individualOutput,
-						   int numSamples, int /*trackIndex*/, double hostBpm) const
+						   juce::AudioBuffer<float> &trackOutput,
+						   int numSamples, double hostBpm) const
 	{
 		if (parameterUpdateCallback)
 		{
@@ -760,8 +1058,8 @@ private:
 		if (numSamplesToUse == 0 || !track.isPlaying.load() || !bufferToUse)
 			return;
 
-		const float volume = juce::jlimit(0.0f, 1.0f, track.volume.load());
-		const float pan = juce::jlimit(-1.0f, 1.0f, track.pan.load());
+		const float targetVolume = juce::jlimit(0.0f, 1.0f, track.volume.load());
+		const float targetPan = juce::jlimit(-1.0f, 1.0f, track.pan.load());
 		double currentPosition = track.readPosition.load();
 		double playbackRatio = 1.0;
 
@@ -796,6 +1094,21 @@ private:
 			break;
 		}
 
+		playbackRatio = juce::jmax(1.0e-3, playbackRatio);
+		if (track.smoothingSampleRate != renderSampleRate)
+		{
+			track.smoothedVolume.reset(renderSampleRate, parameterRampSeconds);
+			track.smoothedPan.reset(renderSampleRate, parameterRampSeconds);
+			track.smoothedPlaybackRatio.reset(renderSampleRate, parameterRampSeconds);
+			track.smoothedVolume.setCurrentAndTargetValue(targetVolume);
+			track.smoothedPan.setCurrentAndTargetValue(targetPan);
+			track.smoothedPlaybackRatio.setCurrentAndTargetValue(playbackRatio);
+			track.smoothingSampleRate = renderSampleRate;
+		}
+		track.smoothedVolume.setTargetValue(targetVolume);
+		track.smoothedPan.setTargetValue(targetPan);
+		track.smoothedPlaybackRatio.setTargetValue(playbackRatio);
+
 		double startSample = loopStartToUse * sampleRateToUse;
 		double endSample = loopEndToUse * sampleRateToUse;
 
@@ -811,18 +1124,38 @@ private:
 			sectionLength = numSamplesToUse;
 		}
 
+		bool voiceActive = !track.silentUntilFirstVoiceTrigger;
+		int nextVoiceTrigger = 0;
+
 		for (int i = 0; i < numSamples; ++i)
 		{
-			if (track.beatRepeatActive.load())
+			const float volume = track.smoothedVolume.getNextValue();
+			const float pan = track.smoothedPan.getNextValue();
+			const double sampleRatio = track.smoothedPlaybackRatio.getNextValue();
+			while (nextVoiceTrigger < track.numVoiceTriggers && track.voiceTriggerOffsets[nextVoiceTrigger] <= i)
 			{
-				double beatRepeatStart = track.beatRepeatStartPosition.load();
-				double beatRepeatEnd = track.beatRepeatEndPosition.load();
-				if (track.readPosition.load() >= beatRepeatEnd)
+				if (!track.beatRepeatActive.load())
 				{
-					currentPosition = beatRepeatStart - startSample;
-					track.readPosition.store(beatRepeatStart);
+					currentPosition = 0.0;
 				}
+				voiceActive = true;
+				track.isPlaying = true;
+				++nextVoiceTrigger;
+			}
+			if (i == track.beatRepeatStartOffset)
+			{
+				startBeatRepeat(track, currentPosition, sectionLength);
 			}
+			if (i == track.beatRepeatStopOffset)
+			{
+				currentPosition = stopBeatRepeat(track);
+			}
+			if (track.beatRepeatActive.load() && currentPosition >= track.beatRepeatEndPosition.load())
+			{
+				currentPosition = track.beatRepeatStartPosition.load();
+			}
+			if (!voiceActive)
+				continue;
 			double absolutePosition = startSample + currentPosition;
 			float leftGain = 1.0f;
 			float rightGain = 1.0f;
@@ -838,9 +1171,11 @@ private:
 			if (absolutePosition >= endSample)
 			{
 				currentPosition = 0.0;
-				absolutePosition = startSample;
 				track.isPlaying = false;
-				return;
+				if (nextVoiceTrigger >= track.numVoiceTriggers)
+					return;
+				voiceActive = false;
+				continue;
 			}
 
 			if (absolutePosition >= numSamplesToUse)
@@ -877,14 +1212,43 @@ private:
 					fadeGain = juce::jlimit(0.0f, 1.0f, fadeGain);
 					sample *= fadeGain;
 				}
-				mixOutput.addSample(ch, i, sample);
-				individualOutput.setSample(ch, i, sample);
+				trackOutput.setSample(ch, i, sample);
 			}
-			currentPosition += playbackRatio;
+			currentPosition += sampleRatio;
 		}
 		track.readPosition = currentPosition;
 	}
 
+	static void startBeatRepeat(TrackData &track, double position, double sectionLength)
+	{
+		track.originalReadPosition.store(position);
+		track.beatRepeatStartPosition.store(position);
+		track.beatRepeatEndPosition.store(juce::jmin(position + track.beatRepeatLengthSamples, sectionLength));
+		track.beatRepeatActive.store(true);
+		track.beatRepeatStartOffset = -1;
+	}
+
+	static double stopBeatRepeat(TrackData &track)
+	{
+		track.beatRepeatActive.store(false);
+		track.randomRetriggerActive.store(false);
+		track.lastRetriggerTime.store(-1.0);
+		track.beatRepeatStopOffset = -1;
+		return track.originalReadPosition.load();
+	}
+
+	static void flushBeatRepeatEvents(TrackData &track)
+	{
+		if (track.beatRepeatStartOffset >= 0)
+		{
+			startBeatRepeat(track, track.readPosition.load(), (double)track.numSamples);
+		}
+		if (track.beatRepeatStopOffset >= 0)
+		{
+			track.readPosition = stopBeatRepeat(track);
+		}
+	}
+
 	float interpolateLinear(const float *buffer, double position, int bufferSize) const
 	{
 		int index = static_cast<int>(position);
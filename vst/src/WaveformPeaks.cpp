@@ -0,0 +1,180 @@
+#include "WaveformPeaks.h"
+#include <numeric>
+
+bool WaveformPeaks::write(const juce::File &audioFile, const juce::File &peakFile)
+{
+	juce::AudioFormatManager formatManager;
+	formatManager.registerBasicFormats();
+
+	std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(audioFile));
+	if (!reader || reader->lengthInSamples <= 0 || reader->numChannels == 0)
+		return false;
+
+	std::vector<Level> levels;
+	levels.push_back(makeBaseLevel(reader->lengthInSamples));
+
+	constexpr int chunkSize = baseSamplesPerPeak * 256;
+	juce::AudioBuffer<float> chunk((int)reader->numChannels, chunkSize);
+	for (juce::int64 position = 0; position < reader->lengthInSamples; position += chunkSize)
+	{
+		const int numSamples = (int)std::min<juce::int64>(chunkSize, reader->lengthInSamples - position);
+		if (!reader->read(&chunk, 0, numSamples, position, true, true))
+			return false;
+		addBasePeaks(levels[0], chunk, numSamples, position);
+	}
+
+	return writeLevels(std::move(levels), (int)reader->numChannels, reader->sampleRate, reader->lengthInSamples, peakFile);
+}
+
+bool WaveformPeaks::write(const juce::AudioBuffer<float> &audio, double sampleRate, const juce::File &peakFile)
+{
+	if (audio.getNumSamples() <= 0 || audio.getNumChannels() == 0)
+		return false;
+
+	std::vector<Level> levels;
+	levels.push_back(makeBaseLevel(audio.getNumSamples()));
+	addBasePeaks(levels[0], audio, audio.getNumSamples(), 0);
+	return writeLevels(std::move(levels), audio.getNumChannels(), sampleRate, audio.getNumSamples(), peakFile);
+}
+
+WaveformPeaks::Level WaveformPeaks::makeBaseLevel(juce::int64 lengthInSamples)
+{
+	Level base;
+	base.samplesPerPeak = baseSamplesPerPeak;
+	const auto numBasePeaks = (size_t)((lengthInSamples + baseSamplesPerPeak - 1) / baseSamplesPerPeak);
+	base.minimum.assign(numBasePeaks, 0.0f);
+	base.maximum.assign(numBasePeaks, 0.0f);
+	base.meanSquare.assign(numBasePeaks, 0.0f);
+	return base;
+}
+
+void WaveformPeaks::addBasePeaks(Level &base, const juce::AudioBuffer<float> &chunk, int numSamples, juce::int64 position)
+{
+	for (int start = 0; start < numSamples; start += baseSamplesPerPeak)
+	{
+		const auto peak = (size_t)((position + start) / baseSamplesPerPeak);
+		const int count = std::min(baseSamplesPerPeak, numSamples - start);
+		float low = 0.0f, high = 0.0f, squares = 0.0f;
+		for (int ch = 0; ch < chunk.getNumChannels(); ++ch)
+		{
+			const auto range = juce::FloatVectorOperations::findMinAndMax(chunk.getReadPointer(ch, start), count);
+			low = std::min(low, range.getStart());
+			high = std::max(high, range.getEnd());
+			const float rms = chunk.getRMSLevel(ch, start, count);
+			squares += rms * rms;
+		}
+		base.minimum[peak] = low;
+		base.maximum[peak] = high;
+		base.meanSquare[peak] = squares / (float)chunk.getNumChannels();
+	}
+}
+
+bool WaveformPeaks::writeLevels(std::vector<Level> levels, int numChannels, double sampleRate, juce::int64 lengthInSamples, const juce::File &peakFile)
+{
+	while (levels.back().minimum.size() > (size_t)minimumLevelPeaks * levelFactor)
+	{
+		const auto &finer = levels.back();
+		Level coarser;
+		coarser.samplesPerPeak = finer.samplesPerPeak * levelFactor;
+		for (size_t i = 0; i < finer.minimum.size(); i += levelFactor)
+		{
+			const size_t end = std::min(finer.minimum.size(), i + levelFactor);
+			coarser.minimum.push_back(*std::min_element(finer.minimum.begin() + (std::ptrdiff_t)i, finer.minimum.begin() + (std::ptrdiff_t)end));
+			coarser.maximum.push_back(*std::max_element(finer.maximum.begin() + (std::ptrdiff_t)i, finer.maximum.begin() + (std::ptrdiff_t)end));
+			coarser.meanSquare.push_back(std::accumulate(finer.meanSquare.begin() + (std::ptrdiff_t)i, finer.meanSquare.begin() + (std::ptrdiff_t)end, 0.0f) / (float)(end - i));
+		}
+		levels.push_back(std::move(coarser));
+	}
+
+	juce::TemporaryFile tempFile(peakFile);
+	{
+		juce::FileOutputStream stream(tempFile.getFile());
+		if (!stream.openedOk())
+			return false;
+
+		stream.writeInt(magic);
+		stream.writeInt(formatVersion);
+		stream.writeInt(numChannels);
+		stream.writeInt((int)levels.size());
+		stream.writeDouble(sampleRate);
+		stream.writeInt64(lengthInSamples);
+
+		juce::int64 offset = headerSize + levelEntrySize * (juce::int64)levels.size();
+		for (const auto &level : levels)
+		{
+			stream.writeInt(level.samplesPerPeak);
+			stream.writeInt((int)level.minimum.size());
+			stream.writeInt64(offset);
+			offset += bytesPerPeak * (juce::int64)level.minimum.size();
+		}
+
+		std::vector<juce::uint8> bytes;
+		for (const auto &level : levels)
+		{
+			bytes.resize(level.minimum.size() * bytesPerPeak);
+			for (size_t i = 0; i < level.minimum.size(); ++i)
+			{
+				bytes[i * bytesPerPeak] = (juce::uint8)(juce::int8)juce::roundToInt(juce::jlimit(-1.0f, 1.0f, level.minimum[i]) * 127.0f);
+				bytes[i * bytesPerPeak + 1] = (juce::uint8)(juce::int8)juce::roundToInt(juce::jlimit(-1.0f, 1.0f, level.maximum[i]) * 127.0f);
+				bytes[i * bytesPerPeak + 2] = (juce::uint8)juce::roundToInt(juce::jlimit(0.0f, 1.0f, std::sqrt(level.meanSquare[i])) * 255.0f);
+			}
+			stream.write(bytes.data(), bytes.size());
+		}
+
+		stream.flush();
+		if (stream.getStatus().failed())
+			return false;
+	}
+
+	return tempFile.overwriteTargetFileWithTemporary();
+}
+
+std::vector<float> WaveformPeaks::read(const juce::File &peakFile, int minimumPoints)
+{
+	juce::FileInputStream stream(peakFile);
+	if (!stream.openedOk() || stream.getTotalLength() < headerSize)
+		return {};
+
+	if (stream.readInt() != magic || stream.readInt() != formatVersion)
+		return {};
+	stream.readInt();
+	const int numLevels = stream.readInt();
+	stream.readDouble();
+	stream.readInt64();
+	if (numLevels <= 0 || headerSize + levelEntrySize * (juce::int64)numLevels > stream.getTotalLength())
+		return {};
+
+	int numPeaks = 0;
+	juce::int64 dataOffset = 0;
+	for (int i = 0; i < numLevels; ++i)
+	{
+		stream.readInt();
+		const int levelPeaks = stream.readInt();
+		const juce::int64 levelOffset = stream.readInt64();
+
+		// Levels run fine to coarse, so the last one still wide enough wins
+		if (i == 0 || levelPeaks >= minimumPoints)
+		{
+			numPeaks = levelPeaks;
+			dataOffset = levelOffset;
+		}
+	}
+
+	if (numPeaks <= 0 || dataOffset + bytesPerPeak * (juce::int64)numPeaks > stream.getTotalLength())
+		return {};
+
+	std::vector<juce::uint8> bytes((size_t)numPeaks * bytesPerPeak);
+	stream.setPosition(dataOffset);
+	if (stream.read(bytes.data(), (int)bytes.size()) != (int)bytes.size())
+		return {};
+
+	std::vector<float> values((size_t)numPeaks);
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		const float low = std::abs((float)(juce::int8)bytes[i * bytesPerPeak]) / 127.0f;
+		const float high = std::abs((float)(juce::int8)bytes[i * bytesPerPeak + 1]) / 127.0f;
+		const float rms = bytes[i * bytesPerPeak + 2] / 255.0f;
+		values[i] = rms * 0.7f + std::max(low, high) * 0.3f;
+	}
+	return values;
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "JuceHeader.h"
+#include <vector>
+
+class WaveformPeaks
+{
+public:
+	static juce::File fileFor(const juce::File &audioFile) { return audioFile.withFileExtension(".peaks"); }
+
+	// One sequential decode; stores min/max/RMS per block at several resolutions
+	static bool write(const juce::File &audioFile, const juce::File &peakFile);
+	static bool write(const juce::AudioBuffer<float> &audio, double sampleRate, const juce::File &peakFile);
+
+	// Reads the coarsest level holding at least minimumPoints blocks and folds each
+	// block to the 70% RMS / 30% peak blend the bank thumbnails draw
+	static std::vector<float> read(const juce::File &peakFile, int minimumPoints);
+
+private:
+	struct Level
+	{
+		int samplesPerPeak = 0;
+		std::vector<float> minimum, maximum, meanSquare;
+	};
+
+	static Level makeBaseLevel(juce::int64 lengthInSamples);
+	static void addBasePeaks(Level &base, const juce::AudioBuffer<float> &chunk, int numSamples, juce::int64 position);
+	static bool writeLevels(std::vector<Level> levels, int numChannels, double sampleRate, juce::int64 lengthInSamples, const juce::File &peakFile);
+
+	static constexpr int magic = 0x534b504f;
+	static constexpr int formatVersion = 1;
+	static constexpr int baseSamplesPerPeak = 256;
+	static constexpr int levelFactor = 4;
+	static constexpr int minimumLevelPeaks = 64;
+	static constexpr int bytesPerPeak = 3;
+	static constexpr int headerSize = 32;
+	static constexpr int levelEntrySize = 16;
+};
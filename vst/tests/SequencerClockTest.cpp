@@ -0,0 +1,131 @@
+#include "SequencerClock.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <vector>
+
+namespace
+{
+	int failures = 0;
+
+	void expect(bool condition, const char *what, double bpm, int blockSize, long long step)
+	{
+		if (condition)
+			return;
+		++failures;
+		std::printf("FAIL: %s (bpm %.1f, block %d, step %lld)\n", what, bpm, blockSize, step);
+	}
+
+	struct FakeSequencer
+	{
+		int activeEvery = 1;
+		int patternLength = 16;
+		int maxTriggersPerBlock = 16;
+		bool swing = false;
+
+		long long blockStartSample = 0;
+		int triggersThisBlock = 0;
+		std::map<int, std::vector<long long>> firedAt;
+
+		bool isActive(int stepCounter) const { return stepCounter % patternLength % activeEvery == 0; }
+
+		int stepsUntilNextEvent(int stepCounter)
+		{
+			int position = stepCounter % patternLength;
+			int toActive = activeEvery - position % activeEvery;
+			return SequencerClock::stepsUntilNextEvent(0, position, patternLength, 1, toActive);
+		}
+
+		bool canTrigger() const { return triggersThisBlock < maxTriggersPerBlock; }
+
+		double microTiming(int stepCounter) const
+		{
+			static const double offsets[] = {0.0, 0.5, -0.5, 0.25, -0.37, 0.49, -0.12, 0.0};
+			return swing ? offsets[stepCounter % 8] : 0.0;
+		}
+
+		bool advanceStep(int stepCounter) { return isActive(stepCounter); }
+		bool canDecideEarly(int) const { return true; }
+		bool stepWillSound(int stepCounter) { return isActive(stepCounter); }
+
+		void trigger(int stepCounter, int sampleOffset)
+		{
+			++triggersThisBlock;
+			firedAt[stepCounter].push_back(blockStartSample + sampleOffset);
+		}
+
+		void idleAt(int) {}
+	};
+
+	void runPlayhead(double bpm, double sampleRate, int blockSize, int activeEvery, bool swing, double seconds)
+	{
+		SequencerClock clock;
+		FakeSequencer sequencer;
+		sequencer.activeEvery = activeEvery;
+		sequencer.swing = swing;
+
+		const double ppqPerSample = bpm / (60.0 * sampleRate);
+		const long long numBlocks = (long long)(seconds * sampleRate) / blockSize;
+		const long long totalSamples = numBlocks * blockSize;
+
+		for (long long start = 0; start < totalSamples; start += blockSize)
+		{
+			sequencer.blockStartSample = start;
+			sequencer.triggersThisBlock = 0;
+			clock.process(start * ppqPerSample, ppqPerSample, blockSize, sequencer.maxTriggersPerBlock, sequencer);
+		}
+
+		const double lastSamplePpq = (totalSamples - 1 + 1.0e-6) * ppqPerSample;
+		const int lastStep = (int)std::floor(lastSamplePpq / SequencerClock::stepInPpq) + 1;
+
+		for (int step = 0; step <= lastStep; ++step)
+		{
+			const double triggerPpq = (step + sequencer.microTiming(step)) * SequencerClock::stepInPpq;
+			const bool shouldFire = sequencer.isActive(step) && triggerPpq <= lastSamplePpq;
+			auto it = sequencer.firedAt.find(step);
+
+			if (!shouldFire)
+			{
+				expect(it == sequencer.firedAt.end(), "step fired outside the playhead or while inactive",
+					   bpm, blockSize, step);
+				continue;
+			}
+
+			expect(it != sequencer.firedAt.end() && it->second.size() == 1, "step did not fire exactly once",
+				   bpm, blockSize, step);
+			if (it == sequencer.firedAt.end() || it->second.empty())
+				continue;
+
+			const double expectedSample = std::max(0.0, triggerPpq / ppqPerSample);
+			expect(std::abs(it->second.front() - expectedSample) <= 1.0, "step fired more than one sample from its ppq",
+				   bpm, blockSize, step);
+		}
+	}
+}
+
+int main()
+{
+	const double tempos[] = {60.0, 120.0, 174.0, 199.5};
+	const int blockSizes[] = {32, 64, 128, 256, 441, 512, 1024, 2048, 4096};
+
+	for (double bpm : tempos)
+	{
+		for (int blockSize : blockSizes)
+		{
+			runPlayhead(bpm, 44100.0, blockSize, 1, false, 30.0);
+			runPlayhead(bpm, 48000.0, blockSize, 3, false, 30.0);
+			runPlayhead(bpm, 44100.0, blockSize, 1, true, 30.0);
+			runPlayhead(bpm, 48000.0, blockSize, 3, true, 30.0);
+		}
+	}
+
+	if (failures > 0)
+	{
+		std::printf("%d sequencer clock checks failed\n", failures);
+		return EXIT_FAILURE;
+	}
+
+	std::printf("Sequencer clock checks passed\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,262 @@
+#include "TrackManager.h"
+#include <iostream>
+
+namespace
+{
+	constexpr int numTracks = 64;
+	constexpr int numTimingRuns = 50;
+
+	juce::String joinStems(const std::vector<juce::String> &stems)
+	{
+		juce::StringArray parts;
+		for (const auto &stem : stems)
+			parts.add(stem);
+		return parts.joinIntoString(",");
+	}
+
+	// Mirror of the ValueTree layout getStateInformation wrote before the binary format
+	juce::ValueTree legacyTrackTree(const TrackData &track)
+	{
+		juce::ValueTree trackState("Track");
+		trackState.setProperty("id", track.trackId, nullptr);
+		trackState.setProperty("name", track.trackName, nullptr);
+		trackState.setProperty("slotIndex", track.slotIndex, nullptr);
+		trackState.setProperty("prompt", track.prompt, nullptr);
+		trackState.setProperty("style", track.style, nullptr);
+		trackState.setProperty("stems", track.stems, nullptr);
+		trackState.setProperty("bpm", track.bpm, nullptr);
+		trackState.setProperty("originalBpm", track.originalBpm, nullptr);
+		trackState.setProperty("timeStretchMode", track.timeStretchMode, nullptr);
+		trackState.setProperty("bpmOffset", track.bpmOffset, nullptr);
+		trackState.setProperty("midiNote", track.midiNote, nullptr);
+		trackState.setProperty("loopStart", track.loopStart, nullptr);
+		trackState.setProperty("loopEnd", track.loopEnd, nullptr);
+		trackState.setProperty("volume", track.volume.load(), nullptr);
+		trackState.setProperty("pan", track.pan.load(), nullptr);
+		trackState.setProperty("muted", track.isMuted.load(), nullptr);
+		trackState.setProperty("solo", track.isSolo.load(), nullptr);
+		trackState.setProperty("enabled", track.isEnabled.load(), nullptr);
+		trackState.setProperty("fineOffset", track.fineOffset, nullptr);
+		trackState.setProperty("timeStretchRatio", track.timeStretchRatio, nullptr);
+		trackState.setProperty("stagingOriginalBpm", track.stagingOriginalBpm, nullptr);
+		trackState.setProperty("showWaveform", track.showWaveform, nullptr);
+		trackState.setProperty("showSequencer", track.showSequencer, nullptr);
+		trackState.setProperty("isPlaying", track.isPlaying.load(), nullptr);
+		trackState.setProperty("isArmed", track.isArmed.load(), nullptr);
+		trackState.setProperty("isArmedToStop", track.isArmedToStop.load(), nullptr);
+		trackState.setProperty("isCurrentlyPlaying", track.isCurrentlyPlaying.load(), nullptr);
+		trackState.setProperty("generationPrompt", track.generationPrompt, nullptr);
+		trackState.setProperty("generationBpm", track.generationBpm, nullptr);
+		trackState.setProperty("generationKey", track.generationKey, nullptr);
+		trackState.setProperty("generationDuration", track.generationDuration, nullptr);
+		trackState.setProperty("loopPointsLocked", track.loopPointsLocked.load(), nullptr);
+		trackState.setProperty("selectedPrompt", track.selectedPrompt, nullptr);
+		trackState.setProperty("useOriginalFile", track.useOriginalFile.load(), nullptr);
+		trackState.setProperty("hasOriginalVersion", track.hasOriginalVersion.load(), nullptr);
+		trackState.setProperty("nextHasOriginalVersion", track.nextHasOriginalVersion.load(), nullptr);
+		trackState.setProperty("randomRetriggerEnabled", track.randomRetriggerEnabled.load(), nullptr);
+		trackState.setProperty("randomRetriggerInterval", track.randomRetriggerInterval.load(), nullptr);
+		trackState.setProperty("beatRepeatPending", track.beatRepeatPending.load(), nullptr);
+		trackState.setProperty("beatRepeatStopPending", track.beatRepeatStopPending.load(), nullptr);
+		trackState.setProperty("originalReadPosition", track.originalReadPosition.load(), nullptr);
+		trackState.setProperty("beatRepeatStartPosition", track.beatRepeatStartPosition.load(), nullptr);
+		trackState.setProperty("beatRepeatEndPosition", track.beatRepeatEndPosition.load(), nullptr);
+		trackState.setProperty("beatRepeatActive", track.beatRepeatActive.load(), nullptr);
+		trackState.setProperty("randomRetriggerDurationEnabled", track.randomRetriggerDurationEnabled.load(), nullptr);
+		trackState.setProperty("usePages", track.usePages.load(), nullptr);
+		trackState.setProperty("currentPageIndex", track.currentPageIndex, nullptr);
+
+		for (int pageIndex = 0; pageIndex < 4; ++pageIndex)
+		{
+			juce::ValueTree pageState("Page");
+			const auto &page = track.pages[pageIndex];
+			pageState.setProperty("index", pageIndex, nullptr);
+			pageState.setProperty("audioFilePath", page.audioFilePath, nullptr);
+			pageState.setProperty("numSamples", page.numSamples, nullptr);
+			pageState.setProperty("sampleRate", page.sampleRate, nullptr);
+			pageState.setProperty("originalBpm", page.originalBpm, nullptr);
+			pageState.setProperty("prompt", page.prompt, nullptr);
+			pageState.setProperty("selectedPrompt", page.selectedPrompt, nullptr);
+			pageState.setProperty("generationPrompt", page.generationPrompt, nullptr);
+			pageState.setProperty("generationBpm", page.generationBpm, nullptr);
+			pageState.setProperty("generationKey", page.generationKey, nullptr);
+			pageState.setProperty("generationDuration", page.generationDuration, nullptr);
+			pageState.setProperty("stems", page.stems, nullptr);
+			pageState.setProperty("loopStart", page.loopStart, nullptr);
+			pageState.setProperty("loopEnd", page.loopEnd, nullptr);
+			pageState.setProperty("useOriginalFile", page.useOriginalFile.load(), nullptr);
+			pageState.setProperty("hasOriginalVersion", page.hasOriginalVersion.load(), nullptr);
+			pageState.setProperty("isLoaded", page.isLoaded.load(), nullptr);
+			pageState.setProperty("preferredStems", joinStems(page.preferredStems), nullptr);
+			trackState.appendChild(pageState, nullptr);
+		}
+
+		trackState.setProperty("preferredStems", joinStems(track.preferredStems), nullptr);
+		if (track.numSamples > 0 && !track.audioFilePath.isEmpty())
+		{
+			trackState.setProperty("audioFilePath", track.audioFilePath, nullptr);
+			trackState.setProperty("sampleRate", track.sampleRate, nullptr);
+			trackState.setProperty("numSamples", track.numSamples, nullptr);
+			trackState.setProperty("numChannels", 2, nullptr);
+		}
+
+		juce::ValueTree sequencerState("Sequencer");
+		sequencerState.setProperty("isPlaying", track.sequencerData.isPlaying, nullptr);
+		sequencerState.setProperty("currentStep", track.sequencerData.currentStep, nullptr);
+		sequencerState.setProperty("currentMeasure", track.sequencerData.currentMeasure, nullptr);
+		sequencerState.setProperty("numMeasures", track.sequencerData.numMeasures, nullptr);
+		sequencerState.setProperty("beatsPerMeasure", track.sequencerData.beatsPerMeasure, nullptr);
+		sequencerState.setProperty("pattern", track.sequencerData.pattern.toBase64(), nullptr);
+		trackState.appendChild(sequencerState, nullptr);
+		return trackState;
+	}
+
+	void fillTrack(TrackData &track, int index, const juce::String &cacheDirectory)
+	{
+		const juce::String prompt = "dark rolling techno bassline with acid squelch, variation " + juce::String(index + 1);
+		track.prompt = prompt;
+		track.selectedPrompt = prompt;
+		track.generationPrompt = prompt;
+		track.style = "Techno";
+		track.stems = "drums,bass";
+		track.preferredStems = {"drums", "bass"};
+		track.generationKey = "A minor";
+		track.generationBpm = 126.0f;
+		track.generationDuration = 6;
+		track.audioFilePath = cacheDirectory + track.trackId + ".wav";
+		track.numSamples = 731429;
+		track.sampleRate = 48000.0;
+
+		if (index % 4 == 3)
+		{
+			track.usePages = true;
+			for (int pageIndex = 0; pageIndex < 4; ++pageIndex)
+			{
+				auto &page = track.pages[pageIndex];
+				page.prompt = prompt + " page " + juce::String::charToString((juce::juce_wchar)('A' + pageIndex));
+				page.selectedPrompt = page.prompt;
+				page.generationPrompt = page.prompt;
+				page.generationKey = "A minor";
+				page.stems = "drums,bass";
+				page.preferredStems = {"drums", "bass"};
+				page.audioFilePath = cacheDirectory + track.trackId + "_" +
+									 juce::String::charToString((juce::juce_wchar)('A' + pageIndex)) + ".wav";
+				page.numSamples = 731429;
+				page.isLoaded = true;
+			}
+		}
+
+		auto &pattern = track.sequencerData.pattern;
+		for (int step = 0; step < 16; step += 4)
+			pattern.setActive(0, step, true);
+		if (index % 2 == 1)
+		{
+			for (int step = 2; step < 16; step += 4)
+				pattern.setActive(0, step, true);
+		}
+	}
+
+	template <typename Operation>
+	double bestOfRuns(Operation &&operation)
+	{
+		double best = 0.0;
+		for (int run = 0; run < numTimingRuns; ++run)
+		{
+			const double start = juce::Time::getMillisecondCounterHiRes();
+			operation();
+			const double elapsed = juce::Time::getMillisecondCounterHiRes() - start;
+			best = run == 0 ? elapsed : juce::jmin(best, elapsed);
+		}
+		return best;
+	}
+}
+
+int main()
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	TrackManager trackManager;
+	const juce::String cacheDirectory = "C:/Users/producer/AppData/Roaming/OBSIDIAN-Neural/AudioCache/" +
+										juce::Uuid().toString() + "/";
+	for (int i = 0; i < numTracks; ++i)
+	{
+		auto trackId = trackManager.createTrack();
+		fillTrack(*trackManager.getTrack(trackId), i, cacheDirectory);
+	}
+	trackManager.refreshTrackStates();
+
+	auto encodeLegacy = [&trackManager]()
+	{
+		juce::ValueTree state("DjIaVstState");
+		juce::ValueTree tracksState("TrackManager");
+		for (const auto &trackId : trackManager.getAllTrackIds())
+			tracksState.appendChild(legacyTrackTree(*trackManager.getTrack(trackId)), nullptr);
+		state.appendChild(tracksState, nullptr);
+
+		juce::MemoryBlock block;
+		if (auto xml = state.createXml())
+			juce::AudioProcessor::copyXmlToBinary(*xml, block);
+		return block;
+	};
+
+	auto encodeBinary = [&trackManager]()
+	{
+		trackManager.refreshTrackStates();
+		juce::MemoryBlock block;
+		juce::MemoryOutputStream stream(block, false);
+		stream.writeInt(BinaryState::magic);
+		stream.writeByte((char)BinaryState::currentVersion);
+		trackManager.writeBinaryState(stream);
+		stream.flush();
+		return block;
+	};
+
+	const auto legacyBlock = encodeLegacy();
+	const auto binaryBlock = encodeBinary();
+
+	// Same restore paths setStateInformation takes for each format
+	TrackManager restored;
+	auto decodeLegacy = [&restored, &legacyBlock]()
+	{
+		if (auto xml = juce::AudioProcessor::getXmlFromBinary(legacyBlock.getData(), (int)legacyBlock.getSize()))
+		{
+			auto state = juce::ValueTree::fromXml(*xml);
+			restored.loadState(state.getChildWithName("TrackManager"));
+		}
+	};
+
+	auto decodeBinary = [&restored, &binaryBlock]()
+	{
+		juce::MemoryInputStream stream(binaryBlock, false);
+		if (stream.readInt() != BinaryState::magic || stream.readByte() != (char)BinaryState::currentVersion)
+			return;
+		restored.readBinaryState(stream);
+	};
+
+	decodeLegacy();
+	const bool legacyRestored = restored.getAllTrackIds().size() == (size_t)numTracks;
+	decodeBinary();
+	const bool binaryRestored = restored.getAllTrackIds().size() == (size_t)numTracks;
+
+	const double legacyEncodeMs = bestOfRuns(encodeLegacy);
+	const double binaryEncodeMs = bestOfRuns(encodeBinary);
+	const double legacyDecodeMs = bestOfRuns(decodeLegacy);
+	const double binaryDecodeMs = bestOfRuns(decodeBinary);
+
+	std::cout << numTracks << "-track project, track state only (16 tracks paged), best of "
+			  << numTimingRuns << " runs" << std::endl;
+	std::cout << "legacy XML:  " << legacyBlock.getSize() << " bytes, save " << juce::String(legacyEncodeMs, 3)
+			  << " ms, load " << juce::String(legacyDecodeMs, 3) << " ms" << std::endl;
+	std::cout << "binary:      " << binaryBlock.getSize() << " bytes, save " << juce::String(binaryEncodeMs, 3)
+			  << " ms, load " << juce::String(binaryDecodeMs, 3) << " ms" << std::endl;
+	if (!legacyRestored || !binaryRestored)
+	{
+		std::cout << "restore failed: legacy " << (legacyRestored ? "ok" : "FAILED")
+				  << ", binary " << (binaryRestored ? "ok" : "FAILED") << std::endl;
+		return 1;
+	}
+	std::cout << "size ratio:  "
+			  << juce::String((double)legacyBlock.getSize() / (double)juce::jmax<size_t>(1, binaryBlock.getSize()), 1)
+			  << "x" << std::endl;
+	return 0;
+}
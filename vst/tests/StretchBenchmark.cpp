@@ -0,0 +1,78 @@
+#include "AudioAnalyzer.h"
+#include <iostream>
+
+namespace
+{
+	juce::AudioBuffer<float> makeTestBuffer(double sampleRate, double seconds)
+	{
+		const int numSamples = (int)(sampleRate * seconds);
+		juce::AudioBuffer<float> buffer(2, numSamples);
+		juce::Random random(1234);
+
+		for (int ch = 0; ch < 2; ++ch)
+		{
+			auto *data = buffer.getWritePointer(ch);
+			for (int i = 0; i < numSamples; ++i)
+			{
+				const double t = i / sampleRate;
+				const float tone = 0.3f * (float)std::sin(juce::MathConstants<double>::twoPi * (110.0 + 55.0 * ch) * t);
+				const float beat = (i % (int)(sampleRate * 0.5)) < 400 ? 0.5f : 0.0f;
+				data[i] = tone + beat + 0.05f * (random.nextFloat() * 2.0f - 1.0f);
+			}
+		}
+		return buffer;
+	}
+
+	double timeStretch(const juce::AudioBuffer<float> &source, double ratio, double sampleRate,
+					   bool chunked, int runs, int &outputSamples)
+	{
+		double bestMs = 0.0;
+		for (int run = 0; run < runs; ++run)
+		{
+			juce::AudioBuffer<float> buffer(source);
+			const double startMs = juce::Time::getMillisecondCounterHiRes();
+
+			if (chunked)
+				AudioAnalyzer::timeStretchBuffer(buffer, ratio, sampleRate);
+			else
+				AudioAnalyzer::timeStretchBufferSingle(buffer, ratio, sampleRate);
+
+			const double elapsedMs = juce::Time::getMillisecondCounterHiRes() - startMs;
+			bestMs = run == 0 ? elapsedMs : juce::jmin(bestMs, elapsedMs);
+			outputSamples = buffer.getNumSamples();
+		}
+		return bestMs;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	const double sampleRate = 44100.0;
+	const int runs = argc > 1 ? juce::jmax(1, juce::String(argv[1]).getIntValue()) : 3;
+
+	std::cout << "Stretch benchmark, " << juce::SystemStats::getNumCpus() << " CPUs, best of "
+			  << runs << " runs" << std::endl;
+	std::cout << "seconds  ratio  single_ms  chunked_ms  speedup  single_len  chunked_len" << std::endl;
+
+	for (double seconds : {4.0, 15.0, 60.0})
+	{
+		const auto source = makeTestBuffer(sampleRate, seconds);
+
+		for (double ratio : {0.8, 1.1, 1.25})
+		{
+			int singleLength = 0, chunkedLength = 0;
+			const double singleMs = timeStretch(source, ratio, sampleRate, false, runs, singleLength);
+			const double chunkedMs = timeStretch(source, ratio, sampleRate, true, runs, chunkedLength);
+
+			std::cout << juce::String(seconds, 0).paddedLeft(' ', 7) << "  "
+					  << juce::String(ratio, 2) << "  "
+					  << juce::String(singleMs, 1).paddedLeft(' ', 9) << "  "
+					  << juce::String(chunkedMs, 1).paddedLeft(' ', 10) << "  "
+					  << juce::String(singleMs / juce::jmax(0.001, chunkedMs), 2).paddedLeft(' ', 7) << "  "
+					  << juce::String(singleLength).paddedLeft(' ', 10) << "  "
+					  << juce::String(chunkedLength).paddedLeft(' ', 11) << std::endl;
+		}
+	}
+
+	return 0;
+}